@@ -0,0 +1,386 @@
+#include "BenchmarkGate.h"
+
+#include "ConvergenceBenchmark.h"
+#include "Json.h"
+#include "PresetBenchmark.h"
+#include "RenderChecks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace Utils {
+	struct GateMetric
+	{
+		const char* Name;
+		bool HigherIsBetter;
+		// Timings get the speed tolerance, deterministic numbers the error tolerance
+		bool IsTiming;
+	};
+
+	static const GateMetric GateMetrics[] = {
+		{ "RaysPerSecond", true, true },
+		{ "RelMSE", false, false },
+		{ "FlipError", false, false },
+	};
+
+	// The timings or the errors of a baseline, they are stored in different files
+	static BenchmarkGate::Baseline SelectMetrics(const BenchmarkGate::Baseline& baseline, bool timings)
+	{
+		BenchmarkGate::Baseline selected = baseline;
+		for (auto& [sceneName, metrics] : selected.Scenes)
+		{
+			for (const GateMetric& metric : GateMetrics)
+			{
+				if (metric.IsTiming != timings)
+					metrics.erase(metric.Name);
+			}
+		}
+		return selected;
+	}
+
+	static bool SaveBaseline(const std::string& path, const BenchmarkGate::Baseline& baseline)
+	{
+		std::error_code errorCode;
+		std::filesystem::path directory = std::filesystem::path(path).parent_path();
+		if (!directory.empty())
+			std::filesystem::create_directories(directory, errorCode);
+
+		if (!BenchmarkGate::SaveBaseline(path, baseline))
+		{
+			std::cerr << "Could not write " << path << "\n";
+			return false;
+		}
+
+		std::cout << "Wrote baseline " << path << "\n";
+		return true;
+	}
+}
+
+int BenchmarkGate::Run(const Options& options)
+{
+	std::string machineClass = options.MachineClass.empty() ? GetMachineClass() : options.MachineClass;
+	std::string baselinePath = options.BaselinePath.empty()
+		? (std::filesystem::path(options.BaselineDirectory) / (machineClass + ".json")).string()
+		: options.BaselinePath;
+	std::string convergenceBaselinePath = options.ConvergenceBaselinePath.empty()
+		? (std::filesystem::path(options.BaselineDirectory) / "convergence.json").string()
+		: options.ConvergenceBaselinePath;
+
+	// Found out before minutes of measuring. The errors ship with the repository, the timings of a machine are only
+	// compared once it recorded them
+	Baseline baseline, convergenceBaseline;
+	bool compareTimings = false;
+	if (!options.Update)
+	{
+		std::string error;
+		if (!LoadBaseline(convergenceBaselinePath, convergenceBaseline, error))
+		{
+			std::cerr << error << "\n";
+			return 1;
+		}
+
+		compareTimings = !options.BaselinePath.empty() || std::filesystem::exists(baselinePath);
+		if (compareTimings && !LoadBaseline(baselinePath, baseline, error))
+		{
+			std::cerr << error << "\n";
+			return 1;
+		}
+
+		if (!compareTimings)
+			std::cerr << "No timings recorded for " << machineClass << ", only the errors are compared. --update records them in " << baselinePath << "\n";
+	}
+	bool measureTimings = options.Update || compareTimings;
+
+	// A broken image fails the gate whatever the numbers say
+	if (RenderChecks::Run(RenderChecks::Options()) != 0)
+		return 1;
+
+	auto threadPool = std::make_shared<ThreadPool>((uint32_t)std::max(options.ThreadCount, 0));
+
+	Baseline current;
+	current.MachineClass = machineClass;
+	current.Label = options.Label;
+	current.ThreadCount = threadPool->GetThreadCount();
+	current.Full = options.Full;
+
+	// Small curves, the reference is rendered on the first run and cached from then on. Only the errors are compared,
+	// a single curve is too short to time reliably and speed is covered by the preset renders
+	ConvergenceBenchmark::Options convergenceOptions;
+	convergenceOptions.Width = 160;
+	convergenceOptions.Height = 90;
+	convergenceOptions.MaxSamples = 16;
+	convergenceOptions.ReferenceSamples = 1024;
+	convergenceOptions.ReferenceDirectory = options.ReferenceDirectory;
+
+	// A tenth of a second per render is mostly noise, one probe run per scene tells how many samples fill MinRunSeconds
+	std::vector<PresetBenchmark::Case> timedCases = PresetBenchmark::GetCases(!options.Full);
+	for (PresetBenchmark::Case& timedCase : timedCases)
+	{
+		if (!measureTimings)
+			break;
+
+		std::string error;
+		PresetBenchmark::Result probe;
+		if (!PresetBenchmark::RunCase(timedCase, threadPool, 1, probe, error))
+		{
+			std::cerr << error << "\n";
+			return 1;
+		}
+
+		double scale = probe.Seconds > 0.0 ? std::ceil(options.MinRunSeconds / probe.Seconds) : 1.0;
+		timedCase.Samples = (uint32_t)std::clamp(timedCase.Samples * scale, (double)timedCase.Samples, 65536.0);
+	}
+
+	// Slow stretches of the machine last seconds, so every round renders each scene once and the runs of a scene are
+	// spread over the whole gate. Every run traces the same rays, the fastest one is the least disturbed
+	uint32_t rounds = measureTimings ? std::max(options.Repeats, 1u) : 0;
+	for (uint32_t round = 0; round < rounds; round++)
+	{
+		for (const PresetBenchmark::Case& timedCase : timedCases)
+		{
+			std::string error;
+			PresetBenchmark::Result speed;
+			if (!PresetBenchmark::RunCase(timedCase, threadPool, 1, speed, error))
+			{
+				std::cerr << error << "\n";
+				return 1;
+			}
+
+			double& raysPerSecond = current.Scenes[timedCase.SceneName]["RaysPerSecond"];
+			raysPerSecond = std::max(raysPerSecond, speed.RaysPerSecond);
+		}
+
+		std::cerr << "Timed round " << round + 1 << " of " << rounds << "\n";
+	}
+
+	for (const PresetBenchmark::Case& timedCase : timedCases)
+	{
+		std::string error;
+		ConvergenceBenchmark::Result convergence;
+		if (!ConvergenceBenchmark::RunScene(convergenceOptions, timedCase.SceneName, threadPool, convergence, error))
+		{
+			std::cerr << error << "\n";
+			return 1;
+		}
+
+		SceneMetrics& metrics = current.Scenes[timedCase.SceneName];
+		metrics["RelMSE"] = convergence.Points.back().RelMSE;
+		metrics["FlipError"] = convergence.Points.back().FlipError;
+
+		if (measureTimings)
+			std::cerr << "Measured " << timedCase.SceneName << " at " << timedCase.Samples << " samples per run\n";
+		else
+			std::cerr << "Measured " << timedCase.SceneName << "\n";
+	}
+
+	if (options.Update)
+	{
+		// The errors do not depend on the machine, thread count or preset size
+		Baseline errors = Utils::SelectMetrics(current, false);
+		errors.MachineClass = "any";
+		errors.ThreadCount = 0;
+		errors.Full = false;
+
+		bool saved = Utils::SaveBaseline(baselinePath, Utils::SelectMetrics(current, true));
+		saved = Utils::SaveBaseline(convergenceBaselinePath, errors) && saved;
+		return saved ? 0 : 1;
+	}
+
+	if (compareTimings && (baseline.ThreadCount != current.ThreadCount || baseline.Full != current.Full))
+	{
+		std::cerr << "The baseline was recorded with " << baseline.ThreadCount << " threads" << (baseline.Full ? " and --full" : "")
+			<< ", this run uses " << current.ThreadCount << (current.Full ? " and --full" : "") << "\n";
+		return 1;
+	}
+
+	std::cout << "Baseline " << convergenceBaselinePath;
+	if (!convergenceBaseline.Label.empty())
+		std::cout << " (" << convergenceBaseline.Label << ")";
+	if (compareTimings)
+	{
+		std::cout << ", timings " << baselinePath;
+		if (!baseline.Label.empty())
+			std::cout << " (" << baseline.Label << ")";
+	}
+	std::cout << "\n\n";
+
+	// Timings only count from the machine's own baseline, errors only from the shared one
+	baseline = Utils::SelectMetrics(baseline, true);
+	for (const auto& [sceneName, metrics] : Utils::SelectMetrics(convergenceBaseline, false).Scenes)
+	{
+		SceneMetrics& merged = baseline.Scenes[sceneName];
+		for (const auto& [metricName, value] : metrics)
+			merged[metricName] = value;
+	}
+
+	char line[256];
+	snprintf(line, sizeof(line), "%-16s %-22s %14s %14s %9s\n", "Scene", "Metric", "Baseline", "Current", "Change");
+	std::cout << line;
+
+	std::vector<std::string> regressions, improvements;
+	for (const auto& [sceneName, metrics] : current.Scenes)
+	{
+		auto baselineScene = baseline.Scenes.find(sceneName);
+		if (baselineScene == baseline.Scenes.end())
+		{
+			std::cout << sceneName << " is not in the baseline\n";
+			continue;
+		}
+
+		for (const Utils::GateMetric& metric : Utils::GateMetrics)
+		{
+			auto baselineValue = baselineScene->second.find(metric.Name);
+			auto currentValue = metrics.find(metric.Name);
+			if (baselineValue == baselineScene->second.end() || baselineValue->second <= 0.0 || currentValue == metrics.end())
+				continue;
+
+			double value = currentValue->second;
+			double change = (value - baselineValue->second) / baselineValue->second;
+			double tolerance = metric.IsTiming ? options.SpeedTolerance : options.ErrorTolerance;
+			double worsening = metric.HigherIsBetter ? -change : change;
+
+			const char* verdict = "";
+			if (worsening > tolerance)
+			{
+				verdict = "  REGRESSED";
+				regressions.push_back(sceneName + " " + metric.Name);
+			}
+			else if (worsening < -tolerance)
+			{
+				verdict = "  improved";
+				improvements.push_back(sceneName + " " + metric.Name);
+			}
+
+			snprintf(line, sizeof(line), "%-16s %-22s %14.6g %14.6g %+8.1f%%%s\n", sceneName.c_str(), metric.Name,
+				baselineValue->second, value, change * 100.0, verdict);
+			std::cout << line;
+		}
+	}
+
+	std::cout << "\nTolerance " << options.SpeedTolerance * 100.0 << "% for timings, " << options.ErrorTolerance * 100.0 << "% for errors\n";
+
+	if (!improvements.empty())
+		std::cout << improvements.size() << " metrics improved, --update records them as the new baseline\n";
+
+	if (!regressions.empty())
+	{
+		std::cout << "FAILED, " << regressions.size() << " metrics regressed:\n";
+		for (const std::string& regression : regressions)
+			std::cout << "  " << regression << "\n";
+		return 1;
+	}
+
+	std::cout << "PASSED\n";
+	return 0;
+}
+
+std::string BenchmarkGate::GetMachineClass()
+{
+#if defined(_WIN32)
+	std::string system = "windows";
+#elif defined(__APPLE__)
+	std::string system = "macos";
+#elif defined(__linux__)
+	std::string system = "linux";
+#else
+	std::string system = "unknown";
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+	std::string architecture = "x64";
+#elif defined(__aarch64__) || defined(_M_ARM64)
+	std::string architecture = "arm64";
+#else
+	std::string architecture = "other";
+#endif
+
+	return system + "-" + architecture + "-" + std::to_string(std::thread::hardware_concurrency()) + "t";
+}
+
+bool BenchmarkGate::LoadBaseline(const std::string& path, Baseline& baseline, std::string& error)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		error = "could not open " + path;
+		return false;
+	}
+
+	std::stringstream stream;
+	stream << file.rdbuf();
+	std::string text = stream.str();
+
+	JsonValue root;
+	JsonParser parser(text);
+	if (!parser.Parse(root))
+	{
+		error = path + ":" + std::to_string(parser.GetLine()) + ": " + parser.GetError();
+		return false;
+	}
+
+	const JsonValue* scenes = root.Find("Scenes");
+	if (root.ValueType != JsonValue::Type::Object || !scenes || scenes->ValueType != JsonValue::Type::Object)
+	{
+		error = path + ": expected an object with a Scenes object";
+		return false;
+	}
+
+	baseline = Baseline();
+	if (const JsonValue* machineClass = root.Find("MachineClass"))
+		baseline.MachineClass = machineClass->String;
+	if (const JsonValue* label = root.Find("Label"))
+		baseline.Label = label->String;
+	if (const JsonValue* threadCount = root.Find("ThreadCount"))
+		baseline.ThreadCount = (uint32_t)threadCount->Number;
+	if (const JsonValue* full = root.Find("Full"))
+		baseline.Full = full->Bool;
+
+	for (const auto& [sceneName, sceneValue] : scenes->Members)
+	{
+		SceneMetrics& metrics = baseline.Scenes[sceneName];
+		for (const auto& [metricName, metricValue] : sceneValue.Members)
+		{
+			if (metricValue.ValueType == JsonValue::Type::Number)
+				metrics[metricName] = metricValue.Number;
+		}
+	}
+
+	return true;
+}
+
+bool BenchmarkGate::SaveBaseline(const std::string& path, const Baseline& baseline)
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file)
+		return false;
+
+	file.precision(9);
+	file << "{\n";
+	file << "\t\"MachineClass\": \"" << EscapeJson(baseline.MachineClass) << "\",\n";
+	file << "\t\"Label\": \"" << EscapeJson(baseline.Label) << "\",\n";
+	file << "\t\"ThreadCount\": " << baseline.ThreadCount << ",\n";
+	file << "\t\"Full\": " << (baseline.Full ? "true" : "false") << ",\n";
+	file << "\t\"Scenes\": {";
+
+	size_t sceneIndex = 0;
+	for (const auto& [sceneName, metrics] : baseline.Scenes)
+	{
+		file << (sceneIndex++ == 0 ? "\n" : ",\n") << "\t\t\"" << EscapeJson(sceneName) << "\": {";
+
+		size_t metricIndex = 0;
+		for (const auto& [metricName, value] : metrics)
+			file << (metricIndex++ == 0 ? "\n" : ",\n") << "\t\t\t\"" << metricName << "\": " << value;
+
+		file << "\n\t\t}";
+	}
+
+	file << (baseline.Scenes.empty() ? "}\n" : "\n\t}\n");
+	file << "}\n";
+	return (bool)file;
+}
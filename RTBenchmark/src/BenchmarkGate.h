@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Compares rays per second and convergence of the presets to baselines and fails if any of them got worse by more than a
+// tolerance. The errors do not depend on the machine and their baseline ships with the repository. Timings only compare
+// on the machine that recorded them, they are left out until a run with Update stores them for the machine class.
+// Speed is compared with a loose tolerance since timings are noisy: every scene renders enough samples per run to take
+// MinRunSeconds, the runs of the scenes take turns and the fastest run of every scene counts. The error at a fixed
+// sample count is deterministic for a fixed seed and compared tightly. Runs offline in a minute or two: calibrated preset
+// renders plus small convergence curves against cached references.
+class BenchmarkGate
+{
+public:
+	struct Options
+	{
+		// Empty derives it from the OS, architecture and hardware threads, e.g. linux-x64-16t
+		std::string MachineClass;
+		// Timings, empty uses <BaselineDirectory>/<MachineClass>.json if it exists
+		std::string BaselinePath;
+		// Errors, empty uses <BaselineDirectory>/convergence.json
+		std::string ConvergenceBaselinePath;
+		std::string BaselineDirectory = "../benchmarks/baselines";
+
+		// Relative change allowed before a metric counts as regressed
+		double SpeedTolerance = 0.10;
+		double ErrorTolerance = 0.02;
+
+		// Writes the measured timings and errors as the new baselines instead of comparing
+		bool Update = false;
+		// Full size preset renders instead of the quick ones
+		bool Full = false;
+		// Timed runs per scene
+		uint32_t Repeats = 5;
+		// Samples per preset render are raised until a single run takes at least this long
+		double MinRunSeconds = 0.5;
+		// 0 uses every hardware thread
+		int ThreadCount = 0;
+		std::string Label;
+		std::string ReferenceDirectory = "benchmark_references";
+	};
+
+	// Metric name to value, per scene
+	using SceneMetrics = std::map<std::string, double>;
+
+	struct Baseline
+	{
+		std::string MachineClass;
+		std::string Label;
+		uint32_t ThreadCount = 0;
+		bool Full = false;
+		std::map<std::string, SceneMetrics> Scenes;
+	};
+public:
+	// Returns the process exit code, 1 on regressions
+	static int Run(const Options& options);
+
+	static std::string GetMachineClass();
+
+	static bool LoadBaseline(const std::string& path, Baseline& baseline, std::string& error);
+	static bool SaveBaseline(const std::string& path, const Baseline& baseline);
+};
@@ -0,0 +1,527 @@
+#include "BenchmarkGate.h"
+#include "ConvergenceBenchmark.h"
+#include "MicroBenchmark.h"
+#include "PresetBenchmark.h"
+#include "RenderChecks.h"
+#include "ScalingBenchmark.h"
+#include "ThreadScalingBenchmark.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace Utils {
+	static bool ParseTileOrder(const char* value, Renderer::TileOrder& order)
+	{
+		if (strcmp(value, "scanline") == 0)
+			order = Renderer::TileOrder::Scanline;
+		else if (strcmp(value, "morton") == 0)
+			order = Renderer::TileOrder::Morton;
+		else if (strcmp(value, "hilbert") == 0)
+			order = Renderer::TileOrder::Hilbert;
+		else
+		{
+			std::cerr << "Unknown tile order " << value << "\n";
+			return false;
+		}
+		return true;
+	}
+
+	// Progress and errors of every benchmark go to stderr, stdout only holds the report, so that it can be redirected to a
+	// file as is. The report is buffered until the benchmark succeeded, a failed run leaves an earlier --output file alone
+	static int RunWithReport(const std::string& outputPath, const std::function<int(std::ostream&)>& run)
+	{
+		std::ostringstream report;
+		int exitCode = run(report);
+		if (exitCode != 0)
+			return exitCode;
+
+		if (outputPath.empty())
+		{
+			std::cout << report.str();
+			return std::cout ? 0 : 1;
+		}
+
+		std::ofstream file(outputPath, std::ios::trunc);
+		if (!(file << report.str()))
+		{
+			std::cerr << "Could not write " << outputPath << "\n";
+			return 1;
+		}
+
+		return 0;
+	}
+
+	static void PrintUsage()
+	{
+		std::cout <<
+			"Usage:\n"
+			"  RTBenchmark [presets] [options]\n"
+			"    Renders TwoSpheres, ColorRoom and RefractionTest with fixed settings and writes the timings as JSON\n"
+			"    --output <file.json>           Report file, stdout by default\n"
+			"    --threads <count>              0 uses every hardware thread\n"
+			"    --repeat <count>               Timed renders per scene, the median is reported\n"
+			"    --label <text>                 Stored in the report, e.g. the commit\n"
+			"    --quick                        Smaller images and fewer samples\n"
+			"    --counters                     One more render per scene with time and hardware counters per phase\n"
+			"    --tile-order <scanline|morton|hilbert>   Order tiles are handed to the threads, hilbert by default\n"
+			"  RTBenchmark micro [options]\n"
+			"    Times intersection, random number and shading kernels on their own\n"
+			"    --output <file.json> --label <text> as for presets\n"
+			"    --count <n>                    Rays, primitives or seeds per pass\n"
+			"    --passes <n>                   Timed passes per kernel\n"
+			"    --warmup <n>                   Untimed passes per kernel\n"
+			"    --filter <text>                Only kernels whose name contains the text\n"
+			"  RTBenchmark scaling [options]\n"
+			"    Renders generated scenes of 10, 100, ... objects and reports build time, memory and rays/s per size\n"
+			"    --output <file.json> --label <text> --threads <count> as for presets\n"
+			"    --generator <name>             RandomPrimitives, InstanceGrid or GlassCluster, may repeat, all by default\n"
+			"    --min-objects <n> --max-objects <n>   Up to 10000000\n"
+			"    --budget <n>                   Rays times objects per render, the image shrinks to stay within it\n"
+			"    --bounces <count> --seed <n>\n"
+			"  RTBenchmark threads [options]\n"
+			"    Renders one frame on 1, 2, 4, ... threads, the caller included, reports speedup over a single thread,\n"
+			"    busy and idle time per thread and a histogram of tile times\n"
+			"    --output <file.json> --label <text> --repeat <count> as for presets\n"
+			"    --scene <name|file.rtscene>    ColorRoom by default\n"
+			"    --width <pixels> --height <pixels> --samples <count> --bounces <count> --seed <n>\n"
+			"    --max-threads <count>          0 goes up to the hardware threads\n"
+			"    --tile-size <pixels> --bins <count>\n"
+			"    --tile-order <scanline|morton|hilbert> as for presets\n"
+			"  RTBenchmark convergence [options]\n"
+			"    Error against a cached high sample reference over samples and time, as JSON and optionally CSV\n"
+			"    --output <file.json> --label <text> --threads <count> as for presets\n"
+			"    --scene <name|file.rtscene>    May repeat, the three presets by default\n"
+			"    --width <pixels> --height <pixels> --bounces <count> --seed <n>\n"
+			"    --rays-per-pixel <count> --split-paths --filter <box|tent|blackman-harris>\n"
+			"    --max-samples <count>          Samples double per step up to this\n"
+			"    --time-budget <seconds>        Stop a scene once its render time passes this\n"
+			"    --reference-samples <count> --reference-dir <path> --rebuild-references\n"
+			"    --csv <file.csv>               One row per scene and step\n"
+			"  RTBenchmark gate [options]\n"
+			"    Compares convergence of the presets to the shipped baseline and rays/s to the one of this machine class,\n"
+			"    exits with 1 if a metric got worse by more than the tolerance. Timings are compared once --update stored them\n"
+			"    --baseline <file.json>         Timings, instead of <baseline-dir>/<machine>.json\n"
+			"    --convergence-baseline <file.json>   Errors, instead of <baseline-dir>/convergence.json\n"
+			"    --baseline-dir <path>          ../benchmarks/baselines by default\n"
+			"    --machine <name>               Machine class, derived from OS, architecture and threads by default\n"
+			"    --tolerance <fraction>         Allowed slowdown, 0.10 by default\n"
+			"    --error-tolerance <fraction>   Allowed growth of the error at a fixed sample count, 0.02 by default\n"
+			"    --update                       Record the measured timings and errors as the new baselines\n"
+			"    --full                         Full size preset renders instead of the quick ones\n"
+			"    --min-run-seconds <seconds>    Samples per render are raised until one run takes this, 0.5 by default\n"
+			"    --repeat <count> --threads <count> --label <text> --reference-dir <path>\n"
+			"  RTBenchmark checks [options]\n"
+			"    Checks renderer invariants that timings miss, exits with 1 if one fails. The gate runs them first\n"
+			"    --threads <count>              Pool workers, 8 by default whatever the hardware\n"
+			"    --frames <count>               Frames per check\n";
+	}
+}
+
+static int RunPresets(int argc, char** argv)
+{
+	PresetBenchmark::Options options;
+	std::string outputPath;
+
+	for (int i = 0; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		if (strcmp(argument, "--quick") == 0)
+		{
+			options.Quick = true;
+			continue;
+		}
+		if (strcmp(argument, "--counters") == 0)
+		{
+			options.Counters = true;
+			continue;
+		}
+
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value)
+		{
+			std::cerr << "Missing value for " << argument << "\n";
+			return 1;
+		}
+		i++;
+
+		if (strcmp(argument, "--output") == 0)
+			outputPath = value;
+		else if (strcmp(argument, "--threads") == 0)
+			options.ThreadCount = atoi(value);
+		else if (strcmp(argument, "--repeat") == 0)
+			options.Repeats = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--label") == 0)
+			options.Label = value;
+		else if (strcmp(argument, "--tile-order") == 0)
+		{
+			if (!Utils::ParseTileOrder(value, options.Order))
+				return 1;
+		}
+		else
+		{
+			std::cerr << "Unknown option " << argument << "\n";
+			return 1;
+		}
+	}
+
+	return Utils::RunWithReport(outputPath, [&](std::ostream& report) { return PresetBenchmark::Run(options, report); });
+}
+
+static int RunMicro(int argc, char** argv)
+{
+	MicroBenchmark::Options options;
+	std::string outputPath;
+
+	for (int i = 0; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value)
+		{
+			std::cerr << "Missing value for " << argument << "\n";
+			return 1;
+		}
+		i++;
+
+		if (strcmp(argument, "--output") == 0)
+			outputPath = value;
+		else if (strcmp(argument, "--label") == 0)
+			options.Label = value;
+		else if (strcmp(argument, "--count") == 0)
+			options.Count = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--passes") == 0)
+			options.Passes = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--warmup") == 0)
+			options.WarmupPasses = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--filter") == 0)
+			options.Filter = value;
+		else
+		{
+			std::cerr << "Unknown option " << argument << "\n";
+			return 1;
+		}
+	}
+
+	return Utils::RunWithReport(outputPath, [&](std::ostream& report) { return MicroBenchmark::Run(options, report); });
+}
+
+static int RunScaling(int argc, char** argv)
+{
+	ScalingBenchmark::Options options;
+	std::string outputPath;
+
+	for (int i = 0; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value)
+		{
+			std::cerr << "Missing value for " << argument << "\n";
+			return 1;
+		}
+		i++;
+
+		if (strcmp(argument, "--output") == 0)
+			outputPath = value;
+		else if (strcmp(argument, "--label") == 0)
+			options.Label = value;
+		else if (strcmp(argument, "--threads") == 0)
+			options.ThreadCount = atoi(value);
+		else if (strcmp(argument, "--generator") == 0)
+			options.Generators.push_back(value);
+		else if (strcmp(argument, "--min-objects") == 0)
+			options.MinObjects = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--max-objects") == 0)
+			options.MaxObjects = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--budget") == 0)
+			options.IntersectionBudget = atof(value);
+		else if (strcmp(argument, "--bounces") == 0)
+			options.LightBounces = atoi(value);
+		else if (strcmp(argument, "--seed") == 0)
+			options.Seed = (uint32_t)atoi(value);
+		else
+		{
+			std::cerr << "Unknown option " << argument << "\n";
+			return 1;
+		}
+	}
+
+	if (options.MinObjects == 0 || options.MaxObjects < options.MinObjects || options.MaxObjects > 10000000)
+	{
+		std::cerr << "Object counts must lie between 1 and 10000000\n";
+		return 1;
+	}
+
+	return Utils::RunWithReport(outputPath, [&](std::ostream& report) { return ScalingBenchmark::Run(options, report); });
+}
+
+static int RunThreads(int argc, char** argv)
+{
+	ThreadScalingBenchmark::Options options;
+	std::string outputPath;
+
+	for (int i = 0; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value)
+		{
+			std::cerr << "Missing value for " << argument << "\n";
+			return 1;
+		}
+		i++;
+
+		if (strcmp(argument, "--output") == 0)
+			outputPath = value;
+		else if (strcmp(argument, "--label") == 0)
+			options.Label = value;
+		else if (strcmp(argument, "--repeat") == 0)
+			options.Repeats = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--scene") == 0)
+			options.SceneName = value;
+		else if (strcmp(argument, "--width") == 0)
+			options.Width = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--height") == 0)
+			options.Height = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--samples") == 0)
+			options.Samples = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--bounces") == 0)
+			options.LightBounces = atoi(value);
+		else if (strcmp(argument, "--seed") == 0)
+			options.Seed = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--max-threads") == 0)
+			options.MaxThreads = atoi(value);
+		else if (strcmp(argument, "--tile-size") == 0)
+			options.TileSize = atoi(value);
+		else if (strcmp(argument, "--bins") == 0)
+			options.HistogramBins = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--tile-order") == 0)
+		{
+			if (!Utils::ParseTileOrder(value, options.Order))
+				return 1;
+		}
+		else
+		{
+			std::cerr << "Unknown option " << argument << "\n";
+			return 1;
+		}
+	}
+
+	if (options.Width == 0 || options.Height == 0 || options.Samples == 0)
+	{
+		std::cerr << "Width, height and samples must be positive\n";
+		return 1;
+	}
+
+	return Utils::RunWithReport(outputPath, [&](std::ostream& report) { return ThreadScalingBenchmark::Run(options, report); });
+}
+
+static int RunConvergence(int argc, char** argv)
+{
+	ConvergenceBenchmark::Options options;
+	std::string outputPath;
+
+	for (int i = 0; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		if (strcmp(argument, "--split-paths") == 0)
+		{
+			options.SplitPrimaryPaths = true;
+			continue;
+		}
+		if (strcmp(argument, "--rebuild-references") == 0)
+		{
+			options.RebuildReferences = true;
+			continue;
+		}
+
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value)
+		{
+			std::cerr << "Missing value for " << argument << "\n";
+			return 1;
+		}
+		i++;
+
+		if (strcmp(argument, "--output") == 0)
+			outputPath = value;
+		else if (strcmp(argument, "--label") == 0)
+			options.Label = value;
+		else if (strcmp(argument, "--threads") == 0)
+			options.ThreadCount = atoi(value);
+		else if (strcmp(argument, "--scene") == 0)
+			options.Scenes.push_back(value);
+		else if (strcmp(argument, "--width") == 0)
+			options.Width = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--height") == 0)
+			options.Height = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--bounces") == 0)
+			options.LightBounces = atoi(value);
+		else if (strcmp(argument, "--seed") == 0)
+			options.Seed = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--rays-per-pixel") == 0)
+			options.RaysPerPixel = atoi(value);
+		else if (strcmp(argument, "--filter") == 0)
+		{
+			if (strcmp(value, "box") == 0)
+				options.Filter = Renderer::PixelFilter::Box;
+			else if (strcmp(value, "tent") == 0)
+				options.Filter = Renderer::PixelFilter::Tent;
+			else if (strcmp(value, "blackman-harris") == 0)
+				options.Filter = Renderer::PixelFilter::BlackmanHarris;
+			else
+			{
+				std::cerr << "Unknown filter " << value << "\n";
+				return 1;
+			}
+		}
+		else if (strcmp(argument, "--max-samples") == 0)
+			options.MaxSamples = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--time-budget") == 0)
+			options.TimeBudget = atof(value);
+		else if (strcmp(argument, "--reference-samples") == 0)
+			options.ReferenceSamples = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--reference-dir") == 0)
+			options.ReferenceDirectory = value;
+		else if (strcmp(argument, "--csv") == 0)
+			options.CsvPath = value;
+		else
+		{
+			std::cerr << "Unknown option " << argument << "\n";
+			return 1;
+		}
+	}
+
+	if (options.Width == 0 || options.Height == 0 || options.MaxSamples == 0 || options.ReferenceSamples == 0)
+	{
+		std::cerr << "Width, height and sample counts must be positive\n";
+		return 1;
+	}
+
+	return Utils::RunWithReport(outputPath, [&](std::ostream& report) { return ConvergenceBenchmark::Run(options, report); });
+}
+
+static int RunGate(int argc, char** argv)
+{
+	BenchmarkGate::Options options;
+
+	for (int i = 0; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		if (strcmp(argument, "--update") == 0)
+		{
+			options.Update = true;
+			continue;
+		}
+		if (strcmp(argument, "--full") == 0)
+		{
+			options.Full = true;
+			continue;
+		}
+
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value)
+		{
+			std::cerr << "Missing value for " << argument << "\n";
+			return 1;
+		}
+		i++;
+
+		if (strcmp(argument, "--baseline") == 0)
+			options.BaselinePath = value;
+		else if (strcmp(argument, "--convergence-baseline") == 0)
+			options.ConvergenceBaselinePath = value;
+		else if (strcmp(argument, "--baseline-dir") == 0)
+			options.BaselineDirectory = value;
+		else if (strcmp(argument, "--machine") == 0)
+			options.MachineClass = value;
+		else if (strcmp(argument, "--tolerance") == 0)
+			options.SpeedTolerance = atof(value);
+		else if (strcmp(argument, "--error-tolerance") == 0)
+			options.ErrorTolerance = atof(value);
+		else if (strcmp(argument, "--min-run-seconds") == 0)
+			options.MinRunSeconds = atof(value);
+		else if (strcmp(argument, "--repeat") == 0)
+			options.Repeats = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--threads") == 0)
+			options.ThreadCount = atoi(value);
+		else if (strcmp(argument, "--label") == 0)
+			options.Label = value;
+		else if (strcmp(argument, "--reference-dir") == 0)
+			options.ReferenceDirectory = value;
+		else
+		{
+			std::cerr << "Unknown option " << argument << "\n";
+			return 1;
+		}
+	}
+
+	return BenchmarkGate::Run(options);
+}
+
+static int RunChecks(int argc, char** argv)
+{
+	RenderChecks::Options options;
+
+	for (int i = 0; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value)
+		{
+			std::cerr << "Missing value for " << argument << "\n";
+			return 1;
+		}
+		i++;
+
+		if (strcmp(argument, "--threads") == 0)
+			options.ThreadCount = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--frames") == 0)
+			options.Frames = (uint32_t)atoi(value);
+		else
+		{
+			std::cerr << "Unknown option " << argument << "\n";
+			return 1;
+		}
+	}
+
+	return RenderChecks::Run(options);
+}
+
+int main(int argc, char** argv)
+{
+	if (argc > 1 && (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "help") == 0))
+	{
+		Utils::PrintUsage();
+		return 0;
+	}
+
+	// Without a command the presets run, options follow directly
+	if (argc < 2 || strncmp(argv[1], "--", 2) == 0)
+		return RunPresets(argc - 1, argv + 1);
+
+	const char* command = argv[1];
+	if (strcmp(command, "presets") == 0)
+		return RunPresets(argc - 2, argv + 2);
+	if (strcmp(command, "micro") == 0)
+		return RunMicro(argc - 2, argv + 2);
+	if (strcmp(command, "scaling") == 0)
+		return RunScaling(argc - 2, argv + 2);
+	if (strcmp(command, "threads") == 0)
+		return RunThreads(argc - 2, argv + 2);
+	if (strcmp(command, "convergence") == 0)
+		return RunConvergence(argc - 2, argv + 2);
+	if (strcmp(command, "gate") == 0)
+		return RunGate(argc - 2, argv + 2);
+	if (strcmp(command, "checks") == 0)
+		return RunChecks(argc - 2, argv + 2);
+
+	std::cerr << "Unknown command " << command << "\n";
+	Utils::PrintUsage();
+	return 1;
+}
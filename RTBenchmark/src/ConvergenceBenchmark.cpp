@@ -0,0 +1,275 @@
+#include "ConvergenceBenchmark.h"
+
+#include "ImageMetrics.h"
+#include "Json.h"
+#include "SceneFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace Utils {
+	static constexpr uint32_t ReferenceMagic = 0x46525452; // "RTRF"
+	static constexpr uint32_t ReferenceVersion = 1;
+	// Differs from every seed the renderer under test uses, so its noise does not correlate with the reference
+	static constexpr uint32_t ReferenceSeed = 0x7f4a7c15;
+
+	struct ReferenceHeader
+	{
+		uint32_t Magic = ReferenceMagic;
+		uint32_t Version = ReferenceVersion;
+		uint32_t Width = 0, Height = 0;
+		uint32_t Samples = 0;
+		int32_t LightBounces = 0;
+		int32_t Filter = 0;
+	};
+
+	static ReferenceHeader MakeReferenceHeader(const ConvergenceBenchmark::Options& options)
+	{
+		ReferenceHeader header;
+		header.Width = options.Width;
+		header.Height = options.Height;
+		header.Samples = options.ReferenceSamples;
+		header.LightBounces = options.LightBounces;
+		header.Filter = (int32_t)options.Filter;
+		return header;
+	}
+
+	// Linear averages of the per pixel sums
+	static void AddSums(const std::vector<glm::vec4>& sums, std::vector<glm::vec4>& total, std::vector<glm::vec3>& average)
+	{
+		for (size_t i = 0; i < sums.size(); i++)
+		{
+			total[i] += sums[i];
+			average[i] = glm::vec3(total[i]) / glm::max(total[i].a, 1.0f);
+		}
+	}
+}
+
+int ConvergenceBenchmark::Run(const Options& options, std::ostream& report)
+{
+	std::vector<std::string> scenes = options.Scenes;
+	if (scenes.empty())
+		scenes = { "TwoSpheres", "ColorRoom", "RefractionTest" };
+
+	auto threadPool = std::make_shared<ThreadPool>((uint32_t)std::max(options.ThreadCount, 0));
+
+	std::vector<Result> results;
+	for (const std::string& sceneName : scenes)
+	{
+		Result result;
+		std::string error;
+		if (!RunScene(options, sceneName, threadPool, result, error))
+		{
+			std::cerr << error << "\n";
+			return 1;
+		}
+
+		const Point& last = result.Points.back();
+
+		std::cerr << sceneName << ": " << last.Samples << " samples in " << last.Seconds << " s, RMSE " << last.RMSE << ", relMSE "
+			<< last.RelMSE << ", FLIP-like " << last.FlipError << ", efficiency " << result.Efficiency << "\n";
+		results.push_back(result);
+	}
+
+	if (!options.CsvPath.empty())
+	{
+		std::ofstream file(options.CsvPath, std::ios::trunc);
+		if (!WriteCsv(file, results))
+		{
+			std::cerr << "Could not write " << options.CsvPath << "\n";
+			return 1;
+		}
+	}
+
+	return WriteReport(report, options, results) ? 0 : 1;
+}
+
+bool ConvergenceBenchmark::RunScene(const Options& options, const std::string& sceneName, const std::shared_ptr<ThreadPool>& threadPool, Result& result, std::string& error)
+{
+	Renderer::Tile region = { 0, 0, options.Width, options.Height };
+	size_t pixelCount = (size_t)options.Width * options.Height;
+
+	Scene scene;
+	Camera camera(45.0f, 0.1f, 100.0f);
+	if (!SceneFile::LoadFileOrPreset(sceneName, scene, camera, error))
+		return false;
+
+	camera.OnResize(options.Width, options.Height);
+
+	Renderer renderer;
+	renderer.SetThreadPool(threadPool);
+	Renderer::Settings& settings = renderer.GetSettings();
+	settings.LightBounces = options.LightBounces;
+	settings.Filter = options.Filter;
+
+	result = Result();
+	result.SceneName = sceneName;
+
+	std::vector<glm::vec4> sums(pixelCount);
+	std::vector<glm::vec3> reference(pixelCount);
+	std::string referencePath = GetReferencePath(options, sceneName);
+	result.ReferenceCached = !options.RebuildReferences && LoadReference(referencePath, options, reference);
+
+	if (!result.ReferenceCached)
+	{
+		settings.Seed = Utils::ReferenceSeed;
+		settings.RaysPerPixel = 1;
+		settings.SplitPrimaryPaths = false;
+
+		std::vector<glm::vec4> total(pixelCount, glm::vec4(0.0f));
+		auto referenceStart = std::chrono::steady_clock::now();
+
+		const uint32_t batchSamples = 64;
+		for (uint32_t sample = 0; sample < options.ReferenceSamples; sample += batchSamples)
+		{
+			uint32_t sampleCount = std::min(batchSamples, options.ReferenceSamples - sample);
+			renderer.RenderRegion(scene, camera, region, sample, sampleCount, sums.data());
+			Utils::AddSums(sums, total, reference);
+
+			std::cerr << "\r" << sceneName << " reference: " << sample + sampleCount << "/" << options.ReferenceSamples << " samples" << std::flush;
+		}
+		std::cerr << "\n";
+
+		result.ReferenceSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - referenceStart).count();
+
+		if (!SaveReference(referencePath, options, reference))
+			std::cerr << "Could not cache the reference in " << referencePath << "\n";
+	}
+
+	settings.Seed = options.Seed;
+	settings.RaysPerPixel = options.RaysPerPixel;
+	settings.SplitPrimaryPaths = options.SplitPrimaryPaths;
+
+	std::vector<glm::vec4> total(pixelCount, glm::vec4(0.0f));
+	std::vector<glm::vec3> image(pixelCount);
+	double seconds = 0.0;
+
+	// Each step adds as many samples as all steps before it, only the rendering is timed
+	uint32_t samples = 0;
+	for (uint32_t target = 1; target <= options.MaxSamples; target *= 2)
+	{
+		auto stepStart = std::chrono::steady_clock::now();
+		renderer.RenderRegion(scene, camera, region, samples, target - samples, sums.data());
+		seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - stepStart).count();
+
+		samples = target;
+		Utils::AddSums(sums, total, image);
+
+		Point& point = result.Points.emplace_back();
+		point.Samples = samples;
+		point.Seconds = seconds;
+		point.RMSE = ImageMetrics::RMSE(image, reference);
+		point.RelMSE = ImageMetrics::RelMSE(image, reference);
+		point.FlipError = ImageMetrics::FlipLikeError(image, reference, options.Width, options.Height);
+
+		if (options.TimeBudget > 0.0 && seconds >= options.TimeBudget)
+			break;
+	}
+
+	scene.DeleteObjects();
+
+	const Point& last = result.Points.back();
+	result.Efficiency = last.RelMSE > 0.0 && last.Seconds > 0.0 ? 1.0 / (last.RelMSE * last.Seconds) : 0.0;
+	return true;
+}
+
+std::string ConvergenceBenchmark::GetReferencePath(const Options& options, const std::string& sceneName)
+{
+	// Scene files are named by their file name, edits to them are not detected
+	std::string name = std::filesystem::path(sceneName).stem().string();
+	name += "_" + std::to_string(options.Width) + "x" + std::to_string(options.Height);
+	name += "_" + std::to_string(options.ReferenceSamples) + "spp";
+	name += "_" + std::to_string(options.LightBounces) + "b";
+	name += "_f" + std::to_string((int)options.Filter);
+
+	return (std::filesystem::path(options.ReferenceDirectory) / (name + ".rtref")).string();
+}
+
+bool ConvergenceBenchmark::LoadReference(const std::string& path, const Options& options, std::vector<glm::vec3>& image)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+
+	Utils::ReferenceHeader header;
+	Utils::ReferenceHeader expected = Utils::MakeReferenceHeader(options);
+	if (!file.read((char*)&header, sizeof(header)) || memcmp(&header, &expected, sizeof(header)) != 0)
+		return false;
+
+	image.resize((size_t)header.Width * header.Height);
+	return (bool)file.read((char*)image.data(), image.size() * sizeof(glm::vec3));
+}
+
+bool ConvergenceBenchmark::SaveReference(const std::string& path, const Options& options, const std::vector<glm::vec3>& image)
+{
+	std::error_code errorCode;
+	std::filesystem::path directory = std::filesystem::path(path).parent_path();
+	if (!directory.empty())
+		std::filesystem::create_directories(directory, errorCode);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+		return false;
+
+	Utils::ReferenceHeader header = Utils::MakeReferenceHeader(options);
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)image.data(), image.size() * sizeof(glm::vec3));
+	return (bool)file;
+}
+
+bool ConvergenceBenchmark::WriteReport(std::ostream& stream, const Options& options, const std::vector<Result>& results)
+{
+	stream << "{\n";
+	stream << "\t\"Label\": \"" << EscapeJson(options.Label) << "\",\n";
+	stream << "\t\"Width\": " << options.Width << ",\n";
+	stream << "\t\"Height\": " << options.Height << ",\n";
+	stream << "\t\"LightBounces\": " << options.LightBounces << ",\n";
+	stream << "\t\"Seed\": " << options.Seed << ",\n";
+	stream << "\t\"RaysPerPixel\": " << options.RaysPerPixel << ",\n";
+	stream << "\t\"SplitPrimaryPaths\": " << (options.SplitPrimaryPaths ? "true" : "false") << ",\n";
+	stream << "\t\"Filter\": " << (int)options.Filter << ",\n";
+	stream << "\t\"ReferenceSamples\": " << options.ReferenceSamples << ",\n";
+	stream << "\t\"Results\": [";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const Result& result = results[i];
+
+		stream << (i == 0 ? "\n" : ",\n") << "\t\t{\n";
+		stream << "\t\t\t\"Scene\": \"" << EscapeJson(result.SceneName) << "\",\n";
+		stream << "\t\t\t\"ReferenceCached\": " << (result.ReferenceCached ? "true" : "false") << ",\n";
+		stream << "\t\t\t\"ReferenceSeconds\": " << result.ReferenceSeconds << ",\n";
+		stream << "\t\t\t\"Efficiency\": " << result.Efficiency << ",\n";
+		stream << "\t\t\t\"Points\": [";
+		for (size_t j = 0; j < result.Points.size(); j++)
+		{
+			const Point& point = result.Points[j];
+			stream << (j == 0 ? "\n" : ",\n") << "\t\t\t\t{ \"Samples\": " << point.Samples << ", \"Seconds\": " << point.Seconds
+				<< ", \"RMSE\": " << point.RMSE << ", \"RelMSE\": " << point.RelMSE << ", \"FlipError\": " << point.FlipError << " }";
+		}
+		stream << (result.Points.empty() ? "]\n" : "\n\t\t\t]\n");
+		stream << "\t\t}";
+	}
+
+	stream << (results.empty() ? "]\n" : "\n\t]\n");
+	stream << "}\n";
+	return (bool)stream;
+}
+
+bool ConvergenceBenchmark::WriteCsv(std::ostream& stream, const std::vector<Result>& results)
+{
+	stream << "Scene,Samples,Seconds,RMSE,RelMSE,FlipError\n";
+	for (const Result& result : results)
+	{
+		for (const Point& point : result.Points)
+		{
+			stream << result.SceneName << "," << point.Samples << "," << point.Seconds << "," << point.RMSE << ","
+				<< point.RelMSE << "," << point.FlipError << "\n";
+		}
+	}
+	return (bool)stream;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Renderer.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Measures noise against time: every scene is rendered with 1, 2, 4, ... samples per pixel and each step is compared
+// to a converged reference, giving RMSE, relMSE and a FLIP-like error over samples and seconds. A change to sampling
+// pays off if it reaches the same error in less time, not if it traces more rays per second.
+// References take long, they are rendered once with independent seeds and cached in a directory as linear floats.
+class ConvergenceBenchmark
+{
+public:
+	struct Options
+	{
+		// Empty runs TwoSpheres, ColorRoom and RefractionTest
+		std::vector<std::string> Scenes;
+		uint32_t Width = 240, Height = 135;
+		int LightBounces = 5;
+		uint32_t Seed = 1;
+
+		// The settings under test, the filter changes the converged image and is part of the reference
+		int RaysPerPixel = 1;
+		bool SplitPrimaryPaths = false;
+		Renderer::PixelFilter Filter = Renderer::PixelFilter::BlackmanHarris;
+
+		uint32_t MaxSamples = 256;
+		// Stops doubling the samples of a scene once its render time passes this, 0 goes on to MaxSamples
+		double TimeBudget = 0.0;
+
+		uint32_t ReferenceSamples = 4096;
+		std::string ReferenceDirectory = "benchmark_references";
+		bool RebuildReferences = false;
+
+		// 0 uses every hardware thread
+		int ThreadCount = 0;
+		std::string Label;
+		// One row per scene and step, empty writes none
+		std::string CsvPath;
+	};
+
+	struct Point
+	{
+		uint32_t Samples = 0;
+		// Render time of all samples so far
+		double Seconds = 0.0;
+		double RMSE = 0.0, RelMSE = 0.0, FlipError = 0.0;
+	};
+
+	struct Result
+	{
+		std::string SceneName;
+		bool ReferenceCached = false;
+		double ReferenceSeconds = 0.0;
+		std::vector<Point> Points;
+		// 1 / (relMSE * seconds) at the last step, higher is better and independent of the step for unbiased methods
+		double Efficiency = 0.0;
+	};
+public:
+	// Writes the report to the stream once every case ran, returns the process exit code
+	static int Run(const Options& options, std::ostream& report);
+	// Renders the reference if it is not cached yet and one curve, the scenes of the options are ignored
+	static bool RunScene(const Options& options, const std::string& sceneName, const std::shared_ptr<ThreadPool>& threadPool, Result& result, std::string& error);
+
+	static std::string GetReferencePath(const Options& options, const std::string& sceneName);
+	static bool LoadReference(const std::string& path, const Options& options, std::vector<glm::vec3>& image);
+	static bool SaveReference(const std::string& path, const Options& options, const std::vector<glm::vec3>& image);
+
+	static bool WriteReport(std::ostream& stream, const Options& options, const std::vector<Result>& results);
+	static bool WriteCsv(std::ostream& stream, const std::vector<Result>& results);
+};
@@ -0,0 +1,157 @@
+#include "ImageMetrics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Utils {
+	// D65 white point
+	static const glm::vec3 WhitePoint(0.950428545f, 1.0f, 1.088900371f);
+
+	static float SRGBToLinear(float value)
+	{
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	static glm::vec3 LinearRGBToXYZ(const glm::vec3& color)
+	{
+		return glm::vec3(
+			0.4124564f * color.r + 0.3575761f * color.g + 0.1804375f * color.b,
+			0.2126729f * color.r + 0.7151522f * color.g + 0.0721750f * color.b,
+			0.0193339f * color.r + 0.1191920f * color.g + 0.9503041f * color.b);
+	}
+
+	static glm::vec3 XYZToLinearRGB(const glm::vec3& xyz)
+	{
+		return glm::vec3(
+			3.2404542f * xyz.x - 1.5371385f * xyz.y - 0.4985314f * xyz.z,
+			-0.9692660f * xyz.x + 1.8760108f * xyz.y + 0.0415560f * xyz.z,
+			0.0556434f * xyz.x - 0.2040259f * xyz.y + 1.0572252f * xyz.z);
+	}
+
+	static glm::vec3 XYZToYCxCz(const glm::vec3& xyz)
+	{
+		glm::vec3 relative = xyz / WhitePoint;
+		return glm::vec3(116.0f * relative.y - 16.0f, 500.0f * (relative.x - relative.y), 200.0f * (relative.y - relative.z));
+	}
+
+	static glm::vec3 YCxCzToXYZ(const glm::vec3& ycxcz)
+	{
+		float y = (ycxcz.x + 16.0f) / 116.0f;
+		return glm::vec3(ycxcz.y / 500.0f + y, y, y - ycxcz.z / 200.0f) * WhitePoint;
+	}
+
+	static glm::vec3 XYZToLab(const glm::vec3& xyz)
+	{
+		const float delta = 6.0f / 29.0f;
+		auto f = [delta](float t) { return t > delta * delta * delta ? std::cbrt(t) : t / (3.0f * delta * delta) + 4.0f / 29.0f; };
+
+		glm::vec3 relative = xyz / WhitePoint;
+		float fy = f(relative.y);
+		return glm::vec3(116.0f * fy - 16.0f, 500.0f * (f(relative.x) - fy), 200.0f * (fy - f(relative.z)));
+	}
+
+	// Hunt adjusted L*a*b*, chroma fades with lightness
+	static glm::vec3 LinearRGBToHuntLab(const glm::vec3& color)
+	{
+		glm::vec3 lab = XYZToLab(LinearRGBToXYZ(glm::clamp(color, glm::vec3(0.0f), glm::vec3(1.0f))));
+		return glm::vec3(lab.x, 0.01f * lab.x * lab.y, 0.01f * lab.x * lab.z);
+	}
+
+	static float HyAB(const glm::vec3& a, const glm::vec3& b)
+	{
+		glm::vec2 chroma(a.y - b.y, a.z - b.z);
+		return std::abs(a.x - b.x) + glm::length(chroma);
+	}
+
+	// Display values in an opponent space, blurred with a 3x3 binomial kernel, back to Hunt adjusted L*a*b*
+	static std::vector<glm::vec3> PrepareImage(const std::vector<glm::vec3>& image, uint32_t width, uint32_t height)
+	{
+		std::vector<glm::vec3> opponent(image.size());
+		for (size_t i = 0; i < image.size(); i++)
+		{
+			glm::vec3 display = glm::clamp(image[i], glm::vec3(0.0f), glm::vec3(1.0f));
+			glm::vec3 linear(SRGBToLinear(display.r), SRGBToLinear(display.g), SRGBToLinear(display.b));
+			opponent[i] = XYZToYCxCz(LinearRGBToXYZ(linear));
+		}
+
+		const float weights[3] = { 0.25f, 0.5f, 0.25f };
+		std::vector<glm::vec3> lab(image.size());
+		for (uint32_t y = 0; y < height; y++)
+		{
+			for (uint32_t x = 0; x < width; x++)
+			{
+				glm::vec3 sum(0.0f);
+				for (int dy = -1; dy <= 1; dy++)
+				{
+					for (int dx = -1; dx <= 1; dx++)
+					{
+						uint32_t sampleX = (uint32_t)std::clamp((int)x + dx, 0, (int)width - 1);
+						uint32_t sampleY = (uint32_t)std::clamp((int)y + dy, 0, (int)height - 1);
+						sum += opponent[sampleX + sampleY * width] * (weights[dx + 1] * weights[dy + 1]);
+					}
+				}
+
+				lab[x + y * width] = LinearRGBToHuntLab(XYZToLinearRGB(YCxCzToXYZ(sum)));
+			}
+		}
+
+		return lab;
+	}
+}
+
+namespace ImageMetrics {
+
+	double RMSE(const std::vector<glm::vec3>& image, const std::vector<glm::vec3>& reference)
+	{
+		double sum = 0.0;
+		for (size_t i = 0; i < image.size(); i++)
+		{
+			glm::dvec3 difference = glm::dvec3(image[i]) - glm::dvec3(reference[i]);
+			sum += glm::dot(difference, difference);
+		}
+		return std::sqrt(sum / (image.size() * 3.0));
+	}
+
+	double RelMSE(const std::vector<glm::vec3>& image, const std::vector<glm::vec3>& reference)
+	{
+		// Keeps black reference pixels from dividing by zero
+		const double epsilon = 0.01;
+
+		double sum = 0.0;
+		for (size_t i = 0; i < image.size(); i++)
+		{
+			for (int channel = 0; channel < 3; channel++)
+			{
+				double difference = (double)image[i][channel] - reference[i][channel];
+				sum += difference * difference / ((double)reference[i][channel] * reference[i][channel] + epsilon);
+			}
+		}
+		return sum / (image.size() * 3.0);
+	}
+
+	double FlipLikeError(const std::vector<glm::vec3>& image, const std::vector<glm::vec3>& reference, uint32_t width, uint32_t height)
+	{
+		std::vector<glm::vec3> imageLab = Utils::PrepareImage(image, width, height);
+		std::vector<glm::vec3> referenceLab = Utils::PrepareImage(reference, width, height);
+
+		// Largest difference in the color space, between pure green and pure blue
+		const float exponent = 0.7f;
+		float maxDifference = std::pow(Utils::HyAB(Utils::LinearRGBToHuntLab(glm::vec3(0.0f, 1.0f, 0.0f)),
+			Utils::LinearRGBToHuntLab(glm::vec3(0.0f, 0.0f, 1.0f))), exponent);
+
+		// Differences below the cutoff are compressed into [0, 0.95), the rest spread over the top of the range
+		const float cutoff = 0.4f, cutoffError = 0.95f;
+
+		double sum = 0.0;
+		for (size_t i = 0; i < imageLab.size(); i++)
+		{
+			float difference = std::pow(Utils::HyAB(imageLab[i], referenceLab[i]), exponent);
+			float error = difference < cutoff * maxDifference
+				? cutoffError / (cutoff * maxDifference) * difference
+				: cutoffError + (difference - cutoff * maxDifference) / (maxDifference - cutoff * maxDifference) * (1.0f - cutoffError);
+			sum += std::min(error, 1.0f);
+		}
+		return sum / std::max<size_t>(imageLab.size(), 1);
+	}
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// Error of a noisy render against a converged reference, both as linear RGB, one value per pixel
+namespace ImageMetrics {
+
+	// Root mean squared error over all pixels and channels
+	double RMSE(const std::vector<glm::vec3>& image, const std::vector<glm::vec3>& reference);
+	// Squared error relative to the squared reference value, so dark regions count as much as bright ones
+	double RelMSE(const std::vector<glm::vec3>& image, const std::vector<glm::vec3>& reference);
+
+	// Mean perceptual color difference in [0, 1], after the color pipeline of NVIDIA's FLIP: both images are clamped to
+	// the display range the viewport shows, blurred slightly in an opponent color space as the eye would at normal
+	// viewing distance, and compared with the HyAB distance in L*a*b*. The edge and point detection of full FLIP
+	// is left out, the numbers are comparable with each other but not with published FLIP values
+	double FlipLikeError(const std::vector<glm::vec3>& image, const std::vector<glm::vec3>& reference, uint32_t width, uint32_t height);
+
+}
@@ -0,0 +1,275 @@
+#include "MicroBenchmark.h"
+
+#include "Json.h"
+#include "Object.h"
+#include "Ray.h"
+#include "RenderUtils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+
+namespace Utils {
+	// Every pass folds its results into a value stored here, so the compiler can not drop the calls
+	static volatile float s_Sink = 0.0f;
+
+	// Fixed seed, every run times the same data
+	struct DataSet
+	{
+		std::vector<Ray> Rays;
+		std::vector<Sphere> Spheres;
+		std::vector<Cube> Cubes;
+		// Spheres and cubes in random order, called through the base class as the renderer does
+		std::vector<std::unique_ptr<RTObject>> Objects;
+
+		std::vector<glm::vec3> CubeSurfacePoints;
+		std::vector<glm::vec3> Normals;
+		std::vector<float> IORs;
+		std::vector<glm::vec4> Colors;
+		std::vector<uint32_t> Seeds;
+
+		explicit DataSet(uint32_t count)
+		{
+			std::mt19937 engine(1337);
+			std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+			std::uniform_real_distribution<float> signedUnit(-1.0f, 1.0f);
+			auto randomVec3 = [&](float scale) { return glm::vec3(signedUnit(engine), signedUnit(engine), signedUnit(engine)) * scale; };
+
+			Spheres.resize(count);
+			Cubes.resize(count);
+			for (uint32_t i = 0; i < count; i++)
+			{
+				Spheres[i].Position = randomVec3(5.0f);
+				Spheres[i].Radius = 0.5f + unit(engine) * 2.5f;
+
+				Cubes[i].Position = randomVec3(5.0f);
+				Cubes[i].Dimensions = glm::vec3(0.5f) + glm::abs(randomVec3(2.5f));
+			}
+
+			// Rays aim near primitive i, so about half of them hit it
+			Rays.resize(count);
+			for (uint32_t i = 0; i < count; i++)
+			{
+				Rays[i].Origin = randomVec3(10.0f);
+				glm::vec3 target = (i % 2 == 0 ? Spheres[i].Position : Cubes[i].Position) + randomVec3(4.0f);
+				Rays[i].Direction = glm::normalize(target - Rays[i].Origin + glm::vec3(1e-3f));
+			}
+
+			for (uint32_t i = 0; i < count; i++)
+			{
+				if (engine() % 2 == 0)
+					Objects.push_back(std::make_unique<Sphere>(Spheres[i]));
+				else
+					Objects.push_back(std::make_unique<Cube>(Cubes[i]));
+			}
+
+			// A random face, scaled by the box dimensions
+			CubeSurfacePoints.resize(count);
+			for (uint32_t i = 0; i < count; i++)
+			{
+				glm::vec3 point = randomVec3(1.0f);
+				int axis = engine() % 3;
+				point[axis] = point[axis] < 0.0f ? -1.0f : 1.0f;
+				CubeSurfacePoints[i] = point * Cubes[i].Dimensions;
+			}
+
+			Normals.resize(count);
+			IORs.resize(count);
+			Colors.resize(count);
+			Seeds.resize(count);
+			for (uint32_t i = 0; i < count; i++)
+			{
+				Normals[i] = glm::normalize(randomVec3(1.0f) + glm::vec3(1e-3f));
+				IORs[i] = 1.0f + unit(engine);
+				Colors[i] = glm::vec4(unit(engine), unit(engine), unit(engine), 1.0f);
+				Seeds[i] = engine();
+			}
+		}
+	};
+
+	struct Kernel
+	{
+		const char* Name;
+		// One pass over the data set, returns a value depending on every call
+		std::function<float()> Pass;
+	};
+
+	static std::vector<Kernel> CreateKernels(DataSet& data)
+	{
+		size_t count = data.Rays.size();
+
+		std::vector<Kernel> kernels;
+		kernels.push_back({ "Sphere::Intersection", [&data, count]()
+			{
+				float sum = 0.0f;
+				for (size_t i = 0; i < count; i++)
+					sum += data.Spheres[i].Intersection(data.Rays[i]).x;
+				return sum;
+			} });
+
+		kernels.push_back({ "Cube::Intersection", [&data, count]()
+			{
+				float sum = 0.0f;
+				for (size_t i = 0; i < count; i++)
+					sum += data.Cubes[i].Intersection(data.Rays[i]).x;
+				return sum;
+			} });
+
+		kernels.push_back({ "RTObject::Intersection (virtual)", [&data, count]()
+			{
+				float sum = 0.0f;
+				for (size_t i = 0; i < count; i++)
+					sum += data.Objects[i]->Intersection(data.Rays[i]).x;
+				return sum;
+			} });
+
+		kernels.push_back({ "Cube::Normal", [&data, count]()
+			{
+				glm::vec3 sum(0.0f);
+				for (size_t i = 0; i < count; i++)
+					sum += data.Cubes[i].Normal(data.CubeSurfacePoints[i]);
+				return sum.x + sum.y + sum.z;
+			} });
+
+		kernels.push_back({ "Utils::PCG_Hash", [&data, count]()
+			{
+				uint32_t sum = 0;
+				for (size_t i = 0; i < count; i++)
+					sum += Utils::PCG_Hash(data.Seeds[i]);
+				return (float)sum;
+			} });
+
+		kernels.push_back({ "Utils::RandomFloat", [&data, count]()
+			{
+				float sum = 0.0f;
+				for (size_t i = 0; i < count; i++)
+				{
+					uint32_t seed = data.Seeds[i];
+					sum += Utils::RandomFloat(seed);
+				}
+				return sum;
+			} });
+
+		kernels.push_back({ "Utils::InUnitSphere", [&data, count]()
+			{
+				glm::vec3 sum(0.0f);
+				for (size_t i = 0; i < count; i++)
+				{
+					uint32_t seed = data.Seeds[i];
+					sum += Utils::InUnitSphere(seed);
+				}
+				return sum.x + sum.y + sum.z;
+			} });
+
+		kernels.push_back({ "Utils::Refract", [&data, count]()
+			{
+				glm::vec3 sum(0.0f);
+				for (size_t i = 0; i < count; i++)
+					sum += Utils::Refract(data.Rays[i].Direction, data.Normals[i], data.IORs[i]);
+				return sum.x + sum.y + sum.z;
+			} });
+
+		kernels.push_back({ "Utils::ConvertToRGBA", [&data, count]()
+			{
+				uint32_t sum = 0;
+				for (size_t i = 0; i < count; i++)
+					sum += Utils::ConvertToRGBA(data.Colors[i]);
+				return (float)sum;
+			} });
+
+		return kernels;
+	}
+}
+
+int MicroBenchmark::Run(const Options& options, std::ostream& report)
+{
+	uint32_t count = std::max(options.Count, 1u);
+	uint32_t passes = std::max(options.Passes, 1u);
+
+	Utils::DataSet data(count);
+	std::vector<Utils::Kernel> kernels = Utils::CreateKernels(data);
+
+	std::vector<Result> results;
+	for (const Utils::Kernel& kernel : kernels)
+	{
+		if (!options.Filter.empty() && std::string(kernel.Name).find(options.Filter) == std::string::npos)
+			continue;
+
+		for (uint32_t pass = 0; pass < options.WarmupPasses; pass++)
+			Utils::s_Sink = Utils::s_Sink + kernel.Pass();
+
+		std::vector<double> nanoseconds(passes);
+		for (double& passNanoseconds : nanoseconds)
+		{
+			auto startTime = std::chrono::steady_clock::now();
+			float value = kernel.Pass();
+			auto passTime = std::chrono::steady_clock::now() - startTime;
+
+			Utils::s_Sink = Utils::s_Sink + value;
+			passNanoseconds = std::chrono::duration<double, std::nano>(passTime).count() / count;
+		}
+
+		Result result;
+		result.Name = kernel.Name;
+
+		double sum = 0.0;
+		for (double passNanoseconds : nanoseconds)
+			sum += passNanoseconds;
+		result.MeanNs = sum / passes;
+
+		double squaredDeviations = 0.0;
+		for (double passNanoseconds : nanoseconds)
+			squaredDeviations += (passNanoseconds - result.MeanNs) * (passNanoseconds - result.MeanNs);
+		result.StdDevNs = passes > 1 ? std::sqrt(squaredDeviations / (passes - 1)) : 0.0;
+
+		std::sort(nanoseconds.begin(), nanoseconds.end());
+		result.MedianNs = nanoseconds[passes / 2];
+		result.MinNs = nanoseconds.front();
+		result.MaxNs = nanoseconds.back();
+		result.CallsPerSecond = result.MedianNs > 0.0 ? 1.0e9 / result.MedianNs : 0.0;
+
+		std::cerr << kernel.Name << ": " << result.MedianNs << " ns (+- " << result.StdDevNs << ")\n";
+		results.push_back(result);
+	}
+
+	if (results.empty())
+	{
+		std::cerr << "No kernel matches '" << options.Filter << "'\n";
+		return 1;
+	}
+
+	return WriteReport(report, options, results) ? 0 : 1;
+}
+
+bool MicroBenchmark::WriteReport(std::ostream& stream, const Options& options, const std::vector<Result>& results)
+{
+	stream << "{\n";
+	stream << "\t\"Label\": \"" << EscapeJson(options.Label) << "\",\n";
+	stream << "\t\"Count\": " << std::max(options.Count, 1u) << ",\n";
+	stream << "\t\"WarmupPasses\": " << options.WarmupPasses << ",\n";
+	stream << "\t\"Passes\": " << std::max(options.Passes, 1u) << ",\n";
+	stream << "\t\"Kernels\": [";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const Result& result = results[i];
+
+		stream << (i == 0 ? "\n" : ",\n") << "\t\t{\n";
+		stream << "\t\t\t\"Name\": \"" << EscapeJson(result.Name) << "\",\n";
+		stream << "\t\t\t\"MedianNs\": " << result.MedianNs << ",\n";
+		stream << "\t\t\t\"MeanNs\": " << result.MeanNs << ",\n";
+		stream << "\t\t\t\"StdDevNs\": " << result.StdDevNs << ",\n";
+		stream << "\t\t\t\"MinNs\": " << result.MinNs << ",\n";
+		stream << "\t\t\t\"MaxNs\": " << result.MaxNs << ",\n";
+		stream << "\t\t\t\"CallsPerSecond\": " << result.CallsPerSecond << "\n";
+		stream << "\t\t}";
+	}
+
+	stream << (results.empty() ? "]\n" : "\n\t]\n");
+	stream << "}\n";
+	return (bool)stream;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Times the kernels the path tracer spends its samples in, each on its own over a large randomized set of rays,
+// primitives and seeds: object intersections and normals, the random number generator, refraction and color packing.
+// A kernel runs a few untimed passes over its set, then every timed pass is one sample of the time per call.
+class MicroBenchmark
+{
+public:
+	struct Options
+	{
+		// Rays, primitives or seeds in every set
+		uint32_t Count = 1 << 16;
+		uint32_t WarmupPasses = 5;
+		uint32_t Passes = 30;
+		// Only kernels whose name contains this
+		std::string Filter;
+		std::string Label;
+	};
+
+	struct Result
+	{
+		std::string Name;
+
+		// Nanoseconds per call over all timed passes
+		double MedianNs = 0.0, MeanNs = 0.0, StdDevNs = 0.0;
+		double MinNs = 0.0, MaxNs = 0.0;
+		double CallsPerSecond = 0.0;
+	};
+public:
+	// Writes the report to the stream once every case ran, returns the process exit code
+	static int Run(const Options& options, std::ostream& report);
+
+	static bool WriteReport(std::ostream& stream, const Options& options, const std::vector<Result>& results);
+};
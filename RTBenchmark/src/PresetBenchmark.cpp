@@ -0,0 +1,261 @@
+#include "PresetBenchmark.h"
+
+#include "Json.h"
+#include "SceneFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+namespace Utils {
+	static std::string HashImage(const uint32_t* pixels, size_t pixelCount)
+	{
+		// FNV-1a over the bytes of every pixel
+		uint64_t hash = 14695981039346656037ull;
+		for (size_t i = 0; i < pixelCount; i++)
+		{
+			for (int byte = 0; byte < 4; byte++)
+			{
+				hash ^= (pixels[i] >> (byte * 8)) & 0xff;
+				hash *= 1099511628211ull;
+			}
+		}
+
+		char text[17];
+		snprintf(text, sizeof(text), "%016llx", (unsigned long long)hash);
+		return text;
+	}
+
+	static double Ratio(uint64_t numerator, uint64_t denominator)
+	{
+		return denominator > 0 ? (double)numerator / (double)denominator : 0.0;
+	}
+
+	static void PrintPhases(const Renderer::PhaseCounters& phases)
+	{
+		if (!phases.HasHardwareCounters)
+			std::cerr << "  No hardware counters, " << phases.CounterError << "\n";
+
+		char line[256];
+		snprintf(line, sizeof(line), "  %-14s %10s %8s %8s %12s %12s %12s\n", "Phase", "Seconds", "Share", "IPC", "L1D miss/ki", "LLC miss/ki", "Br miss/ki");
+		std::cerr << line;
+
+		double totalSeconds = 0.0;
+		for (double seconds : phases.Seconds)
+			totalSeconds += seconds;
+
+		for (size_t i = 0; i < (size_t)Renderer::RenderPhase::Count; i++)
+		{
+			const PerfCounters::Values& counters = phases.Counters[i];
+			uint64_t instructions = counters[PerfCounters::Event::Instructions];
+
+			snprintf(line, sizeof(line), "  %-14s %10.4f %7.1f%% %8.2f %12.2f %12.2f %12.2f\n", Renderer::GetPhaseName((Renderer::RenderPhase)i),
+				phases.Seconds[i], totalSeconds > 0.0 ? phases.Seconds[i] / totalSeconds * 100.0 : 0.0,
+				Ratio(instructions, counters[PerfCounters::Event::Cycles]),
+				Ratio(counters[PerfCounters::Event::L1DMisses] * 1000, instructions),
+				Ratio(counters[PerfCounters::Event::LLCMisses] * 1000, instructions),
+				Ratio(counters[PerfCounters::Event::BranchMisses] * 1000, instructions));
+			std::cerr << line;
+		}
+	}
+
+	static void WritePhases(std::ostream& stream, const Renderer::PhaseCounters& phases)
+	{
+		stream << ",\n\t\t\t\"HardwareCounters\": " << (phases.HasHardwareCounters ? "true" : "false") << ",\n";
+		if (!phases.HasHardwareCounters)
+			stream << "\t\t\t\"CounterError\": \"" << EscapeJson(phases.CounterError) << "\",\n";
+
+		stream << "\t\t\t\"Phases\": [";
+		for (size_t i = 0; i < (size_t)Renderer::RenderPhase::Count; i++)
+		{
+			const PerfCounters::Values& counters = phases.Counters[i];
+
+			stream << (i == 0 ? "\n" : ",\n") << "\t\t\t\t{ \"Phase\": \"" << Renderer::GetPhaseName((Renderer::RenderPhase)i) << "\", \"Seconds\": " << phases.Seconds[i];
+			for (size_t event = 0; event < (size_t)PerfCounters::Event::Count; event++)
+				stream << ", \"" << PerfCounters::GetEventName((PerfCounters::Event)event) << "\": " << counters.Counts[event];
+			stream << ", \"IPC\": " << Ratio(counters[PerfCounters::Event::Instructions], counters[PerfCounters::Event::Cycles]) << " }";
+		}
+		stream << "\n\t\t\t]";
+	}
+}
+
+int PresetBenchmark::Run(const Options& options, std::ostream& report)
+{
+	auto threadPool = std::make_shared<ThreadPool>((uint32_t)std::max(options.ThreadCount, 0));
+	uint32_t repeats = std::max(options.Repeats, 1u);
+
+	std::vector<Result> results;
+	for (Case benchmarkCase : GetCases(options.Quick))
+	{
+		benchmarkCase.Order = options.Order;
+
+		Result result;
+		std::string error;
+		if (!RunCase(benchmarkCase, threadPool, repeats, result, error, options.Counters))
+		{
+			std::cerr << error << "\n";
+			return 1;
+		}
+
+		std::cerr << benchmarkCase.SceneName << ": " << result.Seconds << " s, " << result.RaysPerSecond / 1.0e6 << " M rays/s, "
+			<< result.MsPerSample << " ms/sample\n";
+		if (result.HasPhases)
+			Utils::PrintPhases(result.Phases);
+		results.push_back(result);
+	}
+
+	return WriteReport(report, options, threadPool->GetThreadCount(), results) ? 0 : 1;
+}
+
+std::vector<PresetBenchmark::Case> PresetBenchmark::GetCases(bool quick)
+{
+	std::vector<Case> cases(3);
+	cases[0].SceneName = "TwoSpheres";
+	cases[0].LightBounces = 5;
+
+	cases[1].SceneName = "ColorRoom";
+	cases[1].LightBounces = 8;
+
+	cases[2].SceneName = "RefractionTest";
+	cases[2].LightBounces = 8;
+
+	if (quick)
+	{
+		for (Case& benchmarkCase : cases)
+		{
+			benchmarkCase.Width /= 2;
+			benchmarkCase.Height /= 2;
+			benchmarkCase.Samples /= 4;
+		}
+	}
+
+	return cases;
+}
+
+bool PresetBenchmark::RunCase(const Case& benchmarkCase, const std::shared_ptr<ThreadPool>& threadPool, uint32_t repeats, Result& result, std::string& error,
+	bool countPhases)
+{
+	Scene scene;
+	Camera camera(45.0f, 0.1f, 100.0f);
+	if (!SceneFile::LoadFileOrPreset(benchmarkCase.SceneName, scene, camera, error))
+		return false;
+
+	camera.OnResize(benchmarkCase.Width, benchmarkCase.Height);
+
+	Renderer renderer;
+	renderer.SetThreadPool(threadPool);
+	renderer.GetSettings().LightBounces = benchmarkCase.LightBounces;
+	renderer.GetSettings().Seed = benchmarkCase.Seed;
+	renderer.GetSettings().Order = benchmarkCase.Order;
+	renderer.OnResize(benchmarkCase.Width, benchmarkCase.Height);
+
+	// Warms up caches, page tables and the pool's threads
+	renderer.RenderSamples(scene, camera, benchmarkCase.Samples);
+
+	struct Run
+	{
+		double Seconds = 0.0;
+		Renderer::RayCounts Rays;
+		std::vector<ThreadPool::WorkerStats> WorkerStats;
+	};
+
+	std::vector<Run> runs(repeats);
+	for (Run& run : runs)
+	{
+		renderer.ResetFrameIndex();
+		renderer.ResetRayCounts();
+		threadPool->ResetWorkerStats();
+
+		auto startTime = std::chrono::steady_clock::now();
+		renderer.RenderSamples(scene, camera, benchmarkCase.Samples);
+		run.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+		run.Rays = renderer.GetRayCounts();
+		run.WorkerStats = threadPool->GetWorkerStats();
+	}
+
+	// After the timed runs, phased tiles are slower and would skew them
+	result.HasPhases = countPhases;
+	if (countPhases)
+	{
+		renderer.SetPhaseCountersEnabled(true);
+		renderer.ResetPhaseCounters();
+		renderer.ResetFrameIndex();
+		renderer.RenderSamples(scene, camera, benchmarkCase.Samples);
+		renderer.SetPhaseCountersEnabled(false);
+
+		result.Phases = renderer.GetPhaseCounters();
+	}
+
+	scene.DeleteObjects();
+
+	std::sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) { return a.Seconds < b.Seconds; });
+	const Run& median = runs[runs.size() / 2];
+
+	result.Settings = benchmarkCase;
+	result.Seconds = median.Seconds;
+	result.MinSeconds = runs.front().Seconds;
+	result.MaxSeconds = runs.back().Seconds;
+	result.MsPerSample = median.Seconds * 1000.0 / benchmarkCase.Samples;
+
+	result.PrimaryRays = median.Rays.PrimaryRays;
+	result.TotalRays = median.Rays.TotalRays;
+	result.PrimaryRaysPerSecond = median.Rays.PrimaryRays / median.Seconds;
+	result.RaysPerSecond = median.Rays.TotalRays / median.Seconds;
+
+	result.ThreadUtilization.clear();
+	for (const ThreadPool::WorkerStats& stats : median.WorkerStats)
+		result.ThreadUtilization.push_back(stats.BusySeconds / median.Seconds);
+
+	result.ImageHash = Utils::HashImage(renderer.GetImageData(), (size_t)benchmarkCase.Width * benchmarkCase.Height);
+	return true;
+}
+
+bool PresetBenchmark::WriteReport(std::ostream& stream, const Options& options, uint32_t threadCount, const std::vector<Result>& results)
+{
+	stream << "{\n";
+	stream << "\t\"Label\": \"" << EscapeJson(options.Label) << "\",\n";
+	stream << "\t\"ThreadCount\": " << threadCount << ",\n";
+	stream << "\t\"HardwareThreads\": " << std::thread::hardware_concurrency() << ",\n";
+	stream << "\t\"Repeats\": " << std::max(options.Repeats, 1u) << ",\n";
+	stream << "\t\"Quick\": " << (options.Quick ? "true" : "false") << ",\n";
+	stream << "\t\"TileOrder\": \"" << Renderer::GetTileOrderName(options.Order) << "\",\n";
+	stream << "\t\"Results\": [";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const Result& result = results[i];
+
+		stream << (i == 0 ? "\n" : ",\n") << "\t\t{\n";
+		stream << "\t\t\t\"Scene\": \"" << EscapeJson(result.Settings.SceneName) << "\",\n";
+		stream << "\t\t\t\"Width\": " << result.Settings.Width << ",\n";
+		stream << "\t\t\t\"Height\": " << result.Settings.Height << ",\n";
+		stream << "\t\t\t\"Samples\": " << result.Settings.Samples << ",\n";
+		stream << "\t\t\t\"LightBounces\": " << result.Settings.LightBounces << ",\n";
+		stream << "\t\t\t\"Seed\": " << result.Settings.Seed << ",\n";
+		stream << "\t\t\t\"Seconds\": " << result.Seconds << ",\n";
+		stream << "\t\t\t\"MinSeconds\": " << result.MinSeconds << ",\n";
+		stream << "\t\t\t\"MaxSeconds\": " << result.MaxSeconds << ",\n";
+		stream << "\t\t\t\"MsPerSample\": " << result.MsPerSample << ",\n";
+		stream << "\t\t\t\"PrimaryRays\": " << result.PrimaryRays << ",\n";
+		stream << "\t\t\t\"TotalRays\": " << result.TotalRays << ",\n";
+		stream << "\t\t\t\"PrimaryRaysPerSecond\": " << result.PrimaryRaysPerSecond << ",\n";
+		stream << "\t\t\t\"RaysPerSecond\": " << result.RaysPerSecond << ",\n";
+
+		stream << "\t\t\t\"ThreadUtilization\": [";
+		for (size_t thread = 0; thread < result.ThreadUtilization.size(); thread++)
+			stream << (thread == 0 ? "" : ", ") << result.ThreadUtilization[thread];
+		stream << "],\n";
+
+		stream << "\t\t\t\"ImageHash\": \"" << result.ImageHash << "\"";
+		if (result.HasPhases)
+			Utils::WritePhases(stream, result.Phases);
+		stream << "\n";
+		stream << "\t\t}";
+	}
+
+	stream << (results.empty() ? "]\n" : "\n\t]\n");
+	stream << "}\n";
+	return (bool)stream;
+}
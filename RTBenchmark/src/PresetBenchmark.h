@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Renderer.h"
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Renders the built-in presets headlessly with fixed resolution, seed, bounces and samples, so the numbers of two
+// runs on the same machine can be compared. Every case renders once to warm up, then as often as asked for, and
+// reports the run with the median time.
+class PresetBenchmark
+{
+public:
+	struct Case
+	{
+		std::string SceneName;
+		uint32_t Width = 640, Height = 360;
+		uint32_t Samples = 16;
+		int LightBounces = 5;
+		uint32_t Seed = 1;
+		Renderer::TileOrder Order = Renderer::TileOrder::Hilbert;
+	};
+
+	struct Result
+	{
+		Case Settings;
+
+		double Seconds = 0.0;
+		double MinSeconds = 0.0, MaxSeconds = 0.0;
+		double MsPerSample = 0.0;
+
+		uint64_t PrimaryRays = 0, TotalRays = 0;
+		double PrimaryRaysPerSecond = 0.0, RaysPerSecond = 0.0;
+
+		// Busy time over render time, one entry per pool worker followed by the calling thread
+		std::vector<double> ThreadUtilization;
+
+		// Same settings on the same build give the same image, a changed hash means a changed image
+		std::string ImageHash;
+
+		// Time and hardware counters per phase of one more render with phase counters, if asked for
+		bool HasPhases = false;
+		Renderer::PhaseCounters Phases;
+	};
+
+	struct Options
+	{
+		// 0 uses every hardware thread
+		int ThreadCount = 0;
+		uint32_t Repeats = 3;
+		// Quarter of the pixels and samples, for a check in a few seconds
+		bool Quick = false;
+		// Renders every case once more after the timed runs with the phases counted, see Renderer::SetPhaseCountersEnabled
+		bool Counters = false;
+		// Dispatch order of the tiles in every case
+		Renderer::TileOrder Order = Renderer::TileOrder::Hilbert;
+		std::string Label;
+	};
+public:
+	// Writes the report to the stream once every case ran, returns the process exit code
+	static int Run(const Options& options, std::ostream& report);
+
+	static std::vector<Case> GetCases(bool quick);
+	static bool RunCase(const Case& benchmarkCase, const std::shared_ptr<ThreadPool>& threadPool, uint32_t repeats, Result& result, std::string& error,
+		bool countPhases = false);
+
+	static bool WriteReport(std::ostream& stream, const Options& options, uint32_t threadCount, const std::vector<Result>& results);
+};
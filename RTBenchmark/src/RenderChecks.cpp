@@ -0,0 +1,82 @@
+#include "RenderChecks.h"
+
+#include "Renderer.h"
+#include "SceneFile.h"
+
+#include <algorithm>
+#include <iostream>
+
+int RenderChecks::Run(const Options& options)
+{
+	auto threadPool = std::make_shared<ThreadPool>(std::max(options.ThreadCount, 1u));
+
+	std::string error;
+	if (!CheckBudgetedFrames(threadPool, options.Frames, error))
+	{
+		std::cout << "BudgetedFrames FAILED: " << error << "\n";
+		return 1;
+	}
+	std::cout << "BudgetedFrames passed\n";
+
+	return 0;
+}
+
+bool RenderChecks::CheckBudgetedFrames(const std::shared_ptr<ThreadPool>& threadPool, uint32_t frames, std::string& error)
+{
+	const uint32_t width = 96, height = 64;
+
+	Scene scene;
+	Camera camera(45.0f, 0.1f, 100.0f);
+	if (!SceneFile::LoadFileOrPreset("TwoSpheres", scene, camera, error))
+		return false;
+
+	camera.OnResize(width, height);
+
+	Renderer renderer;
+	renderer.SetThreadPool(threadPool);
+	Renderer::Settings& settings = renderer.GetSettings();
+	settings.LightBounces = 2;
+	settings.RaysPerPixel = 1;
+	settings.ProgressiveRefinement = false;
+	settings.FrameBudget = 5.0f;
+	settings.TileSize = 32;
+	renderer.OnResize(width, height);
+
+	bool passed = true;
+	for (uint32_t frame = 0; frame < frames && passed; frame++)
+	{
+		renderer.ResetFrameIndex();
+		renderer.Render(scene, camera);
+
+		const std::vector<Renderer::Tile>& tiles = renderer.GetTiles();
+		const std::vector<uint32_t>& tilePasses = renderer.GetTilePasses();
+		const glm::vec4* accumulation = renderer.GetAccumulationData();
+		if (tilePasses.size() != tiles.size())
+		{
+			error = "the renderer credited " + std::to_string(tilePasses.size()) + " tiles instead of " + std::to_string(tiles.size());
+			passed = false;
+			break;
+		}
+
+		for (size_t tileIndex = 0; tileIndex < tiles.size() && passed; tileIndex++)
+		{
+			const Renderer::Tile& tile = tiles[tileIndex];
+			for (uint32_t y = tile.MinY; y < tile.MaxY && passed; y++)
+			{
+				for (uint32_t x = tile.MinX; x < tile.MaxX && passed; x++)
+				{
+					float samples = accumulation[x + y * width].a;
+					if (tilePasses[tileIndex] == 0 || samples != (float)tilePasses[tileIndex])
+					{
+						error = "frame " + std::to_string(frame) + ", pixel (" + std::to_string(x) + ", " + std::to_string(y) + ") holds " +
+							std::to_string((int)samples) + " samples, its tile was credited with " + std::to_string(tilePasses[tileIndex]) + " passes";
+						passed = false;
+					}
+				}
+			}
+		}
+	}
+
+	scene.DeleteObjects();
+	return passed;
+}
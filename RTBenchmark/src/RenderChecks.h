@@ -0,0 +1,29 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Checks of renderer invariants that timings would not catch, run on their own or before the gate compares numbers.
+// Every check reports the first violation it finds.
+class RenderChecks
+{
+public:
+	struct Options
+	{
+		// Workers of the pool the checks render on, more than the hardware has makes races more likely
+		uint32_t ThreadCount = 8;
+		// Frames per check, races between passes only show up now and then
+		uint32_t Frames = 100;
+	};
+public:
+	// Returns the process exit code, 1 if a check failed
+	static int Run(const Options& options);
+
+	// Renders first frames with a budget over a handful of tiles, so later passes come around to a tile while an earlier
+	// one may still hold it. Every pixel has to hold exactly the samples of the passes its tile was credited with, a pass
+	// that ran ahead of an earlier one breaks that
+	static bool CheckBudgetedFrames(const std::shared_ptr<ThreadPool>& threadPool, uint32_t frames, std::string& error);
+};
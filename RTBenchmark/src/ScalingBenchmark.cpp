@@ -0,0 +1,157 @@
+#include "ScalingBenchmark.h"
+
+#include "Json.h"
+#include "Renderer.h"
+#include "SceneGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+#if defined(__linux__)
+	#include <unistd.h>
+#endif
+
+namespace Utils {
+	static uint64_t GetSceneBytes(const Scene& scene)
+	{
+		uint64_t bytes = scene.SceneObjects.capacity() * sizeof(RTObject*) + scene.Materials.capacity() * sizeof(Material);
+		for (RTObject* object : scene.SceneObjects)
+		{
+			if (dynamic_cast<Sphere*>(object))
+				bytes += sizeof(Sphere);
+			else if (dynamic_cast<Cube*>(object))
+				bytes += sizeof(Cube);
+			else
+				bytes += sizeof(RTObject);
+		}
+		return bytes;
+	}
+
+	static uint64_t GetResidentBytes()
+	{
+#if defined(__linux__)
+		FILE* file = fopen("/proc/self/statm", "r");
+		if (!file)
+			return 0;
+
+		unsigned long long totalPages = 0, residentPages = 0;
+		int fields = fscanf(file, "%llu %llu", &totalPages, &residentPages);
+		fclose(file);
+
+		return fields == 2 ? residentPages * (uint64_t)sysconf(_SC_PAGESIZE) : 0;
+#else
+		return 0;
+#endif
+	}
+}
+
+int ScalingBenchmark::Run(const Options& options, std::ostream& report)
+{
+	std::vector<std::string> generators = options.Generators;
+	if (generators.empty())
+		generators = { "RandomPrimitives", "InstanceGrid", "GlassCluster" };
+
+	auto threadPool = std::make_shared<ThreadPool>((uint32_t)std::max(options.ThreadCount, 0));
+
+	std::vector<Result> results;
+	for (const std::string& generator : generators)
+	{
+		for (uint64_t count = std::max(options.MinObjects, 1u); count <= options.MaxObjects; count *= 10)
+		{
+			Scene scene;
+			Camera camera(45.0f, 0.1f, 100.0f);
+
+			auto buildStart = std::chrono::steady_clock::now();
+			if (!SceneGenerator::Generate(generator, scene, camera, (uint32_t)count, options.Seed))
+			{
+				std::cerr << "Unknown generator " << generator << "\n";
+				return 1;
+			}
+
+			Result result;
+			result.Generator = generator;
+			result.BuildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count();
+			result.Objects = (uint32_t)scene.SceneObjects.size();
+			result.MemoryBytes = Utils::GetSceneBytes(scene);
+			result.ResidentBytes = Utils::GetResidentBytes();
+
+			// One sample per pixel, as many 16:9 pixels as the budget allows
+			double pixels = options.IntersectionBudget / ((double)result.Objects * (std::max(options.LightBounces, 0) + 1));
+			pixels = std::clamp(pixels, 16.0 * 9.0, 640.0 * 360.0);
+			result.Width = (uint32_t)std::sqrt(pixels * 16.0 / 9.0);
+			result.Height = std::max(result.Width * 9 / 16, 1u);
+
+			camera.OnResize(result.Width, result.Height);
+
+			Renderer renderer;
+			renderer.SetThreadPool(threadPool);
+			renderer.GetSettings().LightBounces = options.LightBounces;
+			renderer.GetSettings().Seed = options.Seed;
+			renderer.OnResize(result.Width, result.Height);
+
+			// Warms up caches and the accumulation buffer
+			renderer.RenderSamples(scene, camera, 1);
+
+			renderer.ResetFrameIndex();
+			renderer.ResetRayCounts();
+
+			auto renderStart = std::chrono::steady_clock::now();
+			renderer.RenderSamples(scene, camera, 1);
+			result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStart).count();
+
+			Renderer::RayCounts rays = renderer.GetRayCounts();
+			result.PrimaryRays = rays.PrimaryRays;
+			result.TotalRays = rays.TotalRays;
+			result.PrimaryRaysPerSecond = rays.PrimaryRays / result.Seconds;
+			result.RaysPerSecond = rays.TotalRays / result.Seconds;
+
+			scene.DeleteObjects();
+
+			std::cerr << generator << " " << result.Objects << " objects: built in " << result.BuildSeconds << " s, "
+				<< result.MemoryBytes / (1024.0 * 1024.0) << " MiB, " << result.RaysPerSecond / 1.0e6 << " M rays/s\n";
+			results.push_back(result);
+		}
+	}
+
+	return WriteReport(report, options, threadPool->GetThreadCount(), results) ? 0 : 1;
+}
+
+bool ScalingBenchmark::WriteReport(std::ostream& stream, const Options& options, uint32_t threadCount, const std::vector<Result>& results)
+{
+	stream << "{\n";
+	stream << "\t\"Label\": \"" << EscapeJson(options.Label) << "\",\n";
+	stream << "\t\"ThreadCount\": " << threadCount << ",\n";
+	stream << "\t\"LightBounces\": " << options.LightBounces << ",\n";
+	stream << "\t\"Seed\": " << options.Seed << ",\n";
+	stream << "\t\"IntersectionBudget\": " << options.IntersectionBudget << ",\n";
+	// Every ray is tested against every object
+	stream << "\t\"Acceleration\": \"None\",\n";
+	stream << "\t\"Results\": [";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const Result& result = results[i];
+
+		stream << (i == 0 ? "\n" : ",\n") << "\t\t{\n";
+		stream << "\t\t\t\"Generator\": \"" << EscapeJson(result.Generator) << "\",\n";
+		stream << "\t\t\t\"Objects\": " << result.Objects << ",\n";
+		stream << "\t\t\t\"BuildSeconds\": " << result.BuildSeconds << ",\n";
+		stream << "\t\t\t\"MemoryBytes\": " << result.MemoryBytes << ",\n";
+		stream << "\t\t\t\"ResidentBytes\": " << result.ResidentBytes << ",\n";
+		stream << "\t\t\t\"Width\": " << result.Width << ",\n";
+		stream << "\t\t\t\"Height\": " << result.Height << ",\n";
+		stream << "\t\t\t\"Seconds\": " << result.Seconds << ",\n";
+		stream << "\t\t\t\"PrimaryRays\": " << result.PrimaryRays << ",\n";
+		stream << "\t\t\t\"TotalRays\": " << result.TotalRays << ",\n";
+		stream << "\t\t\t\"PrimaryRaysPerSecond\": " << result.PrimaryRaysPerSecond << ",\n";
+		stream << "\t\t\t\"RaysPerSecond\": " << result.RaysPerSecond << "\n";
+		stream << "\t\t}";
+	}
+
+	stream << (results.empty() ? "]\n" : "\n\t]\n");
+	stream << "}\n";
+	return (bool)stream;
+}
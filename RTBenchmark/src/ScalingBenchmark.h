@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Renders generated scenes of growing size, ten times more objects per step, and reports build time, memory and
+// rays per second at each size. Every object is tested against every ray, so the image shrinks as scenes grow to
+// keep rays times objects within a budget; rays per second stay comparable across sizes and versions.
+class ScalingBenchmark
+{
+public:
+	struct Options
+	{
+		// Empty runs every generator
+		std::vector<std::string> Generators;
+		uint32_t MinObjects = 10;
+		// Up to 10 million, beyond 100000 a single size takes minutes without an acceleration structure
+		uint32_t MaxObjects = 100000;
+		// Rays times objects of one render
+		double IntersectionBudget = 2.0e8;
+		int LightBounces = 3;
+		uint32_t Seed = 1;
+		// 0 uses every hardware thread
+		int ThreadCount = 0;
+		std::string Label;
+	};
+
+	struct Result
+	{
+		std::string Generator;
+		uint32_t Objects = 0;
+
+		double BuildSeconds = 0.0;
+		// Objects, the pointer array and materials as allocated, without allocator overhead
+		uint64_t MemoryBytes = 0;
+		// Resident size of the whole process after the build, 0 where it can not be read
+		uint64_t ResidentBytes = 0;
+
+		uint32_t Width = 0, Height = 0;
+		double Seconds = 0.0;
+		uint64_t PrimaryRays = 0, TotalRays = 0;
+		double PrimaryRaysPerSecond = 0.0, RaysPerSecond = 0.0;
+	};
+public:
+	// Writes the report to the stream once every case ran, returns the process exit code
+	static int Run(const Options& options, std::ostream& report);
+
+	static bool WriteReport(std::ostream& stream, const Options& options, uint32_t threadCount, const std::vector<Result>& results);
+};
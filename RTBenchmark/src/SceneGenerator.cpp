@@ -0,0 +1,162 @@
+#include "SceneGenerator.h"
+
+#include <cmath>
+#include <random>
+
+namespace Utils {
+	static void ResetScene(Scene& scene, uint32_t objectCount)
+	{
+		scene.DeleteObjects();
+		scene = Scene();
+		scene.SkyColor = glm::vec3(0.6f, 0.7f, 0.8f);
+		scene.SceneObjects.reserve(objectCount);
+	}
+
+	static int AddLight(Scene& scene)
+	{
+		Material& light = scene.Materials.emplace_back();
+		light.EmissionColor = glm::vec3(1.0f, 0.95f, 0.85f);
+		light.EmissionPower = 4.0f;
+		return (int)scene.Materials.size() - 1;
+	}
+
+	static void AddSphere(Scene& scene, const glm::vec3& position, float radius, int materialIndex)
+	{
+		Sphere* sphere = new Sphere();
+		sphere->Position = position;
+		sphere->Radius = radius;
+		sphere->MaterialIndex = materialIndex;
+		scene.SceneObjects.push_back(sphere);
+	}
+
+	static void AddCube(Scene& scene, const glm::vec3& position, const glm::vec3& dimensions, int materialIndex)
+	{
+		Cube* cube = new Cube();
+		cube->Position = position;
+		cube->Dimensions = dimensions;
+		cube->MaterialIndex = materialIndex;
+		scene.SceneObjects.push_back(cube);
+	}
+}
+
+namespace SceneGenerator {
+
+	void RandomPrimitives(Scene& scene, Camera& camera, uint32_t count, uint32_t seed)
+	{
+		Utils::ResetScene(scene, count);
+
+		std::mt19937 engine(seed);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		const int diffuseMaterials = 6;
+		for (int i = 0; i < diffuseMaterials; i++)
+		{
+			Material& material = scene.Materials.emplace_back();
+			material.Color = glm::vec3(unit(engine), unit(engine), unit(engine));
+			material.Smoothness = unit(engine);
+			material.Metallness = unit(engine) * 0.5f;
+		}
+		int lightMaterial = Utils::AddLight(scene);
+
+		// About one object per 8 cubic units
+		float halfExtent = std::cbrt((float)count);
+		std::uniform_real_distribution<float> coordinate(-halfExtent, halfExtent);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			glm::vec3 position(coordinate(engine), coordinate(engine), coordinate(engine));
+			int materialIndex = i % 16 == 0 ? lightMaterial : (int)(engine() % diffuseMaterials);
+
+			if (i % 2 == 0)
+				Utils::AddSphere(scene, position, 0.2f + unit(engine) * 0.6f, materialIndex);
+			else
+				Utils::AddCube(scene, position, glm::vec3(0.2f) + glm::vec3(unit(engine), unit(engine), unit(engine)) * 0.5f, materialIndex);
+		}
+
+		camera.SetView(glm::vec3(0.0f, 0.0f, halfExtent * 2.5f + 2.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+	}
+
+	void InstanceGrid(Scene& scene, Camera& camera, uint32_t count)
+	{
+		Utils::ResetScene(scene, count + 1);
+
+		Material& floorMaterial = scene.Materials.emplace_back();
+		floorMaterial.Color = glm::vec3(0.5f);
+		floorMaterial.Smoothness = 0.05f;
+
+		Material& sphereMaterial = scene.Materials.emplace_back();
+		sphereMaterial.Color = glm::vec3(0.8f, 0.3f, 0.2f);
+		sphereMaterial.Smoothness = 0.9f;
+		sphereMaterial.Metallness = 0.6f;
+
+		int lightMaterial = Utils::AddLight(scene);
+
+		uint32_t side = (uint32_t)std::ceil(std::sqrt((float)count));
+		const float spacing = 2.5f;
+		float halfExtent = side * spacing * 0.5f;
+
+		Utils::AddCube(scene, glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(halfExtent + 10.0f, 0.01f, halfExtent + 10.0f), 0);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint32_t x = i % side;
+			uint32_t z = i / side;
+			glm::vec3 position((x + 0.5f) * spacing - halfExtent, 0.0f, (z + 0.5f) * spacing - halfExtent);
+			Utils::AddSphere(scene, position, 1.0f, (x + z) % 7 == 0 ? lightMaterial : 1);
+		}
+
+		camera.SetView(glm::vec3(0.0f, halfExtent * 0.8f + 3.0f, halfExtent * 1.2f + 6.0f), glm::vec3(0.0f, -0.6f, -1.0f));
+	}
+
+	void GlassCluster(Scene& scene, Camera& camera, uint32_t count, uint32_t seed)
+	{
+		Utils::ResetScene(scene, count + 1);
+
+		std::mt19937 engine(seed);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		std::uniform_real_distribution<float> signedUnit(-1.0f, 1.0f);
+
+		const int glassMaterials = 4;
+		for (int i = 0; i < glassMaterials; i++)
+		{
+			Material& glass = scene.Materials.emplace_back();
+			glass.Color = glm::vec3(0.6f) + glm::vec3(unit(engine), unit(engine), unit(engine)) * 0.4f;
+			glass.Smoothness = 0.985f;
+			glass.Transmission = 0.95f;
+			glass.IOR = 1.5f;
+		}
+		int lightMaterial = Utils::AddLight(scene);
+
+		// Spheres of radius 0.5 about one unit apart, so neighbours overlap
+		float clusterRadius = std::cbrt((float)count) * 0.55f;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			glm::vec3 position;
+			do
+			{
+				position = glm::vec3(signedUnit(engine), signedUnit(engine), signedUnit(engine));
+			} while (glm::dot(position, position) > 1.0f);
+
+			Utils::AddSphere(scene, position * clusterRadius, 0.5f, (int)(engine() % glassMaterials));
+		}
+
+		Utils::AddSphere(scene, glm::vec3(0.0f, clusterRadius * 2.0f + 4.0f, 0.0f), clusterRadius + 1.0f, lightMaterial);
+
+		camera.SetView(glm::vec3(0.0f, 0.0f, clusterRadius * 3.0f + 3.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+	}
+
+	bool Generate(const std::string& name, Scene& scene, Camera& camera, uint32_t count, uint32_t seed)
+	{
+		if (name == "RandomPrimitives")
+			RandomPrimitives(scene, camera, count, seed);
+		else if (name == "InstanceGrid")
+			InstanceGrid(scene, camera, count);
+		else if (name == "GlassCluster")
+			GlassCluster(scene, camera, count, seed);
+		else
+			return false;
+
+		return true;
+	}
+
+}
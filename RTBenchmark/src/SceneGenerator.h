@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Camera.h"
+#include "Scene.h"
+
+#include <cstdint>
+#include <string>
+
+// Procedural scenes of any size for the scaling benchmarks. Every generator frees the objects of the scene it
+// replaces, lights the scene with the sky and one emissive material, and points the camera at the result.
+// Objects keep the same density at every count, so larger scenes grow in extent rather than in overlap.
+namespace SceneGenerator {
+
+	// Spheres and boxes alternating, with random sizes and one of a few materials, scattered in a cube
+	void RandomPrimitives(Scene& scene, Camera& camera, uint32_t count, uint32_t seed);
+	// Identical spheres on a square grid above a floor. The renderer has no instancing, every copy is its own object
+	void InstanceGrid(Scene& scene, Camera& camera, uint32_t count);
+	// Overlapping glass spheres packed into a ball, so paths refract through many of them
+	void GlassCluster(Scene& scene, Camera& camera, uint32_t count, uint32_t seed);
+
+	// Generates by name: RandomPrimitives, InstanceGrid or GlassCluster. Returns false for unknown names
+	bool Generate(const std::string& name, Scene& scene, Camera& camera, uint32_t count, uint32_t seed);
+
+}
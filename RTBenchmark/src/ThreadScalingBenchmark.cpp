@@ -0,0 +1,201 @@
+#include "ThreadScalingBenchmark.h"
+
+#include "Json.h"
+#include "SceneFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace Utils {
+	static ThreadScalingBenchmark::TileHistogram BuildHistogram(std::vector<float> tileSeconds, uint32_t binCount)
+	{
+		ThreadScalingBenchmark::TileHistogram histogram;
+		if (tileSeconds.empty())
+			return histogram;
+
+		std::sort(tileSeconds.begin(), tileSeconds.end());
+		histogram.MinSeconds = tileSeconds.front();
+		histogram.MaxSeconds = tileSeconds.back();
+
+		double sum = 0.0;
+		for (float seconds : tileSeconds)
+			sum += seconds;
+		histogram.MeanSeconds = sum / tileSeconds.size();
+
+		auto percentile = [&](double fraction) { return tileSeconds[(size_t)(fraction * (tileSeconds.size() - 1))]; };
+		histogram.P50Seconds = percentile(0.5);
+		histogram.P90Seconds = percentile(0.9);
+		histogram.P99Seconds = percentile(0.99);
+
+		histogram.Counts.assign(std::max(binCount, 1u), 0);
+		double range = histogram.MaxSeconds - histogram.MinSeconds;
+		for (float seconds : tileSeconds)
+		{
+			size_t bin = range > 0.0 ? (size_t)((seconds - histogram.MinSeconds) / range * histogram.Counts.size()) : 0;
+			histogram.Counts[std::min(bin, histogram.Counts.size() - 1)]++;
+		}
+
+		return histogram;
+	}
+}
+
+int ThreadScalingBenchmark::Run(const Options& options, std::ostream& report)
+{
+	Scene scene;
+	Camera camera(45.0f, 0.1f, 100.0f);
+	std::string error;
+	if (!SceneFile::LoadFileOrPreset(options.SceneName, scene, camera, error))
+	{
+		std::cerr << error << "\n";
+		return 1;
+	}
+
+	camera.OnResize(options.Width, options.Height);
+
+	uint32_t hardwareThreads = std::thread::hardware_concurrency();
+	uint32_t maxThreads = options.MaxThreads > 0 ? (uint32_t)options.MaxThreads : std::max(hardwareThreads, 1u);
+
+	std::vector<uint32_t> threadCounts;
+	for (uint32_t threads = 1; threads < maxThreads; threads *= 2)
+		threadCounts.push_back(threads);
+	threadCounts.push_back(maxThreads);
+
+	uint32_t repeats = std::max(options.Repeats, 1u);
+
+	struct Run
+	{
+		double Seconds = 0.0;
+		uint64_t Rays = 0;
+		std::vector<ThreadPool::WorkerStats> WorkerStats;
+		std::vector<float> TileSeconds;
+	};
+
+	std::vector<Result> results;
+	for (uint32_t threads : threadCounts)
+	{
+		// The calling thread always renders, the pool adds the others
+		auto threadPool = std::make_shared<ThreadPool>(threads > 1 ? threads - 1 : ThreadPool::CallerOnly);
+
+		Renderer renderer;
+		renderer.SetThreadPool(threadPool);
+		renderer.SetTileTimingEnabled(true);
+		renderer.GetSettings().LightBounces = options.LightBounces;
+		renderer.GetSettings().Seed = options.Seed;
+		renderer.GetSettings().TileSize = options.TileSize;
+		renderer.GetSettings().Order = options.Order;
+		renderer.OnResize(options.Width, options.Height);
+
+		// Warms up caches and lets every worker touch its tiles once
+		renderer.RenderSamples(scene, camera, options.Samples);
+
+		std::vector<Run> runs(repeats);
+		for (Run& run : runs)
+		{
+			renderer.ResetFrameIndex();
+			renderer.ResetRayCounts();
+			threadPool->ResetWorkerStats();
+
+			auto startTime = std::chrono::steady_clock::now();
+			renderer.RenderSamples(scene, camera, options.Samples);
+			run.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+			run.Rays = renderer.GetRayCounts().TotalRays;
+			run.WorkerStats = threadPool->GetWorkerStats();
+			run.TileSeconds = renderer.GetTileSeconds();
+		}
+
+		std::sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) { return a.Seconds < b.Seconds; });
+		const Run& median = runs[runs.size() / 2];
+
+		Result result;
+		result.ThreadCount = threads;
+		result.Seconds = median.Seconds;
+		result.RaysPerSecond = median.Rays / median.Seconds;
+
+		double busySum = 0.0, busyMax = 0.0;
+		for (const ThreadPool::WorkerStats& stats : median.WorkerStats)
+		{
+			ThreadTime& thread = result.Threads.emplace_back();
+			thread.BusySeconds = stats.BusySeconds;
+			thread.IdleSeconds = std::max(median.Seconds - stats.BusySeconds, 0.0);
+			thread.Tasks = stats.TasksExecuted;
+
+			busySum += stats.BusySeconds;
+			busyMax = std::max(busyMax, stats.BusySeconds);
+		}
+		double busyMean = busySum / std::max<size_t>(result.Threads.size(), 1);
+		result.BusyImbalance = busyMean > 0.0 ? busyMax / busyMean : 0.0;
+
+		result.Tiles = Utils::BuildHistogram(median.TileSeconds, options.HistogramBins);
+
+		const Result& singleThread = results.empty() ? result : results.front();
+		result.Speedup = singleThread.Seconds / result.Seconds;
+		result.ParallelEfficiency = result.Speedup / threads;
+
+		std::cerr << threads << (threads == 1 ? " thread: " : " threads: ") << result.Seconds << " s, speedup " << result.Speedup << ", efficiency "
+			<< result.ParallelEfficiency << ", busy imbalance " << result.BusyImbalance << "\n";
+		results.push_back(result);
+	}
+
+	scene.DeleteObjects();
+
+	return WriteReport(report, options, results) ? 0 : 1;
+}
+
+bool ThreadScalingBenchmark::WriteReport(std::ostream& stream, const Options& options, const std::vector<Result>& results)
+{
+	stream << "{\n";
+	stream << "\t\"Label\": \"" << EscapeJson(options.Label) << "\",\n";
+	stream << "\t\"Scene\": \"" << EscapeJson(options.SceneName) << "\",\n";
+	stream << "\t\"Width\": " << options.Width << ",\n";
+	stream << "\t\"Height\": " << options.Height << ",\n";
+	stream << "\t\"Samples\": " << options.Samples << ",\n";
+	stream << "\t\"LightBounces\": " << options.LightBounces << ",\n";
+	stream << "\t\"Seed\": " << options.Seed << ",\n";
+	stream << "\t\"TileSize\": " << options.TileSize << ",\n";
+	stream << "\t\"TileOrder\": \"" << Renderer::GetTileOrderName(options.Order) << "\",\n";
+	stream << "\t\"HardwareThreads\": " << std::thread::hardware_concurrency() << ",\n";
+	stream << "\t\"Results\": [";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const Result& result = results[i];
+
+		stream << (i == 0 ? "\n" : ",\n") << "\t\t{\n";
+		stream << "\t\t\t\"ThreadCount\": " << result.ThreadCount << ",\n";
+		stream << "\t\t\t\"Seconds\": " << result.Seconds << ",\n";
+		stream << "\t\t\t\"RaysPerSecond\": " << result.RaysPerSecond << ",\n";
+		stream << "\t\t\t\"Speedup\": " << result.Speedup << ",\n";
+		stream << "\t\t\t\"ParallelEfficiency\": " << result.ParallelEfficiency << ",\n";
+		stream << "\t\t\t\"BusyImbalance\": " << result.BusyImbalance << ",\n";
+
+		stream << "\t\t\t\"Threads\": [";
+		for (size_t thread = 0; thread < result.Threads.size(); thread++)
+		{
+			const ThreadTime& time = result.Threads[thread];
+			stream << (thread == 0 ? "\n" : ",\n") << "\t\t\t\t{ \"BusySeconds\": " << time.BusySeconds << ", \"IdleSeconds\": "
+				<< time.IdleSeconds << ", \"Tasks\": " << time.Tasks << " }";
+		}
+		stream << (result.Threads.empty() ? "],\n" : "\n\t\t\t],\n");
+
+		const TileHistogram& tiles = result.Tiles;
+		stream << "\t\t\t\"TileSeconds\": {\n";
+		stream << "\t\t\t\t\"Min\": " << tiles.MinSeconds << ",\n";
+		stream << "\t\t\t\t\"Max\": " << tiles.MaxSeconds << ",\n";
+		stream << "\t\t\t\t\"Mean\": " << tiles.MeanSeconds << ",\n";
+		stream << "\t\t\t\t\"P50\": " << tiles.P50Seconds << ",\n";
+		stream << "\t\t\t\t\"P90\": " << tiles.P90Seconds << ",\n";
+		stream << "\t\t\t\t\"P99\": " << tiles.P99Seconds << ",\n";
+		stream << "\t\t\t\t\"Histogram\": [";
+		for (size_t bin = 0; bin < tiles.Counts.size(); bin++)
+			stream << (bin == 0 ? "" : ", ") << tiles.Counts[bin];
+		stream << "]\n";
+		stream << "\t\t\t}\n";
+		stream << "\t\t}";
+	}
+
+	stream << (results.empty() ? "]\n" : "\n\t]\n");
+	stream << "}\n";
+	return (bool)stream;
+}
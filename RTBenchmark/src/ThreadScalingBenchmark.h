@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Renderer.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Renders the same frame on 1, 2, 4, ... threads and reports speedup, parallel efficiency and how busy every thread was,
+// together with a histogram of the time the tiles took. Thread counts include the thread calling the render, which
+// helps out on top of the pool workers and is listed after them. A single thread renders on the caller alone.
+class ThreadScalingBenchmark
+{
+public:
+	struct Options
+	{
+		std::string SceneName = "ColorRoom";
+		uint32_t Width = 640, Height = 360;
+		uint32_t Samples = 4;
+		int LightBounces = 5;
+		uint32_t Seed = 1;
+		int TileSize = 16;
+		Renderer::TileOrder Order = Renderer::TileOrder::Hilbert;
+		// 0 goes up to the hardware thread count
+		int MaxThreads = 0;
+		uint32_t Repeats = 3;
+		uint32_t HistogramBins = 12;
+		std::string Label;
+	};
+
+	struct ThreadTime
+	{
+		double BusySeconds = 0.0, IdleSeconds = 0.0;
+		uint64_t Tasks = 0;
+	};
+
+	struct TileHistogram
+	{
+		double MinSeconds = 0.0, MaxSeconds = 0.0, MeanSeconds = 0.0;
+		double P50Seconds = 0.0, P90Seconds = 0.0, P99Seconds = 0.0;
+		// Equal width bins from MinSeconds to MaxSeconds
+		std::vector<uint32_t> Counts;
+	};
+
+	struct Result
+	{
+		// Pool workers plus the calling thread
+		uint32_t ThreadCount = 0;
+		double Seconds = 0.0;
+		double RaysPerSecond = 0.0;
+		// Relative to the single thread run
+		double Speedup = 0.0, ParallelEfficiency = 0.0;
+		// Slowest thread's busy time over the mean of all threads, 1 is perfectly balanced
+		double BusyImbalance = 0.0;
+
+		std::vector<ThreadTime> Threads;
+		TileHistogram Tiles;
+	};
+public:
+	// Writes the report to the stream once every case ran, returns the process exit code
+	static int Run(const Options& options, std::ostream& report);
+
+	static bool WriteReport(std::ostream& stream, const Options& options, const std::vector<Result>& results);
+};
@@ -0,0 +1,119 @@
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace Utils {
+	static glm::vec3 Slerp(const glm::vec3& from, const glm::vec3& to, float t)
+	{
+		float cosAngle = glm::clamp(glm::dot(from, to), -1.0f, 1.0f);
+
+		// Nearly parallel directions, the great circle is not defined well enough
+		if (cosAngle > 0.9995f)
+			return glm::normalize(glm::mix(from, to, t));
+
+		// Nearly opposite directions, sinAngle goes to 0. Turns from towards the part of to perpendicular to it instead,
+		// and for exactly opposite ones, where every great circle is as short, through the horizontal one unless the
+		// camera looks straight up or down
+		if (cosAngle < -0.9995f)
+		{
+			glm::vec3 side = to - cosAngle * from;
+			if (glm::dot(side, side) < 1.0e-8f)
+				side = glm::cross(glm::vec3(0.0f, 1.0f, 0.0f), from);
+			if (glm::dot(side, side) < 1.0e-8f)
+				side = glm::cross(glm::vec3(1.0f, 0.0f, 0.0f), from);
+
+			float turn = t * acosf(cosAngle);
+			return glm::normalize(cosf(turn) * from + sinf(turn) * glm::normalize(side));
+		}
+
+		float angle = acosf(cosAngle);
+		float sinAngle = sinf(angle);
+		return (sinf((1.0f - t) * angle) * from + sinf(t * angle) * to) / sinAngle;
+	}
+}
+
+bool CameraPath::LoadFromFile(const std::string& path, std::string& error)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		error = "could not open " + path;
+		return false;
+	}
+
+	m_Keyframes.clear();
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+
+		size_t first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos || line[first] == '#')
+			continue;
+
+		std::istringstream stream(line);
+		Keyframe keyframe;
+		if (!(stream >> keyframe.Frame
+			>> keyframe.Position.x >> keyframe.Position.y >> keyframe.Position.z
+			>> keyframe.Direction.x >> keyframe.Direction.y >> keyframe.Direction.z)
+			|| glm::dot(keyframe.Direction, keyframe.Direction) == 0.0f)
+		{
+			error = path + ":" + std::to_string(lineNumber) + ": expected frame px py pz dx dy dz";
+			return false;
+		}
+
+		AddKeyframe(keyframe);
+	}
+
+	if (m_Keyframes.empty())
+	{
+		error = path + " holds no keyframes";
+		return false;
+	}
+
+	return true;
+}
+
+void CameraPath::AddKeyframe(const Keyframe& keyframe)
+{
+	Keyframe normalized = keyframe;
+	normalized.Direction = glm::normalize(keyframe.Direction);
+
+	auto it = std::upper_bound(m_Keyframes.begin(), m_Keyframes.end(), normalized.Frame,
+		[](int frame, const Keyframe& other) { return frame < other.Frame; });
+	m_Keyframes.insert(it, normalized);
+}
+
+void CameraPath::Evaluate(float frame, glm::vec3& position, glm::vec3& direction) const
+{
+	if (m_Keyframes.empty())
+		return;
+
+	if (frame <= (float)m_Keyframes.front().Frame)
+	{
+		position = m_Keyframes.front().Position;
+		direction = m_Keyframes.front().Direction;
+		return;
+	}
+
+	for (size_t i = 1; i < m_Keyframes.size(); i++)
+	{
+		const Keyframe& from = m_Keyframes[i - 1];
+		const Keyframe& to = m_Keyframes[i];
+		if (frame > (float)to.Frame || to.Frame == from.Frame)
+			continue;
+
+		float t = (frame - (float)from.Frame) / (float)(to.Frame - from.Frame);
+		position = glm::mix(from.Position, to.Position, t);
+		direction = Utils::Slerp(from.Direction, to.Direction, t);
+		return;
+	}
+
+	position = m_Keyframes.back().Position;
+	direction = m_Keyframes.back().Direction;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+// Keyframed camera animation. Positions are interpolated linearly, forward directions along the great circle between
+// neighbouring keyframes, so the camera turns at a constant rate.
+class CameraPath
+{
+public:
+	struct Keyframe
+	{
+		int Frame = 0;
+		glm::vec3 Position{ 0.0f };
+		glm::vec3 Direction{ 0.0f, 0.0f, -1.0f };
+	};
+public:
+	// One keyframe per line: frame px py pz dx dy dz, lines starting with # are ignored
+	bool LoadFromFile(const std::string& path, std::string& error);
+	void AddKeyframe(const Keyframe& keyframe);
+
+	bool IsEmpty() const { return m_Keyframes.empty(); }
+	int GetFirstFrame() const { return m_Keyframes.empty() ? 0 : m_Keyframes.front().Frame; }
+	int GetLastFrame() const { return m_Keyframes.empty() ? 0 : m_Keyframes.back().Frame; }
+
+	// Frames outside the keyframed range hold the first or last keyframe
+	void Evaluate(float frame, glm::vec3& position, glm::vec3& direction) const;
+private:
+	std::vector<Keyframe> m_Keyframes;
+};
@@ -0,0 +1,182 @@
+#include "ChildProcess.h"
+
+#if defined(_WIN32)
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <Windows.h>
+#else
+	#include <signal.h>
+	#include <spawn.h>
+	#include <sys/wait.h>
+	#include <unistd.h>
+
+	extern char** environ;
+#endif
+
+namespace Utils {
+#if defined(_WIN32)
+	// Quotes an argument so CommandLineToArgvW splits it back the same way
+	static std::string QuoteArgument(const std::string& argument)
+	{
+		if (!argument.empty() && argument.find_first_of(" \t\"") == std::string::npos)
+			return argument;
+
+		std::string quoted = "\"";
+		size_t backslashes = 0;
+		for (char c : argument)
+		{
+			if (c == '\\')
+			{
+				backslashes++;
+				continue;
+			}
+
+			if (c == '"')
+				quoted.append(backslashes * 2 + 1, '\\');
+			else
+				quoted.append(backslashes, '\\');
+
+			quoted.push_back(c);
+			backslashes = 0;
+		}
+		quoted.append(backslashes * 2, '\\');
+		quoted.push_back('"');
+		return quoted;
+	}
+#endif
+}
+
+ChildProcess::~ChildProcess()
+{
+	if (m_Running)
+	{
+		Kill();
+		Wait();
+	}
+}
+
+bool ChildProcess::Start(const std::vector<std::string>& arguments)
+{
+	if (m_Running)
+		return false;
+
+	std::string executable = GetExecutablePath();
+	if (executable.empty())
+		return false;
+
+#if defined(_WIN32)
+	std::string commandLine = Utils::QuoteArgument(executable);
+	for (const std::string& argument : arguments)
+		commandLine += " " + Utils::QuoteArgument(argument);
+
+	STARTUPINFOA startupInfo = {};
+	startupInfo.cb = sizeof(startupInfo);
+	PROCESS_INFORMATION processInfo = {};
+	if (!CreateProcessA(executable.c_str(), commandLine.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startupInfo, &processInfo))
+		return false;
+
+	CloseHandle(processInfo.hThread);
+	m_Process = processInfo.hProcess;
+	m_Id = (uint32_t)processInfo.dwProcessId;
+#else
+	std::vector<char*> argv;
+	argv.push_back(executable.data());
+	std::vector<std::string> argumentCopies = arguments;
+	for (std::string& argument : argumentCopies)
+		argv.push_back(argument.data());
+	argv.push_back(nullptr);
+
+	pid_t pid;
+	if (posix_spawn(&pid, executable.c_str(), nullptr, nullptr, argv.data(), environ) != 0)
+		return false;
+
+	m_Pid = pid;
+	m_Id = (uint32_t)pid;
+#endif
+
+	m_Running = true;
+	return true;
+}
+
+int ChildProcess::Wait()
+{
+	if (!m_Running)
+		return -1;
+
+	m_Running = false;
+
+#if defined(_WIN32)
+	WaitForSingleObject((HANDLE)m_Process, INFINITE);
+	DWORD exitCode = 0;
+	GetExitCodeProcess((HANDLE)m_Process, &exitCode);
+	CloseHandle((HANDLE)m_Process);
+	m_Process = nullptr;
+	return (int)exitCode;
+#else
+	int status = 0;
+	waitpid(m_Pid, &status, 0);
+	m_Pid = -1;
+	return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+}
+
+bool ChildProcess::HasExited()
+{
+	if (!m_Running)
+		return true;
+
+#if defined(_WIN32)
+	if (WaitForSingleObject((HANDLE)m_Process, 0) != WAIT_OBJECT_0)
+		return false;
+
+	CloseHandle((HANDLE)m_Process);
+	m_Process = nullptr;
+#else
+	int status = 0;
+	if (waitpid(m_Pid, &status, WNOHANG) == 0)
+		return false;
+
+	m_Pid = -1;
+#endif
+
+	m_Running = false;
+	return true;
+}
+
+void ChildProcess::Kill()
+{
+	if (!m_Running)
+		return;
+
+#if defined(_WIN32)
+	TerminateProcess((HANDLE)m_Process, 1);
+#else
+	kill(m_Pid, SIGKILL);
+#endif
+}
+
+std::string ChildProcess::GetExecutablePath()
+{
+#if defined(_WIN32)
+	char path[MAX_PATH];
+	DWORD length = GetModuleFileNameA(nullptr, path, MAX_PATH);
+	return std::string(path, length);
+#else
+	char path[4096];
+	ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+	if (length <= 0)
+		return std::string();
+
+	return std::string(path, length);
+#endif
+}
+
+uint32_t ChildProcess::GetCurrentId()
+{
+#if defined(_WIN32)
+	return (uint32_t)GetCurrentProcessId();
+#else
+	return (uint32_t)getpid();
+#endif
+}
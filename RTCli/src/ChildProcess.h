@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Starts a copy of the running executable with other arguments, used to launch local render workers
+class ChildProcess
+{
+public:
+	ChildProcess() = default;
+	~ChildProcess();
+
+	ChildProcess(const ChildProcess&) = delete;
+	ChildProcess& operator=(const ChildProcess&) = delete;
+
+	bool Start(const std::vector<std::string>& arguments);
+	// Blocks until the process exits, returns its exit code or -1 if it never ran
+	int Wait();
+	// Returns true once the process exited, without blocking. The exit code is collected, Wait returns -1 afterwards
+	bool HasExited();
+	void Kill();
+
+	bool IsRunning() const { return m_Running; }
+	// Operating system process id, kept after the process exited
+	uint32_t GetId() const { return m_Id; }
+
+	static std::string GetExecutablePath();
+	static uint32_t GetCurrentId();
+private:
+#if defined(_WIN32)
+	void* m_Process = nullptr;
+#else
+	int m_Pid = -1;
+#endif
+	uint32_t m_Id = 0;
+	bool m_Running = false;
+};
@@ -0,0 +1,334 @@
+#include "FrameFarm.h"
+#include "HeadlessRender.h"
+#include "JobQueue.h"
+#include "RenderCoordinator.h"
+#include "RenderWorker.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace Utils {
+	static bool ParseVec3(const char* text, glm::vec3& value)
+	{
+		return sscanf(text, "%f,%f,%f", &value.x, &value.y, &value.z) == 3;
+	}
+
+	static bool ParseHostPort(const std::string& text, std::string& host, uint16_t& port)
+	{
+		size_t separator = text.rfind(':');
+		if (separator == std::string::npos)
+			return false;
+
+		host = text.substr(0, separator);
+		port = (uint16_t)atoi(text.c_str() + separator + 1);
+		return !host.empty() && port != 0;
+	}
+
+	static void PrintUsage()
+	{
+		std::cout <<
+			"Usage:\n"
+			"  RTCli render [options]\n"
+			"    --scene <name|file.rtscene>    TwoSpheres, RefractionTest, ColorRoom, Empty or a scene file\n"
+			"    --width <pixels> --height <pixels>\n"
+			"    --samples <count>              Samples per pixel\n"
+			"    --bounces <count>\n"
+			"    --camera-position <x,y,z> --camera-direction <x,y,z>\n"
+			"    --threads <count>              0 uses every hardware thread\n"
+			"    --output <file.png>\n"
+			"  RTCli queue --jobs <file> [options]\n"
+			"    --jobs <file>                  One job per line: scene=<name|file> width= height= samples= bounces=\n"
+			"                                   camera-position=x,y,z camera-direction=x,y,z output=<file.png>\n"
+			"    --summary <file.json>          Per job timings, summary.json by default\n"
+			"    --threads <count>              Threads of the pool all jobs share, 0 uses every hardware thread\n"
+			"    --concurrent <count>           Jobs rendered at the same time\n"
+			"  RTCli coordinator [options]\n"
+			"    --scene, --width, --height, --samples, --bounces, --camera-position, --camera-direction as for render\n"
+			"    --port <port>                  0 picks a free port\n"
+			"    --tile-size <pixels>\n"
+			"    --tile-samples <count>         Samples per tile request, 16 by default\n"
+			"    --local-workers <count>        Worker processes started on this machine\n"
+			"    --timeout <seconds>            Reassign the work of workers silent for this long, they send heartbeats\n"
+			"    --output <file.png>\n"
+			"  RTCli animate --keyframes <file> [options]\n"
+			"    --scene, --width, --height, --samples, --bounces as for render\n"
+			"    --keyframes <file>             One keyframe per line: frame px py pz dx dy dz\n"
+			"    --first-frame <n> --last-frame <n>\n"
+			"    --output <pattern>             # is replaced by the frame number, frames/frame_####.png\n"
+			"    --workers <count>              Worker processes rendering whole frames\n"
+			"    --timeout <seconds>            Replace workers silent for this long, 60 by default\n"
+			"  RTCli worker --connect <host:port> [--threads <count>]\n";
+	}
+}
+
+static int RunRender(int argc, char** argv)
+{
+	HeadlessRender::Options options;
+
+	for (int i = 0; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value)
+		{
+			std::cerr << "Missing value for " << argument << "\n";
+			return 1;
+		}
+		i++;
+
+		if (strcmp(argument, "--scene") == 0)
+			options.SceneName = value;
+		else if (strcmp(argument, "--width") == 0)
+			options.Width = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--height") == 0)
+			options.Height = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--samples") == 0)
+			options.Samples = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--bounces") == 0)
+			options.LightBounces = atoi(value);
+		else if (strcmp(argument, "--threads") == 0)
+			options.ThreadCount = atoi(value);
+		else if (strcmp(argument, "--output") == 0)
+			options.OutputPath = value;
+		else if (strcmp(argument, "--camera-position") == 0)
+			options.HasCameraPosition = Utils::ParseVec3(value, options.CameraPosition);
+		else if (strcmp(argument, "--camera-direction") == 0)
+			options.HasCameraDirection = Utils::ParseVec3(value, options.CameraDirection);
+		else
+		{
+			std::cerr << "Unknown option " << argument << "\n";
+			return 1;
+		}
+	}
+
+	if (options.Width == 0 || options.Height == 0 || options.Samples == 0)
+	{
+		std::cerr << "Width, height and samples must be positive\n";
+		return 1;
+	}
+
+	return HeadlessRender::Run(options);
+}
+
+static int RunQueue(int argc, char** argv)
+{
+	JobQueue::Options options;
+
+	for (int i = 0; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value)
+		{
+			std::cerr << "Missing value for " << argument << "\n";
+			return 1;
+		}
+		i++;
+
+		if (strcmp(argument, "--jobs") == 0)
+			options.JobsPath = value;
+		else if (strcmp(argument, "--summary") == 0)
+			options.SummaryPath = value;
+		else if (strcmp(argument, "--threads") == 0)
+			options.ThreadCount = atoi(value);
+		else if (strcmp(argument, "--concurrent") == 0)
+			options.ConcurrentJobs = atoi(value);
+		else
+		{
+			std::cerr << "Unknown option " << argument << "\n";
+			return 1;
+		}
+	}
+
+	if (options.JobsPath.empty())
+	{
+		std::cerr << "queue needs --jobs <file>\n";
+		return 1;
+	}
+
+	return JobQueue::Run(options);
+}
+
+static int RunCoordinator(int argc, char** argv)
+{
+	RenderCoordinator::Options options;
+
+	for (int i = 0; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value)
+		{
+			std::cerr << "Missing value for " << argument << "\n";
+			return 1;
+		}
+		i++;
+
+		if (strcmp(argument, "--scene") == 0)
+			options.SceneName = value;
+		else if (strcmp(argument, "--width") == 0)
+			options.Width = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--height") == 0)
+			options.Height = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--samples") == 0)
+			options.Samples = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--bounces") == 0)
+			options.LightBounces = atoi(value);
+		else if (strcmp(argument, "--port") == 0)
+			options.Port = (uint16_t)atoi(value);
+		else if (strcmp(argument, "--tile-size") == 0)
+			options.TileSize = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--tile-samples") == 0)
+			options.SamplesPerTile = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--local-workers") == 0)
+			options.LocalWorkers = atoi(value);
+		else if (strcmp(argument, "--timeout") == 0)
+			options.TimeoutSeconds = (float)atof(value);
+		else if (strcmp(argument, "--output") == 0)
+			options.OutputPath = value;
+		else if (strcmp(argument, "--camera-position") == 0)
+			options.HasCameraPosition = Utils::ParseVec3(value, options.CameraPosition);
+		else if (strcmp(argument, "--camera-direction") == 0)
+			options.HasCameraDirection = Utils::ParseVec3(value, options.CameraDirection);
+		else
+		{
+			std::cerr << "Unknown option " << argument << "\n";
+			return 1;
+		}
+	}
+
+	if (options.Width == 0 || options.Height == 0 || options.Samples == 0)
+	{
+		std::cerr << "Width, height and samples must be positive\n";
+		return 1;
+	}
+
+	return RenderCoordinator::Run(options);
+}
+
+static int RunAnimation(int argc, char** argv)
+{
+	FrameFarm::Options options;
+
+	for (int i = 0; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value)
+		{
+			std::cerr << "Missing value for " << argument << "\n";
+			return 1;
+		}
+		i++;
+
+		if (strcmp(argument, "--scene") == 0)
+			options.SceneName = value;
+		else if (strcmp(argument, "--keyframes") == 0)
+			options.KeyframesPath = value;
+		else if (strcmp(argument, "--width") == 0)
+			options.Width = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--height") == 0)
+			options.Height = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--samples") == 0)
+			options.Samples = (uint32_t)atoi(value);
+		else if (strcmp(argument, "--bounces") == 0)
+			options.LightBounces = atoi(value);
+		else if (strcmp(argument, "--first-frame") == 0)
+		{
+			options.FirstFrame = atoi(value);
+			options.HasFirstFrame = true;
+		}
+		else if (strcmp(argument, "--last-frame") == 0)
+		{
+			options.LastFrame = atoi(value);
+			options.HasLastFrame = true;
+		}
+		else if (strcmp(argument, "--output") == 0)
+			options.OutputPattern = value;
+		else if (strcmp(argument, "--workers") == 0)
+			options.Workers = atoi(value);
+		else if (strcmp(argument, "--timeout") == 0)
+			options.TimeoutSeconds = (float)atof(value);
+		else
+		{
+			std::cerr << "Unknown option " << argument << "\n";
+			return 1;
+		}
+	}
+
+	if (options.KeyframesPath.empty())
+	{
+		std::cerr << "animate needs --keyframes <file>\n";
+		return 1;
+	}
+
+	if (options.Width == 0 || options.Height == 0 || options.Samples == 0)
+	{
+		std::cerr << "Width, height and samples must be positive\n";
+		return 1;
+	}
+
+	return FrameFarm::Run(options);
+}
+
+static int RunWorker(int argc, char** argv)
+{
+	RenderWorker::Options options;
+	bool hasAddress = false;
+
+	for (int i = 0; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value)
+		{
+			std::cerr << "Missing value for " << argument << "\n";
+			return 1;
+		}
+		i++;
+
+		if (strcmp(argument, "--connect") == 0)
+			hasAddress = Utils::ParseHostPort(value, options.Host, options.Port);
+		else if (strcmp(argument, "--threads") == 0)
+			options.ThreadCount = atoi(value);
+		else
+		{
+			std::cerr << "Unknown option " << argument << "\n";
+			return 1;
+		}
+	}
+
+	if (!hasAddress)
+	{
+		std::cerr << "Worker needs --connect <host:port>\n";
+		return 1;
+	}
+
+	return RenderWorker::Run(options);
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		Utils::PrintUsage();
+		return 1;
+	}
+
+	if (strcmp(argv[1], "render") == 0)
+		return RunRender(argc - 2, argv + 2);
+	if (strcmp(argv[1], "queue") == 0)
+		return RunQueue(argc - 2, argv + 2);
+	if (strcmp(argv[1], "coordinator") == 0)
+		return RunCoordinator(argc - 2, argv + 2);
+	if (strcmp(argv[1], "animate") == 0)
+		return RunAnimation(argc - 2, argv + 2);
+	if (strcmp(argv[1], "worker") == 0)
+		return RunWorker(argc - 2, argv + 2);
+
+	Utils::PrintUsage();
+	return 1;
+}
@@ -0,0 +1,281 @@
+#include "FrameFarm.h"
+
+#include "SceneFile.h"
+#include "SceneSerializer.h"
+
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+int FrameFarm::Run(const Options& options)
+{
+	FrameFarm farm(options);
+	return farm.Execute();
+}
+
+std::string FrameFarm::FormatFramePath(const std::string& pattern, int frame)
+{
+	size_t first = pattern.rfind('#');
+	if (first == std::string::npos)
+	{
+		// No placeholder, number the frames in front of the extension
+		std::filesystem::path path(pattern);
+		return (path.parent_path() / (path.stem().string() + "_" + std::to_string(frame) + path.extension().string())).string();
+	}
+
+	size_t last = first;
+	while (first > 0 && pattern[first - 1] == '#')
+		first--;
+
+	std::string number = std::to_string(frame);
+	size_t width = last - first + 1;
+	if (number.size() < width)
+		number.insert(0, width - number.size(), '0');
+
+	return pattern.substr(0, first) + number + pattern.substr(last + 1);
+}
+
+FrameFarm::FrameFarm(const Options& options)
+	: m_Options(options)
+{
+}
+
+int FrameFarm::Execute()
+{
+	std::string error;
+	if (!m_Path.LoadFromFile(m_Options.KeyframesPath, error))
+	{
+		std::cerr << error << "\n";
+		return 1;
+	}
+
+	// The keyframes place the camera, one stored in a scene file is ignored
+	Scene scene;
+	Camera sceneCamera(45.0f, 0.1f, 100.0f);
+	if (!SceneFile::LoadFileOrPreset(m_Options.SceneName, scene, sceneCamera, error))
+	{
+		std::cerr << error << "\n";
+		return 1;
+	}
+
+	Renderer::Settings settings;
+	settings.LightBounces = m_Options.LightBounces;
+
+	// The camera of the job is replaced by the one of every frame
+	BinaryWriter job;
+	job.Write(m_Options.Width);
+	job.Write(m_Options.Height);
+	SceneSerializer::WriteSettings(job, settings);
+	SceneSerializer::WriteCamera(job, Camera(45.0f, 0.1f, 100.0f));
+	SceneSerializer::WriteScene(job, scene);
+	m_JobPayload = std::move(job.GetBuffer());
+	scene.DeleteObjects();
+
+	int firstFrame = m_Options.HasFirstFrame ? m_Options.FirstFrame : m_Path.GetFirstFrame();
+	int lastFrame = m_Options.HasLastFrame ? m_Options.LastFrame : m_Path.GetLastFrame();
+
+	uint32_t skippedFrames = 0;
+	for (int frame = firstFrame; frame <= lastFrame; frame++)
+	{
+		if (std::filesystem::exists(FormatFramePath(m_Options.OutputPattern, frame)))
+		{
+			skippedFrames++;
+			continue;
+		}
+		m_PendingFrames.push_back(frame);
+	}
+
+	m_FrameCount = (uint32_t)m_PendingFrames.size();
+	std::cout << "Frames " << firstFrame << " to " << lastFrame << ": " << m_FrameCount << " to render, " << skippedFrames << " already done\n";
+	if (m_FrameCount == 0)
+		return 0;
+
+	std::filesystem::path outputDirectory = std::filesystem::path(FormatFramePath(m_Options.OutputPattern, firstFrame)).parent_path();
+	if (!outputDirectory.empty())
+		std::filesystem::create_directories(outputDirectory);
+
+	Socket listener = Socket::Listen(0);
+	if (!listener.IsValid())
+	{
+		std::cerr << "Could not listen for workers\n";
+		return 1;
+	}
+
+	uint16_t port = listener.GetLocalPort();
+	int workerCount = glm::clamp(m_Options.Workers, 1, (int)m_FrameCount);
+	uint32_t hardwareThreads = glm::max(std::thread::hardware_concurrency(), 1u);
+	uint32_t threadsPerWorker = glm::max(hardwareThreads / (uint32_t)workerCount, 1u);
+
+	m_Workers = std::make_unique<LocalWorkers>(port, threadsPerWorker);
+	m_Workers->Start((uint32_t)workerCount);
+
+	auto startTime = std::chrono::steady_clock::now();
+	auto timeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(m_Options.TimeoutSeconds));
+
+	std::vector<Socket*> sockets;
+	std::vector<bool> readable;
+	while (m_CompletedFrames + m_FailedFrames < m_FrameCount)
+	{
+		sockets.clear();
+		sockets.push_back(&listener);
+		for (auto& connection : m_Connections)
+			sockets.push_back(&connection->Link);
+
+		if (Socket::WaitReadable(sockets, 100, readable))
+		{
+			for (size_t i = m_Connections.size(); i-- > 0;)
+			{
+				if (!readable[i + 1])
+					continue;
+
+				Connection& connection = *m_Connections[i];
+				TileProtocol::Message message;
+				if (!TileProtocol::Receive(connection.Link, message))
+					DropConnection(i, "disconnected");
+				else if (!HandleMessage(connection, message))
+					DropConnection(i, "sent an invalid message");
+			}
+
+			if (readable[0])
+			{
+				auto connection = std::make_unique<Connection>();
+				connection->Link = listener.Accept();
+				connection->LastActivity = std::chrono::steady_clock::now();
+				if (connection->Link.IsValid())
+					m_Connections.push_back(std::move(connection));
+			}
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		for (size_t i = m_Connections.size(); i-- > 0;)
+		{
+			Connection& connection = *m_Connections[i];
+			if (connection.Frame >= 0 && now - connection.LastActivity > timeout)
+				DropConnection(i, "timed out");
+		}
+
+		for (size_t i = m_Connections.size(); i-- > 0;)
+		{
+			if (!Dispatch(*m_Connections[i]))
+				DropConnection(i, "disconnected");
+		}
+
+		// Only local workers serve a farm, nobody else is going to pick up the remaining frames
+		if (!m_Workers->AnyRunning() && m_Connections.empty())
+		{
+			std::cerr << "All workers exited\n";
+			break;
+		}
+	}
+
+	float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+
+	for (auto& connection : m_Connections)
+		TileProtocol::Send(connection->Link, TileProtocol::MessageType::Shutdown, nullptr, 0);
+	m_Connections.clear();
+
+	m_Workers->WaitAll();
+
+	std::cout << "Rendered " << m_CompletedFrames << " frames in " << seconds << " s";
+	if (m_CompletedFrames > 0)
+		std::cout << " (" << seconds / m_CompletedFrames << " s per frame)";
+	std::cout << "\n";
+
+	return m_CompletedFrames == m_FrameCount ? 0 : 1;
+}
+
+bool FrameFarm::HandleMessage(Connection& connection, const TileProtocol::Message& message)
+{
+	BinaryReader reader(message.Payload.data(), message.Payload.size());
+	connection.LastActivity = std::chrono::steady_clock::now();
+
+	switch (message.Type)
+	{
+		case TileProtocol::MessageType::Hello:
+		{
+			TileProtocol::Hello hello;
+			if (connection.Ready || !reader.Read(hello) || hello.ProtocolVersion != TileProtocol::Version)
+				return false;
+
+			connection.ProcessId = hello.ProcessId;
+			connection.Ready = true;
+			return TileProtocol::Send(connection.Link, TileProtocol::MessageType::Job, m_JobPayload.data(), (uint32_t)m_JobPayload.size());
+		}
+		case TileProtocol::MessageType::FrameResult:
+		{
+			TileProtocol::FrameResult result;
+			if (!reader.Read(result) || (int)result.FrameNumber != connection.Frame)
+				return false;
+
+			std::string path = FormatFramePath(m_Options.OutputPattern, connection.Frame);
+			connection.Frame = -1;
+
+			if (!result.Saved)
+			{
+				std::cerr << "Could not write " << path << "\n";
+				m_FailedFrames++;
+				return true;
+			}
+
+			m_CompletedFrames++;
+			std::cout << "[" << m_CompletedFrames << "/" << m_FrameCount << "] " << path << "\n";
+			return true;
+		}
+		case TileProtocol::MessageType::Heartbeat:
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool FrameFarm::Dispatch(Connection& connection)
+{
+	if (!connection.Ready || connection.Frame >= 0 || m_PendingFrames.empty())
+		return true;
+
+	int frame = m_PendingFrames.front();
+	m_PendingFrames.pop_front();
+
+	Camera camera(45.0f, 0.1f, 100.0f);
+	glm::vec3 position = camera.GetPosition(), direction = camera.GetDirection();
+	m_Path.Evaluate((float)frame, position, direction);
+	camera.SetPosition(position);
+	camera.SetDirection(direction);
+
+	// Workers may run in another directory
+	std::string path = std::filesystem::absolute(FormatFramePath(m_Options.OutputPattern, frame)).string();
+
+	BinaryWriter request;
+	request.Write((uint32_t)frame);
+	request.Write(m_Options.Samples);
+	request.Write((uint32_t)path.size());
+	request.WriteBytes(path.data(), path.size());
+	SceneSerializer::WriteCamera(request, camera);
+
+	connection.Frame = frame;
+	connection.LastActivity = std::chrono::steady_clock::now();
+	return TileProtocol::Send(connection.Link, TileProtocol::MessageType::FrameRequest, request);
+}
+
+void FrameFarm::DropConnection(size_t index, const char* reason)
+{
+	Connection& connection = *m_Connections[index];
+	if (connection.Frame >= 0)
+	{
+		std::cout << "Worker " << reason << ", frame " << connection.Frame << " is rendered again\n";
+		m_PendingFrames.push_front(connection.Frame);
+	}
+
+	// Left running, the worker would finish the frame next to the one it was handed to
+	if (connection.ProcessId != 0 && m_Workers->Replace(connection.ProcessId))
+	{
+		std::cout << "Replaced worker " << connection.ProcessId << "\n";
+		if (connection.Frame >= 0)
+		{
+			std::error_code error;
+			std::filesystem::remove(FormatFramePath(m_Options.OutputPattern, connection.Frame) + ".part." + std::to_string(connection.ProcessId), error);
+		}
+	}
+
+	m_Connections.erase(m_Connections.begin() + index);
+}
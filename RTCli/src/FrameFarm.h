@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CameraPath.h"
+#include "LocalWorkers.h"
+#include "Socket.h"
+#include "TileProtocol.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Renders a keyframed camera animation by handing out whole frames to local worker processes.
+// Workers load the scene once and keep it for every frame they render, only the camera travels with a frame.
+// Frames whose image already exists are skipped, so an interrupted sequence picks up where it stopped.
+class FrameFarm
+{
+public:
+	struct Options
+	{
+		std::string SceneName = "TwoSpheres";
+		std::string KeyframesPath;
+		uint32_t Width = 1280, Height = 720;
+		uint32_t Samples = 64;
+		int LightBounces = 5;
+
+		// Defaults to the keyframed range
+		bool HasFirstFrame = false, HasLastFrame = false;
+		int FirstFrame = 0, LastFrame = 0;
+
+		// A run of # is replaced by the zero padded frame number, frame_####.png becomes frame_0001.png
+		std::string OutputPattern = "frame_####.png";
+
+		int Workers = 2;
+		// A worker that sends nothing for this long is killed and replaced, workers send heartbeats while they render
+		float TimeoutSeconds = 60.0f;
+	};
+public:
+	// Returns the process exit code
+	static int Run(const Options& options);
+
+	static std::string FormatFramePath(const std::string& pattern, int frame);
+private:
+	struct Connection
+	{
+		Socket Link;
+		bool Ready = false;
+		uint32_t ProcessId = 0;
+		int Frame = -1;
+		std::chrono::steady_clock::time_point LastActivity;
+	};
+
+	explicit FrameFarm(const Options& options);
+
+	int Execute();
+	bool HandleMessage(Connection& connection, const TileProtocol::Message& message);
+	bool Dispatch(Connection& connection);
+	void DropConnection(size_t index, const char* reason);
+private:
+	Options m_Options;
+	CameraPath m_Path;
+
+	std::vector<uint8_t> m_JobPayload;
+
+	std::deque<int> m_PendingFrames;
+	uint32_t m_FrameCount = 0;
+	uint32_t m_CompletedFrames = 0;
+	uint32_t m_FailedFrames = 0;
+
+	std::vector<std::unique_ptr<Connection>> m_Connections;
+	std::unique_ptr<LocalWorkers> m_Workers;
+};
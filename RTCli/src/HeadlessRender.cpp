@@ -0,0 +1,47 @@
+#include "HeadlessRender.h"
+
+#include "ImageIO.h"
+#include "Renderer.h"
+#include "SceneFile.h"
+
+#include <chrono>
+#include <iostream>
+
+int HeadlessRender::Run(const Options& options)
+{
+	Scene scene;
+	Camera camera(45.0f, 0.1f, 100.0f);
+	std::string error;
+	if (!SceneFile::LoadFileOrPreset(options.SceneName, scene, camera, error))
+	{
+		std::cerr << error << "\n";
+		return 1;
+	}
+
+	camera.OnResize(options.Width, options.Height);
+	camera.SetView(options.HasCameraPosition ? options.CameraPosition : camera.GetPosition(),
+		options.HasCameraDirection ? options.CameraDirection : camera.GetDirection());
+
+	Renderer renderer;
+	renderer.GetSettings().LightBounces = options.LightBounces;
+	renderer.GetSettings().ThreadCount = options.ThreadCount;
+	renderer.OnResize(options.Width, options.Height);
+
+	auto startTime = std::chrono::steady_clock::now();
+	renderer.RenderSamples(scene, camera, options.Samples);
+	float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+
+	scene.DeleteObjects();
+
+	double samples = (double)options.Width * options.Height * options.Samples;
+	std::cout << "Rendered in " << seconds << " s (" << samples / seconds / 1.0e6 << " M samples/s)\n";
+
+	if (!ImageIO::SavePNG(options.OutputPath, renderer.GetImageData(), options.Width, options.Height))
+	{
+		std::cerr << "Could not write " << options.OutputPath << "\n";
+		return 1;
+	}
+
+	std::cout << "Saved " << options.OutputPath << "\n";
+	return 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+
+// Renders a preset scene in this process with the thread pool of the Renderer and saves it as PNG,
+// no window, GPU or network involved
+class HeadlessRender
+{
+public:
+	struct Options
+	{
+		std::string SceneName = "TwoSpheres";
+		uint32_t Width = 1280, Height = 720;
+		uint32_t Samples = 64;
+		int LightBounces = 5;
+		// 0 uses every hardware thread
+		int ThreadCount = 0;
+
+		bool HasCameraPosition = false, HasCameraDirection = false;
+		glm::vec3 CameraPosition{ 0.0f };
+		glm::vec3 CameraDirection{ 0.0f, 0.0f, -1.0f };
+
+		std::string OutputPath = "render.png";
+	};
+public:
+	// Returns the process exit code
+	static int Run(const Options& options);
+};
@@ -0,0 +1,327 @@
+#include "JobQueue.h"
+
+#include "ImageIO.h"
+#include "Json.h"
+#include "Renderer.h"
+#include "SceneFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace Utils {
+	static bool ParseVec3(const std::string& text, glm::vec3& value)
+	{
+		return sscanf(text.c_str(), "%f,%f,%f", &value.x, &value.y, &value.z) == 3;
+	}
+
+	static bool ParseCount(const std::string& text, uint32_t& value)
+	{
+		char* end = nullptr;
+		long number = strtol(text.c_str(), &end, 10);
+		if (end == text.c_str() || *end != '\0' || number <= 0)
+			return false;
+
+		value = (uint32_t)number;
+		return true;
+	}
+
+	static double SecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int JobQueue::Run(const Options& options)
+{
+	std::vector<Job> jobs;
+	std::string error;
+	if (!LoadJobs(options.JobsPath, jobs, error))
+	{
+		std::cerr << error << "\n";
+		return 1;
+	}
+
+	JobQueue queue(options, std::move(jobs));
+	return queue.Execute();
+}
+
+bool JobQueue::LoadJobs(const std::string& path, std::vector<Job>& jobs, std::string& error)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		error = "could not open " + path;
+		return false;
+	}
+
+	jobs.clear();
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+
+		size_t first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos || line[first] == '#')
+			continue;
+
+		Job job;
+		job.Line = lineNumber;
+
+		std::istringstream stream(line);
+		std::string pair;
+		while (stream >> pair)
+		{
+			size_t separator = pair.find('=');
+			std::string key = pair.substr(0, separator);
+			std::string value = separator == std::string::npos ? std::string() : pair.substr(separator + 1);
+
+			bool valid = true;
+			if (key == "scene")
+				job.SceneName = value;
+			else if (key == "width")
+				valid = Utils::ParseCount(value, job.Width);
+			else if (key == "height")
+				valid = Utils::ParseCount(value, job.Height);
+			else if (key == "samples")
+				valid = Utils::ParseCount(value, job.Samples);
+			else if (key == "bounces")
+				job.LightBounces = atoi(value.c_str());
+			else if (key == "camera-position")
+				valid = job.HasCameraPosition = Utils::ParseVec3(value, job.CameraPosition);
+			else if (key == "camera-direction")
+				valid = job.HasCameraDirection = Utils::ParseVec3(value, job.CameraDirection);
+			else if (key == "output")
+				job.OutputPath = value;
+			else
+			{
+				error = path + ":" + std::to_string(lineNumber) + ": unknown key '" + key + "'";
+				return false;
+			}
+
+			if (!valid || value.empty())
+			{
+				error = path + ":" + std::to_string(lineNumber) + ": bad value in '" + pair + "'";
+				return false;
+			}
+		}
+
+		if (job.OutputPath.empty())
+		{
+			error = path + ":" + std::to_string(lineNumber) + ": jobs need an output=<file.png>";
+			return false;
+		}
+
+		jobs.push_back(job);
+	}
+
+	if (jobs.empty())
+	{
+		error = path + " holds no jobs";
+		return false;
+	}
+
+	return true;
+}
+
+JobQueue::JobQueue(const Options& options, std::vector<Job> jobs)
+	: m_Options(options), m_Jobs(std::move(jobs))
+{
+	m_Results.resize(m_Jobs.size());
+
+	for (const Job& job : m_Jobs)
+		m_Scenes[job.SceneName].RemainingJobs++;
+}
+
+int JobQueue::Execute()
+{
+	m_ThreadPool = std::make_shared<ThreadPool>((uint32_t)std::max(m_Options.ThreadCount, 0));
+	m_StartTime = std::chrono::steady_clock::now();
+
+	// Lane threads help out with the tiles of their own job while they wait for it, like any caller of the pool
+	int laneCount = std::clamp(m_Options.ConcurrentJobs, 1, (int)m_Jobs.size());
+	std::vector<std::thread> lanes;
+	for (int lane = 1; lane < laneCount; lane++)
+		lanes.emplace_back(&JobQueue::RunLane, this, lane);
+
+	RunLane(0);
+	for (std::thread& lane : lanes)
+		lane.join();
+
+	double totalSeconds = Utils::SecondsSince(m_StartTime);
+
+	uint32_t failedJobs = 0;
+	for (const JobResult& result : m_Results)
+		failedJobs += !result.Succeeded;
+
+	std::cout << m_Jobs.size() - failedJobs << " of " << m_Jobs.size() << " jobs rendered in " << totalSeconds << " s\n";
+
+	if (!WriteSummary(totalSeconds))
+	{
+		std::cerr << "Could not write " << m_Options.SummaryPath << "\n";
+		return 1;
+	}
+
+	return failedJobs == 0 ? 0 : 1;
+}
+
+void JobQueue::RunLane(int lane)
+{
+	while (true)
+	{
+		uint32_t jobIndex = m_NextJob.fetch_add(1);
+		if (jobIndex >= m_Jobs.size())
+			return;
+
+		const Job& job = m_Jobs[jobIndex];
+		JobResult& result = m_Results[jobIndex];
+		result.Lane = lane;
+		result.StartSeconds = Utils::SecondsSince(m_StartTime);
+
+		RenderJob(job, result);
+
+		uint32_t finished = m_FinishedJobs.fetch_add(1) + 1;
+
+		std::lock_guard<std::mutex> lock(m_OutputMutex);
+		if (result.Succeeded)
+		{
+			std::cout << "[" << finished << "/" << m_Jobs.size() << "] " << job.OutputPath << " in "
+				<< result.RenderSeconds << " s\n";
+		}
+		else
+		{
+			std::cerr << "[" << finished << "/" << m_Jobs.size() << "] line " << job.Line << " failed: " << result.Error << "\n";
+		}
+	}
+}
+
+void JobQueue::RenderJob(const Job& job, JobResult& result)
+{
+	auto loadStart = std::chrono::steady_clock::now();
+	std::shared_ptr<LoadedScene> scene = AcquireScene(job.SceneName, result.SceneWasLoaded, result.Error);
+	result.LoadSeconds = Utils::SecondsSince(loadStart);
+
+	if (!scene)
+	{
+		ReleaseScene(job.SceneName);
+		return;
+	}
+
+	Camera camera = scene->SceneCamera;
+	camera.SetView(job.HasCameraPosition ? job.CameraPosition : camera.GetPosition(),
+		job.HasCameraDirection ? job.CameraDirection : camera.GetDirection());
+	camera.OnResize(job.Width, job.Height);
+
+	Renderer renderer;
+	renderer.SetThreadPool(m_ThreadPool);
+	renderer.GetSettings().LightBounces = job.LightBounces;
+	renderer.OnResize(job.Width, job.Height);
+
+	auto renderStart = std::chrono::steady_clock::now();
+	renderer.RenderSamples(scene->SceneData, camera, job.Samples);
+	result.RenderSeconds = Utils::SecondsSince(renderStart);
+
+	// Geometry is freed as soon as no job that is left needs it
+	scene.reset();
+	ReleaseScene(job.SceneName);
+
+	auto saveStart = std::chrono::steady_clock::now();
+	std::error_code errorCode;
+	std::filesystem::path outputDirectory = std::filesystem::path(job.OutputPath).parent_path();
+	if (!outputDirectory.empty())
+		std::filesystem::create_directories(outputDirectory, errorCode);
+
+	if (!ImageIO::SavePNG(job.OutputPath, renderer.GetImageData(), job.Width, job.Height))
+	{
+		result.Error = "could not write " + job.OutputPath;
+		return;
+	}
+	result.SaveSeconds = Utils::SecondsSince(saveStart);
+
+	result.Succeeded = true;
+}
+
+std::shared_ptr<JobQueue::LoadedScene> JobQueue::AcquireScene(const std::string& name, bool& loaded, std::string& error)
+{
+	// Loads happen under the lock, the binary cache keeps them short and no lane waits for a scene loaded twice
+	std::lock_guard<std::mutex> lock(m_SceneMutex);
+	SceneEntry& entry = m_Scenes[name];
+
+	loaded = false;
+	if (entry.Loaded)
+		return entry.Loaded;
+
+	auto scene = std::make_shared<LoadedScene>();
+	if (!SceneFile::LoadFileOrPreset(name, scene->SceneData, scene->SceneCamera, error))
+		return nullptr;
+
+	entry.Loaded = scene;
+	loaded = true;
+	return scene;
+}
+
+void JobQueue::ReleaseScene(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(m_SceneMutex);
+	SceneEntry& entry = m_Scenes[name];
+
+	if (--entry.RemainingJobs == 0)
+		m_Scenes.erase(name);
+}
+
+bool JobQueue::WriteSummary(double totalSeconds) const
+{
+	std::ofstream file(m_Options.SummaryPath, std::ios::trunc);
+	if (!file)
+		return false;
+
+	uint32_t failedJobs = 0;
+	for (const JobResult& result : m_Results)
+		failedJobs += !result.Succeeded;
+
+	file << "{\n";
+	file << "\t\"TotalSeconds\": " << totalSeconds << ",\n";
+	file << "\t\"ThreadCount\": " << m_ThreadPool->GetThreadCount() << ",\n";
+	file << "\t\"ConcurrentJobs\": " << std::clamp(m_Options.ConcurrentJobs, 1, (int)m_Jobs.size()) << ",\n";
+	file << "\t\"Succeeded\": " << m_Jobs.size() - failedJobs << ",\n";
+	file << "\t\"Failed\": " << failedJobs << ",\n";
+	file << "\t\"Jobs\": [";
+
+	for (size_t i = 0; i < m_Jobs.size(); i++)
+	{
+		const Job& job = m_Jobs[i];
+		const JobResult& result = m_Results[i];
+
+		double samples = (double)job.Width * job.Height * job.Samples;
+		double samplesPerSecond = result.RenderSeconds > 0.0 ? samples / result.RenderSeconds : 0.0;
+
+		file << (i == 0 ? "\n" : ",\n") << "\t\t{\n";
+		file << "\t\t\t\"Line\": " << job.Line << ",\n";
+		file << "\t\t\t\"Scene\": \"" << EscapeJson(job.SceneName) << "\",\n";
+		file << "\t\t\t\"Output\": \"" << EscapeJson(job.OutputPath) << "\",\n";
+		file << "\t\t\t\"Width\": " << job.Width << ",\n";
+		file << "\t\t\t\"Height\": " << job.Height << ",\n";
+		file << "\t\t\t\"Samples\": " << job.Samples << ",\n";
+		file << "\t\t\t\"Succeeded\": " << (result.Succeeded ? "true" : "false") << ",\n";
+		if (!result.Succeeded)
+			file << "\t\t\t\"Error\": \"" << EscapeJson(result.Error) << "\",\n";
+		file << "\t\t\t\"SceneLoaded\": " << (result.SceneWasLoaded ? "true" : "false") << ",\n";
+		file << "\t\t\t\"Lane\": " << result.Lane << ",\n";
+		file << "\t\t\t\"StartSeconds\": " << result.StartSeconds << ",\n";
+		file << "\t\t\t\"LoadSeconds\": " << result.LoadSeconds << ",\n";
+		file << "\t\t\t\"RenderSeconds\": " << result.RenderSeconds << ",\n";
+		file << "\t\t\t\"SaveSeconds\": " << result.SaveSeconds << ",\n";
+		file << "\t\t\t\"SamplesPerSecond\": " << samplesPerSecond << "\n";
+		file << "\t\t}";
+	}
+
+	file << (m_Jobs.empty() ? "]\n" : "\n\t]\n");
+	file << "}\n";
+	return (bool)file;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Camera.h"
+#include "Scene.h"
+#include "ThreadPool.h"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Renders a list of jobs unattended. All jobs share one thread pool and a few of them render at the same time, so the
+// tiles of small jobs still keep every core busy. A scene stays loaded until the last job that uses it finished.
+class JobQueue
+{
+public:
+	// One line of the job file: whitespace separated key=value pairs named like the options of RTCli render,
+	// e.g. scene=scenes/ColorRoom.rtscene width=640 height=360 samples=256 output=out/room.png
+	struct Job
+	{
+		std::string SceneName = "TwoSpheres";
+		uint32_t Width = 1280, Height = 720;
+		uint32_t Samples = 64;
+		int LightBounces = 5;
+
+		bool HasCameraPosition = false, HasCameraDirection = false;
+		glm::vec3 CameraPosition{ 0.0f };
+		glm::vec3 CameraDirection{ 0.0f, 0.0f, -1.0f };
+
+		std::string OutputPath;
+		int Line = 0;
+	};
+
+	struct Options
+	{
+		std::string JobsPath;
+		std::string SummaryPath = "summary.json";
+		// 0 uses every hardware thread
+		int ThreadCount = 0;
+		// Jobs rendered at the same time on the shared pool
+		int ConcurrentJobs = 2;
+	};
+public:
+	// Returns the process exit code, 1 if any job failed
+	static int Run(const Options& options);
+
+	// Lines starting with # are ignored
+	static bool LoadJobs(const std::string& path, std::vector<Job>& jobs, std::string& error);
+private:
+	struct JobResult
+	{
+		bool Succeeded = false;
+		bool SceneWasLoaded = false;
+		std::string Error;
+		double LoadSeconds = 0.0, RenderSeconds = 0.0, SaveSeconds = 0.0;
+		double StartSeconds = 0.0;
+		int Lane = 0;
+	};
+
+	struct LoadedScene
+	{
+		Scene SceneData;
+		Camera SceneCamera{ 45.0f, 0.1f, 100.0f };
+
+		~LoadedScene() { SceneData.DeleteObjects(); }
+	};
+
+	struct SceneEntry
+	{
+		std::shared_ptr<LoadedScene> Loaded;
+		uint32_t RemainingJobs = 0;
+	};
+
+	JobQueue(const Options& options, std::vector<Job> jobs);
+
+	int Execute();
+	void RunLane(int lane);
+	void RenderJob(const Job& job, JobResult& result);
+
+	std::shared_ptr<LoadedScene> AcquireScene(const std::string& name, bool& loaded, std::string& error);
+	void ReleaseScene(const std::string& name);
+
+	bool WriteSummary(double totalSeconds) const;
+private:
+	Options m_Options;
+	std::vector<Job> m_Jobs;
+	std::vector<JobResult> m_Results;
+
+	std::shared_ptr<ThreadPool> m_ThreadPool;
+	std::atomic<uint32_t> m_NextJob{ 0 };
+	std::atomic<uint32_t> m_FinishedJobs{ 0 };
+
+	std::mutex m_SceneMutex;
+	std::map<std::string, SceneEntry> m_Scenes;
+
+	std::mutex m_OutputMutex;
+	std::chrono::steady_clock::time_point m_StartTime;
+};
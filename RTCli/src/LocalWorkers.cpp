@@ -0,0 +1,73 @@
+#include "LocalWorkers.h"
+
+#include <iostream>
+#include <string>
+
+LocalWorkers::LocalWorkers(uint16_t port, uint32_t threadsPerWorker)
+	: m_Port(port), m_ThreadsPerWorker(threadsPerWorker)
+{
+}
+
+uint32_t LocalWorkers::Start(uint32_t count)
+{
+	uint32_t started = 0;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (StartWorker())
+			started++;
+		else
+			std::cerr << "Could not start local worker " << i << "\n";
+	}
+
+	m_MaxReplacements += count;
+	return started;
+}
+
+bool LocalWorkers::Replace(uint32_t processId)
+{
+	for (size_t i = 0; i < m_Processes.size(); i++)
+	{
+		ChildProcess& process = *m_Processes[i];
+		if (process.GetId() != processId)
+			continue;
+
+		// An exited process is not killed again, its id may already belong to another one
+		process.Kill();
+		process.Wait();
+		m_Processes.erase(m_Processes.begin() + i);
+
+		if (m_Replacements < m_MaxReplacements)
+		{
+			m_Replacements++;
+			if (!StartWorker())
+				std::cerr << "Could not start a replacement worker\n";
+		}
+		return true;
+	}
+
+	return false;
+}
+
+bool LocalWorkers::AnyRunning()
+{
+	bool anyRunning = false;
+	for (auto& process : m_Processes)
+		anyRunning |= !process->HasExited();
+	return anyRunning;
+}
+
+void LocalWorkers::WaitAll()
+{
+	for (auto& process : m_Processes)
+		process->Wait();
+}
+
+bool LocalWorkers::StartWorker()
+{
+	auto process = std::make_unique<ChildProcess>();
+	if (!process->Start({ "worker", "--connect", "127.0.0.1:" + std::to_string(m_Port), "--threads", std::to_string(m_ThreadsPerWorker) }))
+		return false;
+
+	m_Processes.push_back(std::move(process));
+	return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ChildProcess.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Worker processes the coordinator or the frame farm starts on this machine. Their connections are matched to them by
+// the process id workers send in their hello, so one that stopped answering is killed instead of working on next to
+// the worker its work was handed to.
+class LocalWorkers
+{
+public:
+	LocalWorkers(uint16_t port, uint32_t threadsPerWorker);
+
+	// Returns how many of them started
+	uint32_t Start(uint32_t count);
+	// Kills the worker and starts another one in its place. Replacements stop once there were as many as workers
+	// were started, a job that takes down every worker ends instead of going on forever. Returns false if the
+	// process id belongs to none of the workers
+	bool Replace(uint32_t processId);
+
+	bool AnyRunning();
+	// Waits for every worker to exit, they are expected to have been shut down
+	void WaitAll();
+private:
+	bool StartWorker();
+private:
+	uint16_t m_Port = 0;
+	uint32_t m_ThreadsPerWorker = 1;
+	std::vector<std::unique_ptr<ChildProcess>> m_Processes;
+	uint32_t m_Replacements = 0;
+	uint32_t m_MaxReplacements = 0;
+};
@@ -0,0 +1,281 @@
+#include "RenderCoordinator.h"
+
+#include "ImageIO.h"
+#include "SceneFile.h"
+#include "SceneSerializer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+int RenderCoordinator::Run(const Options& options)
+{
+	RenderCoordinator coordinator(options);
+	return coordinator.Execute();
+}
+
+RenderCoordinator::RenderCoordinator(const Options& options)
+	: m_Options(options)
+{
+}
+
+int RenderCoordinator::Execute()
+{
+	Scene scene;
+	Camera camera(45.0f, 0.1f, 100.0f);
+	std::string error;
+	if (!SceneFile::LoadFileOrPreset(m_Options.SceneName, scene, camera, error))
+	{
+		std::cerr << error << "\n";
+		return 1;
+	}
+
+	camera.SetPosition(m_Options.HasCameraPosition ? m_Options.CameraPosition : camera.GetPosition());
+	camera.SetDirection(m_Options.HasCameraDirection ? m_Options.CameraDirection : camera.GetDirection());
+
+	Renderer::Settings settings;
+	settings.LightBounces = m_Options.LightBounces;
+
+	BinaryWriter job;
+	job.Write(m_Options.Width);
+	job.Write(m_Options.Height);
+	SceneSerializer::WriteSettings(job, settings);
+	SceneSerializer::WriteCamera(job, camera);
+	SceneSerializer::WriteScene(job, scene);
+	m_JobPayload = std::move(job.GetBuffer());
+	scene.DeleteObjects();
+
+	// Every tile gets its first range of samples before any gets its second one
+	uint32_t tileSize = glm::max(m_Options.TileSize, 1u);
+	uint32_t samplesPerTile = glm::max(m_Options.SamplesPerTile, 1u);
+	uint32_t tileCount = 0;
+	for (uint32_t firstSample = 0; firstSample < m_Options.Samples; firstSample += samplesPerTile)
+	{
+		tileCount = 0;
+		for (uint32_t minY = 0; minY < m_Options.Height; minY += tileSize)
+		{
+			for (uint32_t minX = 0; minX < m_Options.Width; minX += tileSize)
+			{
+				Unit unit;
+				unit.Region = { minX, minY, glm::min(minX + tileSize, m_Options.Width), glm::min(minY + tileSize, m_Options.Height) };
+				unit.FirstSample = firstSample;
+				unit.SampleCount = glm::min(samplesPerTile, m_Options.Samples - firstSample);
+				m_PendingUnits.push_back((uint32_t)m_Units.size());
+				m_Units.push_back(unit);
+				tileCount++;
+			}
+		}
+	}
+
+	m_AccumulationData.assign((size_t)m_Options.Width * m_Options.Height, glm::vec4(0.0f));
+
+	Socket listener = Socket::Listen(m_Options.Port);
+	if (!listener.IsValid())
+	{
+		std::cerr << "Could not listen on port " << m_Options.Port << "\n";
+		return 1;
+	}
+
+	uint16_t port = listener.GetLocalPort();
+	std::cout << "Coordinator listening on port " << port << ", " << tileCount << " tiles of " << m_Options.Samples << " samples in "
+		<< m_Units.size() << " requests of up to " << samplesPerTile << " samples\n";
+
+	uint32_t localWorkerCount = (uint32_t)glm::max(m_Options.LocalWorkers, 0);
+	uint32_t hardwareThreads = glm::max(std::thread::hardware_concurrency(), 1u);
+	m_LocalWorkers = std::make_unique<LocalWorkers>(port, glm::max(hardwareThreads / glm::max(localWorkerCount, 1u), 1u));
+	m_LocalWorkers->Start(localWorkerCount);
+
+	auto startTime = std::chrono::steady_clock::now();
+	auto timeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(m_Options.TimeoutSeconds));
+	uint32_t lastReportedPercent = 0;
+
+	std::vector<Socket*> sockets;
+	std::vector<bool> readable;
+	while (m_CompletedUnits < m_Units.size())
+	{
+		sockets.clear();
+		sockets.push_back(&listener);
+		for (auto& connection : m_Connections)
+			sockets.push_back(&connection->Link);
+
+		if (Socket::WaitReadable(sockets, 100, readable))
+		{
+			// Connections are only appended or dropped below, so readable still lines up with them
+			size_t connectionCount = m_Connections.size();
+			for (size_t i = connectionCount; i-- > 0;)
+			{
+				if (!readable[i + 1])
+					continue;
+
+				Connection& connection = *m_Connections[i];
+				TileProtocol::Message message;
+				if (!TileProtocol::Receive(connection.Link, message))
+					DropConnection(i, "disconnected");
+				else if (!HandleMessage(connection, message))
+					DropConnection(i, "sent an invalid message");
+			}
+
+			if (readable[0])
+			{
+				auto connection = std::make_unique<Connection>();
+				connection->Link = listener.Accept();
+				connection->LastActivity = std::chrono::steady_clock::now();
+				if (connection->Link.IsValid())
+					m_Connections.push_back(std::move(connection));
+			}
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		for (size_t i = m_Connections.size(); i-- > 0;)
+		{
+			Connection& connection = *m_Connections[i];
+			if (!connection.InFlight.empty() && now - connection.LastActivity > timeout)
+				DropConnection(i, "timed out");
+		}
+
+		for (size_t i = m_Connections.size(); i-- > 0;)
+		{
+			if (!Dispatch(*m_Connections[i]))
+				DropConnection(i, "disconnected");
+		}
+
+		uint32_t percent = (uint32_t)(100ull * m_CompletedUnits / m_Units.size());
+		if (percent / 10 != lastReportedPercent / 10)
+		{
+			std::cout << percent << "% (" << m_CompletedUnits << "/" << m_Units.size() << " requests, " << m_Connections.size() << " workers)\n";
+			lastReportedPercent = percent;
+		}
+	}
+
+	float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+
+	for (auto& connection : m_Connections)
+		TileProtocol::Send(connection->Link, TileProtocol::MessageType::Shutdown, nullptr, 0);
+	m_Connections.clear();
+
+	m_LocalWorkers->WaitAll();
+
+	double samples = (double)m_Options.Width * m_Options.Height * m_Options.Samples;
+	std::cout << "Rendered in " << seconds << " s (" << samples / seconds / 1.0e6 << " M samples/s)\n";
+
+	std::vector<uint32_t> pixels;
+	ResolveImage(pixels);
+	if (!ImageIO::SavePNG(m_Options.OutputPath, pixels.data(), m_Options.Width, m_Options.Height))
+	{
+		std::cerr << "Could not write " << m_Options.OutputPath << "\n";
+		return 1;
+	}
+
+	std::cout << "Saved " << m_Options.OutputPath << "\n";
+	return 0;
+}
+
+bool RenderCoordinator::HandleMessage(Connection& connection, const TileProtocol::Message& message)
+{
+	BinaryReader reader(message.Payload.data(), message.Payload.size());
+	connection.LastActivity = std::chrono::steady_clock::now();
+
+	switch (message.Type)
+	{
+		case TileProtocol::MessageType::Hello:
+		{
+			TileProtocol::Hello hello;
+			if (connection.Ready || !reader.Read(hello) || hello.ProtocolVersion != TileProtocol::Version)
+				return false;
+
+			connection.ThreadCount = hello.ThreadCount;
+			connection.ProcessId = hello.ProcessId;
+			connection.Ready = true;
+			std::cout << "Worker connected with " << hello.ThreadCount << " threads\n";
+			return TileProtocol::Send(connection.Link, TileProtocol::MessageType::Job, m_JobPayload.data(), (uint32_t)m_JobPayload.size());
+		}
+		case TileProtocol::MessageType::TileResult:
+		{
+			TileProtocol::TileRequest request;
+			if (!reader.Read(request))
+				return false;
+
+			auto it = std::find(connection.InFlight.begin(), connection.InFlight.end(), request.TileId);
+			if (it == connection.InFlight.end())
+				return false;
+
+			Unit& unit = m_Units[request.TileId];
+			const Renderer::Tile& region = unit.Region;
+			uint32_t regionWidth = region.MaxX - region.MinX;
+			size_t pixelCount = (size_t)regionWidth * (region.MaxY - region.MinY);
+			if (reader.GetRemaining() != pixelCount * sizeof(glm::vec4))
+				return false;
+
+			for (uint32_t y = region.MinY; y < region.MaxY; y++)
+			{
+				glm::vec4* row = &m_AccumulationData[region.MinX + (size_t)y * m_Options.Width];
+				for (uint32_t x = 0; x < regionWidth; x++)
+				{
+					glm::vec4 sum;
+					reader.Read(sum);
+					row[x] += sum;
+				}
+			}
+
+			connection.InFlight.erase(it);
+			unit.Done = true;
+			m_CompletedUnits++;
+			return true;
+		}
+		case TileProtocol::MessageType::Heartbeat:
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool RenderCoordinator::Dispatch(Connection& connection)
+{
+	if (!connection.Ready)
+		return true;
+
+	while (connection.InFlight.size() < m_Options.TilesInFlight && !m_PendingUnits.empty())
+	{
+		uint32_t unitIndex = m_PendingUnits.front();
+		m_PendingUnits.pop_front();
+
+		TileProtocol::TileRequest request;
+		request.TileId = unitIndex;
+		request.Region = m_Units[unitIndex].Region;
+		request.FirstSample = m_Units[unitIndex].FirstSample;
+		request.SampleCount = m_Units[unitIndex].SampleCount;
+
+		// Counted as in flight first, so a failed send hands the tile back with the others
+		if (connection.InFlight.empty())
+			connection.LastActivity = std::chrono::steady_clock::now();
+		connection.InFlight.push_back(unitIndex);
+
+		if (!TileProtocol::Send(connection.Link, TileProtocol::MessageType::TileRequest, &request, sizeof(request)))
+			return false;
+	}
+
+	return true;
+}
+
+void RenderCoordinator::DropConnection(size_t index, const char* reason)
+{
+	Connection& connection = *m_Connections[index];
+	if (connection.Ready)
+		std::cout << "Worker " << reason << ", reassigning " << connection.InFlight.size() << " requests\n";
+
+	// Reassigned tiles go first, they are the oldest
+	for (auto it = connection.InFlight.rbegin(); it != connection.InFlight.rend(); it++)
+		m_PendingUnits.push_front(*it);
+
+	// A local worker that stopped answering would trace on for nothing
+	if (connection.ProcessId != 0 && m_LocalWorkers->Replace(connection.ProcessId))
+		std::cout << "Replaced local worker " << connection.ProcessId << "\n";
+
+	m_Connections.erase(m_Connections.begin() + index);
+}
+
+void RenderCoordinator::ResolveImage(std::vector<uint32_t>& pixels) const
+{
+	pixels.resize(m_AccumulationData.size());
+	Renderer::ResolveSums(m_AccumulationData.data(), m_AccumulationData.size(), pixels.data());
+}
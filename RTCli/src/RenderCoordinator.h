@@ -0,0 +1,91 @@
+#pragma once
+
+#include "LocalWorkers.h"
+#include "Socket.h"
+#include "TileProtocol.h"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Render coordinator: owns scene and camera, splits the image into tiles and hands them out to the workers
+// that connect to it. A tile is handed out once per range of samples, so no single piece of work runs for long at high
+// sample counts. Workers send back per pixel sums that are merged into one accumulation buffer. Work of workers that
+// disconnect or stop answering is handed out again, local workers that stopped answering are replaced.
+class RenderCoordinator
+{
+public:
+	struct Options
+	{
+		std::string SceneName = "TwoSpheres";
+		uint32_t Width = 1280, Height = 720;
+		uint32_t Samples = 64;
+		int LightBounces = 5;
+
+		bool HasCameraPosition = false, HasCameraDirection = false;
+		glm::vec3 CameraPosition{ 0.0f };
+		glm::vec3 CameraDirection{ 0.0f, 0.0f, -1.0f };
+
+		// 0 picks a free port
+		uint16_t Port = 0;
+		uint32_t TileSize = 64;
+		// Samples traced per tile and request, the last range of a tile may be shorter
+		uint32_t SamplesPerTile = 16;
+		// Tiles queued on every worker so it never waits for the round trip of the next request
+		uint32_t TilesInFlight = 2;
+		// Workers started on this machine, each gets an equal share of the hardware threads
+		int LocalWorkers = 0;
+		// A busy worker that sends nothing for this long is considered dead, workers send heartbeats while they render
+		float TimeoutSeconds = 60.0f;
+
+		std::string OutputPath = "render.png";
+	};
+public:
+	// Returns the process exit code
+	static int Run(const Options& options);
+private:
+	struct Unit
+	{
+		Renderer::Tile Region;
+		uint32_t FirstSample = 0;
+		uint32_t SampleCount = 0;
+		bool Done = false;
+	};
+
+	struct Connection
+	{
+		Socket Link;
+		bool Ready = false;
+		uint32_t ThreadCount = 0;
+		uint32_t ProcessId = 0;
+		std::vector<uint32_t> InFlight;
+		std::chrono::steady_clock::time_point LastActivity;
+	};
+
+	explicit RenderCoordinator(const Options& options);
+
+	int Execute();
+	bool HandleMessage(Connection& connection, const TileProtocol::Message& message);
+	bool Dispatch(Connection& connection);
+	void DropConnection(size_t index, const char* reason);
+	void ResolveImage(std::vector<uint32_t>& pixels) const;
+private:
+	Options m_Options;
+
+	std::vector<uint8_t> m_JobPayload;
+
+	std::vector<Unit> m_Units;
+	std::deque<uint32_t> m_PendingUnits;
+	uint32_t m_CompletedUnits = 0;
+
+	std::vector<std::unique_ptr<Connection>> m_Connections;
+	std::unique_ptr<LocalWorkers> m_LocalWorkers;
+
+	// Sample sums of the whole image, rows bottom to top like the Renderer's own buffers
+	std::vector<glm::vec4> m_AccumulationData;
+};
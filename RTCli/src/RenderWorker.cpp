@@ -0,0 +1,208 @@
+#include "RenderWorker.h"
+
+#include "Camera.h"
+#include "ChildProcess.h"
+#include "ImageIO.h"
+#include "Renderer.h"
+#include "SceneSerializer.h"
+#include "Socket.h"
+#include "TileProtocol.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace Utils {
+	// Sends heartbeats from a thread of its own, the worker's thread sends nothing while it renders a tile or frame
+	class Heartbeat
+	{
+	public:
+		Heartbeat(Socket& socket, std::mutex& sendMutex)
+		{
+			m_Thread = std::thread([this, &socket, &sendMutex]()
+				{
+					std::unique_lock<std::mutex> lock(m_Mutex);
+					while (!m_WakeCondition.wait_for(lock, std::chrono::milliseconds(TileProtocol::HeartbeatMilliseconds), [this] { return m_Stop; }))
+					{
+						std::lock_guard<std::mutex> sendLock(sendMutex);
+						if (!TileProtocol::Send(socket, TileProtocol::MessageType::Heartbeat, nullptr, 0))
+							return;
+					}
+				});
+		}
+
+		~Heartbeat()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Stop = true;
+			}
+			m_WakeCondition.notify_one();
+			m_Thread.join();
+		}
+	private:
+		std::mutex m_Mutex;
+		std::condition_variable m_WakeCondition;
+		bool m_Stop = false;
+		std::thread m_Thread;
+	};
+}
+
+int RenderWorker::Run(const Options& options)
+{
+	Socket socket;
+	for (int attempt = 0; attempt < options.ConnectAttempts && !socket.IsValid(); attempt++)
+	{
+		if (attempt > 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+		socket = Socket::Connect(options.Host, options.Port);
+	}
+
+	if (!socket.IsValid())
+	{
+		std::cerr << "Worker: could not connect to " << options.Host << ":" << options.Port << "\n";
+		return 1;
+	}
+
+	Renderer renderer;
+	renderer.GetSettings().ThreadCount = options.ThreadCount;
+
+	// The scene stays loaded for every tile and frame of the job
+	Scene scene;
+	Camera camera(45.0f, 0.1f, 100.0f);
+	uint32_t width = 0, height = 0;
+	bool hasJob = false;
+
+	TileProtocol::Hello hello;
+	hello.ThreadCount = options.ThreadCount > 0 ? (uint32_t)options.ThreadCount : std::thread::hardware_concurrency();
+	hello.ProcessId = ChildProcess::GetCurrentId();
+	if (!TileProtocol::Send(socket, TileProtocol::MessageType::Hello, &hello, sizeof(hello)))
+		return 1;
+
+	// Every send after the hello shares the socket with the heartbeat
+	std::mutex sendMutex;
+	Utils::Heartbeat heartbeat(socket, sendMutex);
+	auto send = [&](TileProtocol::MessageType type, const void* payload, uint32_t size)
+	{
+		std::lock_guard<std::mutex> lock(sendMutex);
+		return TileProtocol::Send(socket, type, payload, size);
+	};
+
+	std::vector<glm::vec4> sums;
+	std::vector<uint32_t> pixels;
+	BinaryWriter result;
+
+	TileProtocol::Message message;
+	while (TileProtocol::Receive(socket, message))
+	{
+		BinaryReader reader(message.Payload.data(), message.Payload.size());
+
+		switch (message.Type)
+		{
+			case TileProtocol::MessageType::Job:
+			{
+				Renderer::Settings settings;
+				if (!reader.Read(width) || !reader.Read(height) || !SceneSerializer::ReadSettings(reader, settings)
+					|| !SceneSerializer::ReadCamera(reader, camera) || !SceneSerializer::ReadScene(reader, scene))
+				{
+					std::cerr << "Worker: malformed job\n";
+					scene.DeleteObjects();
+					return 1;
+				}
+
+				// Thread settings belong to this machine, not to the coordinator
+				settings.ThreadCount = options.ThreadCount;
+				settings.PinThreads = renderer.GetSettings().PinThreads;
+				renderer.GetSettings() = settings;
+
+				camera.OnResize(width, height);
+				hasJob = true;
+				break;
+			}
+			case TileProtocol::MessageType::TileRequest:
+			{
+				TileProtocol::TileRequest request;
+				if (!hasJob || !reader.Read(request))
+				{
+					std::cerr << "Worker: unexpected tile request\n";
+					scene.DeleteObjects();
+					return 1;
+				}
+
+				const Renderer::Tile& region = request.Region;
+				sums.resize((size_t)(region.MaxX - region.MinX) * (region.MaxY - region.MinY));
+				renderer.RenderRegion(scene, camera, region, request.FirstSample, request.SampleCount, sums.data());
+
+				result.GetBuffer().clear();
+				result.Write(request);
+				result.WriteBytes(sums.data(), sums.size() * sizeof(glm::vec4));
+				if (!send(TileProtocol::MessageType::TileResult, result.GetBuffer().data(), (uint32_t)result.GetBuffer().size()))
+				{
+					scene.DeleteObjects();
+					return 1;
+				}
+				break;
+			}
+			case TileProtocol::MessageType::FrameRequest:
+			{
+				TileProtocol::FrameResult frameResult;
+				uint32_t sampleCount = 0, pathLength = 0;
+				if (!hasJob || !reader.Read(frameResult.FrameNumber) || !reader.Read(sampleCount) || !reader.Read(pathLength)
+					|| pathLength > reader.GetRemaining())
+				{
+					std::cerr << "Worker: malformed frame request\n";
+					scene.DeleteObjects();
+					return 1;
+				}
+
+				std::string path(pathLength, '\0');
+				reader.ReadBytes(path.data(), pathLength);
+				if (!SceneSerializer::ReadCamera(reader, camera))
+				{
+					std::cerr << "Worker: malformed frame request\n";
+					scene.DeleteObjects();
+					return 1;
+				}
+				camera.OnResize(width, height);
+
+				sums.resize((size_t)width * height);
+				pixels.resize(sums.size());
+				renderer.RenderRegion(scene, camera, { 0, 0, width, height }, 0, sampleCount, sums.data());
+				Renderer::ResolveSums(sums.data(), sums.size(), pixels.data());
+
+				// Written under another name first, a frame that exists is always complete. The name is this worker's own,
+				// a worker that was given up on may still be writing the same frame
+				std::string temporaryPath = path + ".part." + std::to_string(ChildProcess::GetCurrentId());
+				std::error_code error;
+				frameResult.Saved = ImageIO::SavePNG(temporaryPath, pixels.data(), width, height);
+				if (frameResult.Saved)
+				{
+					std::filesystem::rename(temporaryPath, path, error);
+					frameResult.Saved = !error;
+				}
+
+				if (!send(TileProtocol::MessageType::FrameResult, &frameResult, sizeof(frameResult)))
+				{
+					scene.DeleteObjects();
+					return 1;
+				}
+				break;
+			}
+			case TileProtocol::MessageType::Shutdown:
+			{
+				scene.DeleteObjects();
+				return 0;
+			}
+			default:
+				break;
+		}
+	}
+
+	// Coordinator went away
+	scene.DeleteObjects();
+	return 1;
+}
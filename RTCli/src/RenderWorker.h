@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Render worker process: connects to a coordinator, receives the job and traces the tiles or whole frames it is sent
+// until the coordinator shuts it down or the connection drops.
+class RenderWorker
+{
+public:
+	struct Options
+	{
+		std::string Host = "127.0.0.1";
+		uint16_t Port = 0;
+		// 0 picks the thread count from the hardware
+		int ThreadCount = 0;
+		// The coordinator may not be listening yet when the worker starts
+		int ConnectAttempts = 50;
+	};
+public:
+	// Returns the process exit code
+	static int Run(const Options& options);
+};
@@ -0,0 +1,213 @@
+#include "Socket.h"
+
+#if defined(_WIN32)
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <WinSock2.h>
+	#include <WS2tcpip.h>
+
+	typedef int socklen_t;
+	#define poll WSAPoll
+#else
+	#include <arpa/inet.h>
+	#include <netdb.h>
+	#include <netinet/in.h>
+	#include <netinet/tcp.h>
+	#include <poll.h>
+	#include <sys/socket.h>
+	#include <unistd.h>
+
+	#define closesocket close
+#endif
+
+#include <cstring>
+
+namespace Utils {
+	static void InitSockets()
+	{
+#if defined(_WIN32)
+		static bool s_Initialized = false;
+		if (!s_Initialized)
+		{
+			WSADATA data;
+			WSAStartup(MAKEWORD(2, 2), &data);
+			s_Initialized = true;
+		}
+#endif
+	}
+
+	static void SetNoDelay(intptr_t handle)
+	{
+		// Tile requests are small and latency bound
+		int enable = 1;
+		setsockopt((int)handle, IPPROTO_TCP, TCP_NODELAY, (const char*)&enable, sizeof(enable));
+	}
+}
+
+Socket::~Socket()
+{
+	Close();
+}
+
+Socket::Socket(Socket&& other) noexcept
+	: m_Handle(other.m_Handle)
+{
+	other.m_Handle = InvalidHandle;
+}
+
+Socket& Socket::operator=(Socket&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		m_Handle = other.m_Handle;
+		other.m_Handle = InvalidHandle;
+	}
+	return *this;
+}
+
+Socket Socket::Listen(uint16_t port)
+{
+	Utils::InitSockets();
+
+	intptr_t handle = (intptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (handle == InvalidHandle)
+		return Socket();
+
+	int reuse = 1;
+	setsockopt((int)handle, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(port);
+
+	if (bind((int)handle, (sockaddr*)&address, sizeof(address)) != 0 || listen((int)handle, SOMAXCONN) != 0)
+	{
+		closesocket((int)handle);
+		return Socket();
+	}
+
+	return Socket(handle);
+}
+
+Socket Socket::Connect(const std::string& host, uint16_t port)
+{
+	Utils::InitSockets();
+
+	addrinfo hints = {};
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+
+	addrinfo* addresses = nullptr;
+	if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0)
+		return Socket();
+
+	Socket result;
+	for (addrinfo* address = addresses; address != nullptr; address = address->ai_next)
+	{
+		intptr_t handle = (intptr_t)socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+		if (handle == InvalidHandle)
+			continue;
+
+		if (connect((int)handle, address->ai_addr, (socklen_t)address->ai_addrlen) == 0)
+		{
+			Utils::SetNoDelay(handle);
+			result = Socket(handle);
+			break;
+		}
+
+		closesocket((int)handle);
+	}
+
+	freeaddrinfo(addresses);
+	return result;
+}
+
+Socket Socket::Accept()
+{
+	intptr_t handle = (intptr_t)accept((int)m_Handle, nullptr, nullptr);
+	if (handle == InvalidHandle)
+		return Socket();
+
+	Utils::SetNoDelay(handle);
+	return Socket(handle);
+}
+
+bool Socket::SendAll(const void* data, size_t size)
+{
+	const char* bytes = (const char*)data;
+	while (size > 0)
+	{
+#if defined(_WIN32)
+		int sent = send((SOCKET)m_Handle, bytes, (int)std::min<size_t>(size, 1 << 30), 0);
+#else
+		ssize_t sent = send((int)m_Handle, bytes, size, MSG_NOSIGNAL);
+#endif
+		if (sent <= 0)
+			return false;
+
+		bytes += sent;
+		size -= sent;
+	}
+	return true;
+}
+
+bool Socket::ReceiveAll(void* data, size_t size)
+{
+	char* bytes = (char*)data;
+	while (size > 0)
+	{
+#if defined(_WIN32)
+		int received = recv((SOCKET)m_Handle, bytes, (int)std::min<size_t>(size, 1 << 30), 0);
+#else
+		ssize_t received = recv((int)m_Handle, bytes, size, 0);
+#endif
+		if (received <= 0)
+			return false;
+
+		bytes += received;
+		size -= received;
+	}
+	return true;
+}
+
+bool Socket::WaitReadable(const std::vector<Socket*>& sockets, int timeoutMs, std::vector<bool>& readable)
+{
+	std::vector<pollfd> descriptors(sockets.size());
+	for (size_t i = 0; i < sockets.size(); i++)
+	{
+		descriptors[i].fd = (decltype(descriptors[i].fd))sockets[i]->m_Handle;
+		descriptors[i].events = POLLIN;
+	}
+
+	readable.assign(sockets.size(), false);
+	if (poll(descriptors.data(), (unsigned long)descriptors.size(), timeoutMs) <= 0)
+		return false;
+
+	for (size_t i = 0; i < sockets.size(); i++)
+		readable[i] = (descriptors[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+
+	return true;
+}
+
+uint16_t Socket::GetLocalPort() const
+{
+	sockaddr_in address = {};
+	socklen_t length = sizeof(address);
+	if (getsockname((int)m_Handle, (sockaddr*)&address, &length) != 0)
+		return 0;
+
+	return ntohs(address.sin_port);
+}
+
+void Socket::Close()
+{
+	if (m_Handle == InvalidHandle)
+		return;
+
+	closesocket((int)m_Handle);
+	m_Handle = InvalidHandle;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Blocking TCP socket, move only
+class Socket
+{
+public:
+	Socket() = default;
+	~Socket();
+
+	Socket(Socket&& other) noexcept;
+	Socket& operator=(Socket&& other) noexcept;
+	Socket(const Socket&) = delete;
+	Socket& operator=(const Socket&) = delete;
+
+	// Port 0 picks a free port, see GetLocalPort
+	static Socket Listen(uint16_t port);
+	static Socket Connect(const std::string& host, uint16_t port);
+	Socket Accept();
+
+	bool SendAll(const void* data, size_t size);
+	bool ReceiveAll(void* data, size_t size);
+
+	// Waits until one of the sockets has data (or a closed connection) to read, readable gets one flag per socket.
+	// Returns false on timeout.
+	static bool WaitReadable(const std::vector<Socket*>& sockets, int timeoutMs, std::vector<bool>& readable);
+
+	uint16_t GetLocalPort() const;
+	bool IsValid() const { return m_Handle != InvalidHandle; }
+	void Close();
+private:
+	explicit Socket(intptr_t handle) : m_Handle(handle) {}
+private:
+	static constexpr intptr_t InvalidHandle = -1;
+	intptr_t m_Handle = InvalidHandle;
+};
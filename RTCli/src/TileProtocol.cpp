@@ -0,0 +1,34 @@
+#include "TileProtocol.h"
+
+namespace TileProtocol {
+
+	// Even a whole 8K frame of sums stays well below this, anything larger is a corrupt header
+	static constexpr uint32_t MaxPayloadSize = 1u << 30;
+
+	bool Send(Socket& socket, MessageType type, const void* payload, uint32_t size)
+	{
+		MessageHeader header = { type, size };
+		if (!socket.SendAll(&header, sizeof(header)))
+			return false;
+
+		return size == 0 || socket.SendAll(payload, size);
+	}
+
+	bool Send(Socket& socket, MessageType type, BinaryWriter& payload)
+	{
+		std::vector<uint8_t>& buffer = payload.GetBuffer();
+		return Send(socket, type, buffer.data(), (uint32_t)buffer.size());
+	}
+
+	bool Receive(Socket& socket, Message& message)
+	{
+		MessageHeader header;
+		if (!socket.ReceiveAll(&header, sizeof(header)) || header.Size > MaxPayloadSize)
+			return false;
+
+		message.Type = header.Type;
+		message.Payload.resize(header.Size);
+		return header.Size == 0 || socket.ReceiveAll(message.Payload.data(), header.Size);
+	}
+
+}
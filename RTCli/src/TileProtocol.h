@@ -0,0 +1,70 @@
+#pragma once
+
+#include "BinaryStream.h"
+#include "Renderer.h"
+#include "Socket.h"
+
+#include <cstdint>
+#include <vector>
+
+// Messages exchanged between the render coordinator and its workers.
+// Every message is a header followed by Size bytes of payload, values are sent in host byte order.
+namespace TileProtocol {
+
+	constexpr uint32_t Version = 3;
+
+	// Workers send a heartbeat this often, also while one tile or frame keeps them busy for minutes. Timeouts of the
+	// coordinator and the frame farm only have to cover a few of them, not the longest piece of work
+	constexpr uint32_t HeartbeatMilliseconds = 2000;
+
+	enum class MessageType : uint32_t
+	{
+		Hello = 0,      // Worker -> coordinator: Version, thread count
+		Job,            // Coordinator -> worker: image size, settings, camera and scene
+		TileRequest,    // Coordinator -> worker: region and sample range to trace
+		TileResult,     // Worker -> coordinator: the request followed by one sample sum per pixel
+		Shutdown,       // Coordinator -> worker: no more work
+		FrameRequest,   // Coordinator -> worker: frame number, output path and camera of a whole frame to render and save
+		FrameResult,    // Worker -> coordinator: frame number and whether the image was saved
+		Heartbeat       // Worker -> coordinator: no payload, the worker is alive
+	};
+
+	struct MessageHeader
+	{
+		MessageType Type;
+		uint32_t Size;
+	};
+
+	struct Hello
+	{
+		uint32_t ProtocolVersion = Version;
+		uint32_t ThreadCount = 0;
+		// Lets the coordinator find the process of a worker it started itself
+		uint32_t ProcessId = 0;
+	};
+
+	struct TileRequest
+	{
+		uint32_t TileId = 0;
+		Renderer::Tile Region{};
+		uint32_t FirstSample = 0;
+		uint32_t SampleCount = 0;
+	};
+
+	struct FrameResult
+	{
+		uint32_t FrameNumber = 0;
+		uint32_t Saved = 0;
+	};
+
+	struct Message
+	{
+		MessageType Type = MessageType::Shutdown;
+		std::vector<uint8_t> Payload;
+	};
+
+	bool Send(Socket& socket, MessageType type, const void* payload, uint32_t size);
+	bool Send(Socket& socket, MessageType type, BinaryWriter& payload);
+	bool Receive(Socket& socket, Message& message);
+
+}
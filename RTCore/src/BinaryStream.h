@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Appends plain values to a byte buffer, used for the wire protocol and the binary scene cache
+class BinaryWriter
+{
+public:
+	template<typename T>
+	void Write(const T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "BinaryWriter only writes trivially copyable types");
+		WriteBytes(&value, sizeof(T));
+	}
+
+	void WriteBytes(const void* data, size_t size)
+	{
+		const uint8_t* bytes = (const uint8_t*)data;
+		m_Buffer.insert(m_Buffer.end(), bytes, bytes + size);
+	}
+
+	std::vector<uint8_t>& GetBuffer() { return m_Buffer; }
+private:
+	std::vector<uint8_t> m_Buffer;
+};
+
+// Reads values back from a byte buffer, every read fails once the buffer is exhausted
+class BinaryReader
+{
+public:
+	BinaryReader(const void* data, size_t size)
+		: m_Data((const uint8_t*)data), m_Size(size)
+	{
+	}
+
+	template<typename T>
+	bool Read(T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "BinaryReader only reads trivially copyable types");
+		return ReadBytes(&value, sizeof(T));
+	}
+
+	bool ReadBytes(void* data, size_t size)
+	{
+		if (size > m_Size - m_Position)
+			return false;
+
+		memcpy(data, m_Data + m_Position, size);
+		m_Position += size;
+		return true;
+	}
+
+	size_t GetPosition() const { return m_Position; }
+	size_t GetRemaining() const { return m_Size - m_Position; }
+private:
+	const uint8_t* m_Data = nullptr;
+	size_t m_Size = 0;
+	size_t m_Position = 0;
+};
@@ -0,0 +1,84 @@
+#include "Camera.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+Camera::Camera(float verticalFOV, float nearClip, float farClip)
+	: m_VerticalFOV(verticalFOV), m_NearClip(nearClip), m_FarClip(farClip)
+{
+	m_ForwardDirection = glm::vec3(0, 0, -1);
+	m_Position = glm::vec3(0, 0, 9);
+}
+
+void Camera::OnResize(uint32_t width, uint32_t height)
+{
+	if (width == m_ViewportWidth && height == m_ViewportHeight)
+		return;
+
+	m_ViewportWidth = width;
+	m_ViewportHeight = height;
+
+	RecalculateProjection();
+	RecalculateRayDirections();
+}
+
+void Camera::SetPosition(const glm::vec3& position)
+{
+	m_Position = position;
+
+	RecalculateView();
+	RecalculateRayDirections();
+}
+
+void Camera::SetDirection(const glm::vec3& direction)
+{
+	m_ForwardDirection = glm::normalize(direction);
+
+	RecalculateView();
+	RecalculateRayDirections();
+}
+
+void Camera::SetView(const glm::vec3& position, const glm::vec3& direction)
+{
+	m_Position = position;
+	m_ForwardDirection = glm::normalize(direction);
+
+	RecalculateView();
+	RecalculateRayDirections();
+}
+
+void Camera::RecalculateProjection()
+{
+	m_Projection = glm::perspectiveFov(glm::radians(m_VerticalFOV), (float)m_ViewportWidth, (float)m_ViewportHeight, m_NearClip, m_FarClip);
+	m_InverseProjection = glm::inverse(m_Projection);
+}
+
+void Camera::RecalculateView()
+{
+	m_View = glm::lookAt(m_Position, m_Position + m_ForwardDirection, glm::vec3(0, 1, 0));
+	m_InverseView = glm::inverse(m_View);
+}
+
+glm::vec3 Camera::GetRayDirection(const glm::vec2& pixel) const
+{
+	return glm::normalize(m_PixelRayOrigin + m_PixelRayStepX * pixel.x + m_PixelRayStepY * pixel.y);
+}
+
+void Camera::RecalculateRayDirections()
+{
+	if (m_ViewportWidth == 0 || m_ViewportHeight == 0)
+		return;
+
+	// Before normalization the direction through a pixel is an affine function of its coordinates
+	auto unnormalizedDirection = [this](float x, float y)
+	{
+		glm::vec2 coord = { x / (float)m_ViewportWidth, y / (float)m_ViewportHeight };
+		coord = coord * 2.0f - 1.0f; // -1 -> 1
+
+		glm::vec4 target = m_InverseProjection * glm::vec4(coord.x, coord.y, 1, 1);
+		return glm::vec3(m_InverseView * glm::vec4(glm::vec3(target) / target.w, 0)); // World space
+	};
+
+	m_PixelRayOrigin = unnormalizedDirection(0.0f, 0.0f);
+	m_PixelRayStepX = unnormalizedDirection(1.0f, 0.0f) - m_PixelRayOrigin;
+	m_PixelRayStepY = unnormalizedDirection(0.0f, 1.0f) - m_PixelRayOrigin;
+}
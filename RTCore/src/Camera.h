@@ -1,14 +1,13 @@
 #pragma once
 
 #include <glm/glm.hpp>
-#include <vector>
 
+// Perspective camera math only, interactive navigation lives in the applications
 class Camera
 {
 public:
 	Camera(float verticalFOV, float nearClip, float farClip);
 
-	bool OnUpdate(float ts);
 	void OnResize(uint32_t width, uint32_t height);
 
 	const glm::mat4& GetProjection() const { return m_Projection; }
@@ -19,12 +18,20 @@ public:
 	const glm::vec3& GetPosition() const { return m_Position; }
 	const glm::vec3& GetDirection() const { return m_ForwardDirection; }
 
-	const std::vector<glm::vec3>& GetRayDirections() const { return m_RayDirections; }
+	void SetPosition(const glm::vec3& position);
+	void SetDirection(const glm::vec3& direction);
+	// Moves and turns the camera with a single recalculation of the ray directions
+	void SetView(const glm::vec3& position, const glm::vec3& direction);
 
-	float GetRotationSpeed();
-	
-	glm::vec3 upDirection;
-	glm::vec3 rightDirection;
+	float GetVerticalFOV() const { return m_VerticalFOV; }
+	float GetNearClip() const { return m_NearClip; }
+	float GetFarClip() const { return m_FarClip; }
+
+	uint32_t GetViewportWidth() const { return m_ViewportWidth; }
+	uint32_t GetViewportHeight() const { return m_ViewportHeight; }
+
+	// Direction through a point of the viewport in pixels
+	glm::vec3 GetRayDirection(const glm::vec2& pixel) const;
 private:
 	void RecalculateProjection();
 	void RecalculateView();
@@ -41,13 +48,11 @@ private:
 
 	glm::vec3 m_Position{0.0f, 0.0f, 0.0f};
 	glm::vec3 m_ForwardDirection{ 0.0f, 0.0f, 0.0f };
-	glm::vec3 m_UpDirection{ 0.0f, 0.0f, 0.0f };
-	glm::vec3 m_RightDirection{0.0f, 0.0f, 0.0f};
-
-	// Cached ray directions
-	std::vector<glm::vec3> m_RayDirections;
 
-	glm::vec2 m_LastMousePosition{ 0.0f, 0.0f };
+	// Unnormalized direction through pixel (x, y) is origin + x * stepX + y * stepY
+	glm::vec3 m_PixelRayOrigin{ 0.0f };
+	glm::vec3 m_PixelRayStepX{ 0.0f };
+	glm::vec3 m_PixelRayStepY{ 0.0f };
 
 	uint32_t m_ViewportWidth = 0, m_ViewportHeight = 0;
 };
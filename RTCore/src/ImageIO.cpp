@@ -0,0 +1,39 @@
+#include "ImageIO.h"
+
+#include "Profiler.h"
+#include "lodepng.h"
+
+#include <vector>
+
+namespace ImageIO {
+
+	bool SavePNG(const std::string& path, const uint32_t* pixels, uint32_t width, uint32_t height)
+	{
+		ProfileZone zone("SavePNG");
+
+		std::vector<uint8_t> pngBuffer((size_t)width * height * 4);
+
+		// PNG rows go top to bottom
+		for (uint32_t y = 0; y < height; y++)
+		{
+			uint32_t flippedY = height - y - 1;
+			for (uint32_t x = 0; x < width; x++)
+			{
+				uint32_t color = pixels[x + y * width];
+
+				size_t index = ((size_t)flippedY * width + x) * 4;
+				pngBuffer[index + 0] = color & 0xFF;
+				pngBuffer[index + 1] = (color >> 8) & 0xFF;
+				pngBuffer[index + 2] = (color >> 16) & 0xFF;
+				pngBuffer[index + 3] = (color >> 24) & 0xFF;
+			}
+		}
+
+		std::vector<uint8_t> imageBuffer;
+		if (lodepng::encode(imageBuffer, pngBuffer, width, height) != 0)
+			return false;
+
+		return lodepng::save_file(imageBuffer, path) == 0;
+	}
+
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace ImageIO {
+
+	// Writes packed RGBA8 pixels as the Renderer produces them (rows bottom to top) to a PNG file
+	bool SavePNG(const std::string& path, const uint32_t* pixels, uint32_t width, uint32_t height);
+
+}
@@ -0,0 +1,225 @@
+#include "Json.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+JsonParser::JsonParser(const std::string& text)
+	: m_Cursor(text.c_str()), m_End(text.c_str() + text.size())
+{
+}
+
+bool JsonParser::Parse(JsonValue& value)
+{
+	if (!ParseValue(value, 0))
+		return false;
+
+	SkipWhitespace();
+	if (m_Cursor != m_End)
+		return Fail("unexpected text after the document");
+
+	return true;
+}
+
+bool JsonParser::Fail(const char* message)
+{
+	m_Error = message;
+	return false;
+}
+
+void JsonParser::SkipWhitespace()
+{
+	while (m_Cursor != m_End && (*m_Cursor == ' ' || *m_Cursor == '\t' || *m_Cursor == '\r' || *m_Cursor == '\n'))
+	{
+		if (*m_Cursor == '\n')
+			m_Line++;
+		m_Cursor++;
+	}
+}
+
+bool JsonParser::Match(const char* literal)
+{
+	size_t length = strlen(literal);
+	if ((size_t)(m_End - m_Cursor) < length || strncmp(m_Cursor, literal, length) != 0)
+		return false;
+
+	m_Cursor += length;
+	return true;
+}
+
+bool JsonParser::ParseValue(JsonValue& value, int depth)
+{
+	if (depth > 32)
+		return Fail("nested too deeply");
+
+	SkipWhitespace();
+	if (m_Cursor == m_End)
+		return Fail("unexpected end of file");
+
+	value.Line = m_Line;
+	switch (*m_Cursor)
+	{
+	case '{':
+		return ParseObject(value, depth);
+	case '[':
+		return ParseArray(value, depth);
+	case '"':
+		value.ValueType = JsonValue::Type::String;
+		return ParseString(value.String);
+	}
+
+	if (Match("true"))
+	{
+		value.ValueType = JsonValue::Type::Bool;
+		value.Bool = true;
+		return true;
+	}
+	if (Match("false"))
+	{
+		value.ValueType = JsonValue::Type::Bool;
+		return true;
+	}
+	if (Match("null"))
+		return true;
+
+	// The text is null terminated, strtod stops there at the latest
+	char* end = nullptr;
+	value.Number = strtod(m_Cursor, &end);
+	if (end == m_Cursor)
+		return Fail("expected a value");
+
+	value.ValueType = JsonValue::Type::Number;
+	m_Cursor = end;
+	return true;
+}
+
+bool JsonParser::ParseString(std::string& string)
+{
+	m_Cursor++;
+	while (m_Cursor != m_End && *m_Cursor != '"')
+	{
+		char c = *m_Cursor++;
+		if (c == '\n')
+			return Fail("unterminated string");
+
+		if (c == '\\')
+		{
+			if (m_Cursor == m_End)
+				break;
+
+			c = *m_Cursor++;
+			switch (c)
+			{
+			case 'n': c = '\n'; break;
+			case 't': c = '\t'; break;
+			case 'r': c = '\r'; break;
+			case 'b': c = '\b'; break;
+			case 'f': c = '\f'; break;
+			case 'u':
+			{
+				// Names and types are plain ASCII, anything else only has to survive the parse
+				if (m_End - m_Cursor < 4)
+					return Fail("truncated escape sequence");
+
+				unsigned codePoint = (unsigned)strtoul(std::string(m_Cursor, 4).c_str(), nullptr, 16);
+				c = codePoint < 0x80 ? (char)codePoint : '?';
+				m_Cursor += 4;
+				break;
+			}
+			}
+		}
+
+		string += c;
+	}
+
+	if (m_Cursor == m_End)
+		return Fail("unterminated string");
+
+	m_Cursor++;
+	return true;
+}
+
+bool JsonParser::ParseArray(JsonValue& value, int depth)
+{
+	value.ValueType = JsonValue::Type::Array;
+	m_Cursor++;
+
+	SkipWhitespace();
+	if (Match("]"))
+		return true;
+
+	while (true)
+	{
+		if (!ParseValue(value.Elements.emplace_back(), depth + 1))
+			return false;
+
+		SkipWhitespace();
+		if (Match("]"))
+			return true;
+		if (!Match(","))
+			return Fail("expected ',' or ']'");
+	}
+}
+
+bool JsonParser::ParseObject(JsonValue& value, int depth)
+{
+	value.ValueType = JsonValue::Type::Object;
+	m_Cursor++;
+
+	SkipWhitespace();
+	if (Match("}"))
+		return true;
+
+	while (true)
+	{
+		SkipWhitespace();
+		if (m_Cursor == m_End || *m_Cursor != '"')
+			return Fail("expected a member name");
+
+		auto& member = value.Members.emplace_back();
+		if (!ParseString(member.first))
+			return false;
+
+		SkipWhitespace();
+		if (!Match(":"))
+			return Fail("expected ':'");
+
+		if (!ParseValue(member.second, depth + 1))
+			return false;
+
+		SkipWhitespace();
+		if (Match("}"))
+			return true;
+		if (!Match(","))
+			return Fail("expected ',' or '}'");
+	}
+}
+
+std::string EscapeJson(const std::string& text)
+{
+	std::string escaped;
+	escaped.reserve(text.size());
+	for (char c : text)
+	{
+		switch (c)
+		{
+		case '"':  escaped += "\\\""; break;
+		case '\\': escaped += "\\\\"; break;
+		case '\n': escaped += "\\n"; break;
+		case '\r': escaped += "\\r"; break;
+		case '\t': escaped += "\\t"; break;
+		default:
+			if ((unsigned char)c < 0x20)
+			{
+				char code[7];
+				snprintf(code, sizeof(code), "\\u%04x", (unsigned char)c);
+				escaped += code;
+			}
+			else
+			{
+				escaped += c;
+			}
+		}
+	}
+	return escaped;
+}
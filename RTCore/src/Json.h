@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Parsed JSON document, every value remembers the line it started on for error messages
+struct JsonValue
+{
+	enum class Type
+	{
+		Null, Bool, Number, String, Array, Object
+	};
+
+	Type ValueType = Type::Null;
+	bool Bool = false;
+	double Number = 0.0;
+	std::string String;
+	std::vector<JsonValue> Elements;
+	std::vector<std::pair<std::string, JsonValue>> Members;
+	int Line = 0;
+
+	const JsonValue* Find(const char* key) const
+	{
+		for (const auto& member : Members)
+		{
+			if (member.first == key)
+				return &member.second;
+		}
+		return nullptr;
+	}
+};
+
+// Small recursive descent parser for the scene files and benchmark baselines, not a validating one:
+// escapes outside ASCII come back as '?'
+class JsonParser
+{
+public:
+	explicit JsonParser(const std::string& text);
+
+	bool Parse(JsonValue& value);
+
+	const std::string& GetError() const { return m_Error; }
+	int GetLine() const { return m_Line; }
+private:
+	bool Fail(const char* message);
+	void SkipWhitespace();
+	bool Match(const char* literal);
+
+	bool ParseValue(JsonValue& value, int depth);
+	bool ParseString(std::string& string);
+	bool ParseArray(JsonValue& value, int depth);
+	bool ParseObject(JsonValue& value, int depth);
+private:
+	const char* m_Cursor = nullptr;
+	const char* m_End = nullptr;
+	int m_Line = 1;
+	std::string m_Error;
+};
+
+// Text as the inside of a JSON string, for the files written by hand with stream operators
+std::string EscapeJson(const std::string& text);
@@ -25,6 +25,11 @@ public:
 		return MaterialIndex;
 	}
 
+	virtual RTObject* Clone() const
+	{
+		return new RTObject(*this);
+	}
+
 	glm::vec3 Position = glm::vec3(0.0f);
 	int MaterialIndex = 0;
 	virtual ~RTObject() { }
@@ -70,6 +75,11 @@ public:
 		return MaterialIndex;
 	}
 
+	RTObject* Clone() const override
+	{
+		return new Sphere(*this);
+	}
+
 	glm::vec3 Position = glm::vec3(0.0f);
 	int MaterialIndex = 0;
 	float Radius = 1.0f;
@@ -133,6 +143,11 @@ public:
 		return MaterialIndex;
 	}
 
+	RTObject* Clone() const override
+	{
+		return new Cube(*this);
+	}
+
 	glm::vec3 Position = glm::vec3(0.0f);
 	int MaterialIndex = 0;
 	glm::vec3 Dimensions = glm::vec3(1.0f);
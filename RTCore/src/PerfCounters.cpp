@@ -0,0 +1,158 @@
+#include "PerfCounters.h"
+
+#if defined(__linux__) && defined(RT_PERF_COUNTERS)
+	#define RT_PERF_EVENT 1
+	#include <linux/perf_event.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+
+	#include <cerrno>
+	#include <cstring>
+#endif
+
+namespace Utils {
+#if defined(RT_PERF_EVENT)
+	static perf_event_attr MakeEventAttributes(PerfCounters::Event event)
+	{
+		perf_event_attr attributes;
+		memset(&attributes, 0, sizeof(attributes));
+		attributes.size = sizeof(attributes);
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+		attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		const uint64_t readMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		switch (event)
+		{
+		case PerfCounters::Event::Cycles:
+			attributes.type = PERF_TYPE_HARDWARE;
+			attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+			break;
+		case PerfCounters::Event::Instructions:
+			attributes.type = PERF_TYPE_HARDWARE;
+			attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+			break;
+		case PerfCounters::Event::L1DMisses:
+			attributes.type = PERF_TYPE_HW_CACHE;
+			attributes.config = PERF_COUNT_HW_CACHE_L1D | readMiss;
+			break;
+		case PerfCounters::Event::LLCMisses:
+			attributes.type = PERF_TYPE_HW_CACHE;
+			attributes.config = PERF_COUNT_HW_CACHE_LL | readMiss;
+			break;
+		case PerfCounters::Event::BranchMisses:
+			attributes.type = PERF_TYPE_HARDWARE;
+			attributes.config = PERF_COUNT_HW_BRANCH_MISSES;
+			break;
+		default:
+			break;
+		}
+		return attributes;
+	}
+#endif
+}
+
+PerfCounters::Values& PerfCounters::Values::operator+=(const Values& other)
+{
+	for (size_t i = 0; i < (size_t)Event::Count; i++)
+		Counts[i] += other.Counts[i];
+	return *this;
+}
+
+PerfCounters::Values PerfCounters::Values::operator-(const Values& other) const
+{
+	Values difference;
+	for (size_t i = 0; i < (size_t)Event::Count; i++)
+		difference.Counts[i] = Counts[i] - other.Counts[i];
+	return difference;
+}
+
+PerfCounters::PerfCounters()
+{
+	for (int& fd : m_EventFds)
+		fd = -1;
+
+#if defined(RT_PERF_EVENT)
+	// The first counter that opens leads the group, all of them are read together
+	int lastErrno = 0;
+	for (size_t i = 0; i < (size_t)Event::Count; i++)
+	{
+		perf_event_attr attributes = Utils::MakeEventAttributes((Event)i);
+		attributes.disabled = m_GroupFd < 0 ? 1 : 0;
+
+		int fd = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, m_GroupFd, 0);
+		if (fd < 0)
+		{
+			lastErrno = errno;
+			continue;
+		}
+
+		m_EventFds[i] = fd;
+		if (m_GroupFd < 0)
+			m_GroupFd = fd;
+	}
+
+	if (m_GroupFd < 0)
+	{
+		m_Error = std::string("perf_event_open failed: ") + strerror(lastErrno);
+		if (lastErrno == EACCES || lastErrno == EPERM)
+			m_Error += ", see /proc/sys/kernel/perf_event_paranoid";
+		return;
+	}
+
+	ioctl(m_GroupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(m_GroupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+	m_Error = "built without RT_PERF_COUNTERS or not on Linux";
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+#if defined(RT_PERF_EVENT)
+	for (int fd : m_EventFds)
+	{
+		if (fd >= 0)
+			close(fd);
+	}
+#endif
+}
+
+PerfCounters::Values PerfCounters::Read() const
+{
+	Values values;
+
+#if defined(RT_PERF_EVENT)
+	if (m_GroupFd < 0)
+		return values;
+
+	// Event count, time enabled, time running, then one value per open event in the order they were opened
+	uint64_t buffer[3 + (size_t)Event::Count];
+	if (read(m_GroupFd, buffer, sizeof(buffer)) < (ssize_t)(3 * sizeof(uint64_t)) || buffer[2] == 0)
+		return values;
+
+	double scale = (double)buffer[1] / (double)buffer[2];
+	size_t valueIndex = 0;
+	for (size_t i = 0; i < (size_t)Event::Count && valueIndex < buffer[0]; i++)
+	{
+		if (m_EventFds[i] >= 0)
+			values.Counts[i] = (uint64_t)((double)buffer[3 + valueIndex++] * scale);
+	}
+#endif
+
+	return values;
+}
+
+const char* PerfCounters::GetEventName(Event event)
+{
+	switch (event)
+	{
+	case Event::Cycles:       return "Cycles";
+	case Event::Instructions: return "Instructions";
+	case Event::L1DMisses:    return "L1DMisses";
+	case Event::LLCMisses:    return "LLCMisses";
+	case Event::BranchMisses: return "BranchMisses";
+	default:                  return "Unknown";
+	}
+}
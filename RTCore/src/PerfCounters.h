@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Hardware counters of the calling thread, read through Linux perf_event in user mode only. Built when RT_PERF_COUNTERS
+// is defined (premake --perf-counters), otherwise and on other systems nothing opens and every read returns zeros.
+// Counters the CPU or the kernel do not offer stay at zero, the rest keep working.
+class PerfCounters
+{
+public:
+	enum class Event
+	{
+		Cycles = 0,
+		Instructions,
+		L1DMisses,      // L1 data cache read misses
+		LLCMisses,      // Last level cache read misses
+		BranchMisses,
+		Count
+	};
+
+	struct Values
+	{
+		uint64_t Counts[(size_t)Event::Count] = {};
+
+		uint64_t& operator[](Event event) { return Counts[(size_t)event]; }
+		uint64_t operator[](Event event) const { return Counts[(size_t)event]; }
+
+		Values& operator+=(const Values& other);
+		Values operator-(const Values& other) const;
+	};
+public:
+	// Opens and starts the counters for the calling thread, they count only while it runs
+	PerfCounters();
+	~PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	bool IsAvailable() const { return m_GroupFd >= 0; }
+	bool IsEventAvailable(Event event) const { return m_EventFds[(size_t)event] >= 0; }
+	// Why nothing could be opened, empty if IsAvailable
+	const std::string& GetError() const { return m_Error; }
+
+	// Counts since construction, scaled up if the kernel had to multiplex the counters. One system call
+	Values Read() const;
+
+	static const char* GetEventName(Event event);
+private:
+	int m_GroupFd = -1;
+	int m_EventFds[(size_t)Event::Count];
+	std::string m_Error;
+};
@@ -0,0 +1,239 @@
+#include "Profiler.h"
+
+#include "Json.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace Utils {
+	static const std::chrono::steady_clock::time_point s_StartTime = std::chrono::steady_clock::now();
+
+	// A reader may copy a slot while its thread rewrites it, so every field is atomic. A copy mixing two zones is
+	// still possible, the reader finds out from Written afterwards and drops it. Fields are stored with release and
+	// loaded with acquire, a reader that sees a field of a newer zone then also sees Written moved up to that zone
+	struct ZoneSlot
+	{
+		std::atomic<const char*> Name{ nullptr };
+		std::atomic<uint64_t> Start{ 0 }, End{ 0 };
+		std::atomic<uint32_t> Depth{ 0 };
+
+		Profiler::Zone Load() const
+		{
+			Profiler::Zone zone;
+			zone.Name = Name.load(std::memory_order_acquire);
+			zone.Start = Start.load(std::memory_order_acquire);
+			zone.End = End.load(std::memory_order_acquire);
+			zone.Depth = Depth.load(std::memory_order_acquire);
+			return zone;
+		}
+	};
+
+	// Only its thread writes zones, readers copy them and check afterwards how far the writer got in the meantime
+	struct ZoneBuffer
+	{
+		uint32_t ThreadId = 0;
+		std::unique_ptr<ZoneSlot[]> Zones = std::make_unique<ZoneSlot[]>(Profiler::ZonesPerThread);
+		std::atomic<uint64_t> Written{ 0 };
+
+		// Guarded by s_BuffersMutex
+		std::string ThreadName;
+		bool InUse = true;
+		// Zones before this one belong to a thread that exited
+		uint64_t FirstZone = 0;
+	};
+
+	static std::mutex s_BuffersMutex;
+	// Buffers outlive their threads so their zones can still be exported, new threads take over those of exited ones
+	static std::vector<std::unique_ptr<ZoneBuffer>> s_Buffers;
+
+	static std::mutex s_FrameMutex;
+	static std::deque<uint64_t> s_FrameMarks;
+	static constexpr size_t MaxFrameMarks = 64;
+
+	static ZoneBuffer* AcquireBuffer()
+	{
+		std::lock_guard<std::mutex> lock(s_BuffersMutex);
+		for (std::unique_ptr<ZoneBuffer>& buffer : s_Buffers)
+		{
+			if (buffer->InUse)
+				continue;
+
+			buffer->InUse = true;
+			buffer->FirstZone = buffer->Written.load(std::memory_order_relaxed);
+			buffer->ThreadName = "Thread " + std::to_string(buffer->ThreadId);
+			return buffer.get();
+		}
+
+		ZoneBuffer* buffer = s_Buffers.emplace_back(std::make_unique<ZoneBuffer>()).get();
+		buffer->ThreadId = (uint32_t)s_Buffers.size() - 1;
+		buffer->ThreadName = "Thread " + std::to_string(buffer->ThreadId);
+		return buffer;
+	}
+
+	class ThreadState
+	{
+	public:
+		~ThreadState()
+		{
+			if (!m_Buffer)
+				return;
+
+			std::lock_guard<std::mutex> lock(s_BuffersMutex);
+			m_Buffer->InUse = false;
+		}
+
+		ZoneBuffer& GetBuffer()
+		{
+			if (!m_Buffer)
+				m_Buffer = AcquireBuffer();
+			return *m_Buffer;
+		}
+
+		uint32_t Depth = 0;
+	private:
+		ZoneBuffer* m_Buffer = nullptr;
+	};
+
+	static thread_local ThreadState s_ThreadState;
+}
+
+void Profiler::SetThreadName(const std::string& name)
+{
+	Utils::ZoneBuffer& buffer = Utils::s_ThreadState.GetBuffer();
+
+	std::lock_guard<std::mutex> lock(Utils::s_BuffersMutex);
+	buffer.ThreadName = name;
+}
+
+void Profiler::MarkFrame()
+{
+	uint64_t time = GetTime();
+
+	std::lock_guard<std::mutex> lock(Utils::s_FrameMutex);
+	Utils::s_FrameMarks.push_back(time);
+	if (Utils::s_FrameMarks.size() > Utils::MaxFrameMarks)
+		Utils::s_FrameMarks.pop_front();
+}
+
+std::vector<uint64_t> Profiler::GetFrameMarks()
+{
+	std::lock_guard<std::mutex> lock(Utils::s_FrameMutex);
+	return std::vector<uint64_t>(Utils::s_FrameMarks.begin(), Utils::s_FrameMarks.end());
+}
+
+uint64_t Profiler::GetTime()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Utils::s_StartTime).count();
+}
+
+uint64_t Profiler::BeginZone()
+{
+	Utils::s_ThreadState.Depth++;
+	return GetTime();
+}
+
+void Profiler::EndZone(const char* name, uint64_t start)
+{
+	uint64_t end = GetTime();
+
+	Utils::ThreadState& state = Utils::s_ThreadState;
+	state.Depth--;
+
+	Utils::ZoneBuffer& buffer = state.GetBuffer();
+	uint64_t index = buffer.Written.load(std::memory_order_relaxed);
+
+	Utils::ZoneSlot& slot = buffer.Zones[index % ZonesPerThread];
+	slot.Name.store(name, std::memory_order_release);
+	slot.Start.store(start, std::memory_order_release);
+	slot.End.store(end, std::memory_order_release);
+	slot.Depth.store(state.Depth, std::memory_order_release);
+
+	buffer.Written.store(index + 1, std::memory_order_release);
+}
+
+std::vector<Profiler::ThreadZones> Profiler::Capture(uint64_t since)
+{
+	std::vector<ThreadZones> threads;
+	std::vector<Zone> copied;
+
+	std::lock_guard<std::mutex> lock(Utils::s_BuffersMutex);
+	for (const std::unique_ptr<Utils::ZoneBuffer>& buffer : Utils::s_Buffers)
+	{
+		uint64_t written = buffer->Written.load(std::memory_order_acquire);
+		uint64_t first = std::max(buffer->FirstZone, written > ZonesPerThread ? written - ZonesPerThread : 0);
+
+		// Zones are stored in the order they ended, so the ones ending before since are all at the front
+		uint64_t begin = written;
+		while (begin > first && buffer->Zones[(begin - 1) % ZonesPerThread].End.load(std::memory_order_relaxed) >= since)
+			begin--;
+
+		copied.clear();
+		for (uint64_t index = begin; index < written; index++)
+			copied.push_back(buffer->Zones[index % ZonesPerThread].Load());
+
+		// Slots the writer reached during the copy hold newer zones than the ones expected there, and the slot after
+		// the last published zone may be half written
+		uint64_t writtenAfter = buffer->Written.load(std::memory_order_relaxed);
+		uint64_t firstIntact = writtenAfter + 1 > ZonesPerThread ? writtenAfter + 1 - ZonesPerThread : 0;
+
+		ThreadZones& thread = threads.emplace_back();
+		thread.ThreadId = buffer->ThreadId;
+		thread.ThreadName = buffer->ThreadName;
+
+		for (uint64_t index = std::max(begin, firstIntact); index < written; index++)
+			thread.Zones.push_back(copied[index - begin]);
+	}
+
+	return threads;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path, std::string& error)
+{
+	std::vector<ThreadZones> threads = Capture();
+
+	std::ofstream file(path, std::ios::trunc);
+	if (!file)
+	{
+		error = "could not open " + path;
+		return false;
+	}
+
+	// Complete events with microsecond times, one thread per lane
+	file << "{\n";
+	file << "\t\"displayTimeUnit\": \"ms\",\n";
+	file << "\t\"traceEvents\": [";
+
+	bool first = true;
+	char line[512];
+	for (const ThreadZones& thread : threads)
+	{
+		if (thread.Zones.empty())
+			continue;
+
+		file << (first ? "\n" : ",\n") << "\t\t{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread.ThreadId
+			<< ", \"args\": { \"name\": \"" << EscapeJson(thread.ThreadName) << "\" } }";
+		first = false;
+
+		for (const Zone& zone : thread.Zones)
+		{
+			snprintf(line, sizeof(line), ",\n\t\t{ \"name\": \"%s\", \"cat\": \"RT\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %u }",
+				EscapeJson(zone.Name).c_str(), zone.Start / 1000.0, (zone.End - zone.Start) / 1000.0, thread.ThreadId);
+			file << line;
+		}
+	}
+
+	file << (first ? "]\n" : "\n\t]\n");
+	file << "}\n";
+
+	if (!file)
+	{
+		error = "could not write " + path;
+		return false;
+	}
+	return true;
+}
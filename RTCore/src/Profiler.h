@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scoped timing zones, to see stalls and imbalance between threads on any machine without external tools.
+// Every thread records into a ring buffer of its own without taking locks, once it is full the oldest zones are
+// overwritten. Recording is off until enabled, a disabled zone costs one relaxed load, an enabled one two clock reads.
+class Profiler
+{
+public:
+	struct Zone
+	{
+		// Zones keep the pointer only, names have to be string literals
+		const char* Name = nullptr;
+		// Nanoseconds since the profiler started
+		uint64_t Start = 0, End = 0;
+		// Zones open on the same thread around this one
+		uint32_t Depth = 0;
+	};
+
+	struct ThreadZones
+	{
+		uint32_t ThreadId = 0;
+		std::string ThreadName;
+		// In the order they ended, children before their parents
+		std::vector<Zone> Zones;
+	};
+
+	static constexpr uint32_t ZonesPerThread = 1 << 15;
+public:
+	static void SetEnabled(bool enabled) { s_Enabled.store(enabled, std::memory_order_relaxed); }
+	static bool IsEnabled() { return s_Enabled.load(std::memory_order_relaxed); }
+
+	// Lane name of the calling thread in traces and the flame view
+	static void SetThreadName(const std::string& name);
+
+	// Called once per UI frame, the flame view shows the zones between the last few marks
+	static void MarkFrame();
+	// Up to the last 64 marks, oldest first
+	static std::vector<uint64_t> GetFrameMarks();
+
+	static uint64_t GetTime();
+
+	// Copies the zones still held by every thread's buffer that end at or after since. Threads keep recording meanwhile,
+	// zones they overwrite during the copy are left out
+	static std::vector<ThreadZones> Capture(uint64_t since = 0);
+
+	// Chrome trace event JSON, opens in ui.perfetto.dev and chrome://tracing
+	static bool WriteChromeTrace(const std::string& path, std::string& error);
+
+	// Used by ProfileZone
+	static uint64_t BeginZone();
+	static void EndZone(const char* name, uint64_t start);
+private:
+	inline static std::atomic<bool> s_Enabled{ false };
+};
+
+// Records the time from construction to destruction as a zone of the calling thread, if the profiler is enabled
+class ProfileZone
+{
+public:
+	explicit ProfileZone(const char* name)
+		: m_Name(name), m_Active(Profiler::IsEnabled())
+	{
+		if (m_Active)
+			m_Start = Profiler::BeginZone();
+	}
+
+	~ProfileZone()
+	{
+		if (m_Active)
+			Profiler::EndZone(m_Name, m_Start);
+	}
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+private:
+	const char* m_Name;
+	uint64_t m_Start = 0;
+	bool m_Active;
+};
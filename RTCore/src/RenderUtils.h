@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <limits>
+
+// Small kernels the path tracer runs for every sample, kept inline in a header so benchmarks can time them on their own
+namespace Utils {
+	inline uint32_t ConvertToRGBA(const glm::vec4& color)
+	{
+		uint8_t r = (uint8_t)(color.r * 255.0f);
+		uint8_t g = (uint8_t)(color.g * 255.0f);
+		uint8_t b = (uint8_t)(color.b * 255.0f);
+		uint8_t a = (uint8_t)(color.a * 255.0f);
+
+		uint32_t result = (a << 24) | (b << 16) | (g << 8) | r;
+		return result;
+	}
+	
+	inline uint32_t PCG_Hash(uint32_t input)
+	{
+		uint32_t state = input * 747796405u + 2891336453u;
+		uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+		return (word >> 22u) ^ word;
+	}
+
+	inline float RandomFloat(uint32_t& seed)
+	{
+		seed = PCG_Hash(seed);
+		float toReturn = (float)seed / (float)std::numeric_limits<uint32_t>::max();
+		return toReturn;
+	}
+
+	inline glm::vec3 InUnitSphere(uint32_t& seed)
+	{
+		return glm::normalize(glm::vec3(RandomFloat(seed) * 2.0f - 1.0f,
+										RandomFloat(seed) * 2.0f - 1.0f,
+										RandomFloat(seed) * 2.0f - 1.0f));
+	}
+
+	inline glm::vec3 Refract(glm::vec3 rayDirection, glm::vec3 normal, float ior)
+	{
+		ior = 2.0f - ior;
+		float cosi = glm::dot(normal, rayDirection);
+		glm::vec3 o = (rayDirection * ior - normal * (-cosi + ior * cosi));
+		return o;
+	}
+}
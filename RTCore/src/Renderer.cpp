@@ -0,0 +1,1121 @@
+#include "Renderer.h"
+
+#include "Object.h"
+#include "Profiler.h"
+#include "RenderUtils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+# define M_PI           3.14159265358979323846
+
+namespace Utils {
+	// Rays traced by this thread, handed over to the renderer once per tile so tracing never touches shared counters
+	static thread_local uint64_t s_PrimaryRays = 0;
+	static thread_local uint64_t s_TracedRays = 0;
+
+	class RayCountScope
+	{
+	public:
+		RayCountScope(std::atomic<uint64_t>& primaryRays, std::atomic<uint64_t>& totalRays)
+			: m_PrimaryRays(primaryRays), m_TotalRays(totalRays), m_FirstPrimary(s_PrimaryRays), m_FirstTraced(s_TracedRays)
+		{
+		}
+
+		~RayCountScope()
+		{
+			m_PrimaryRays.fetch_add(s_PrimaryRays - m_FirstPrimary, std::memory_order_relaxed);
+			m_TotalRays.fetch_add(s_TracedRays - m_FirstTraced, std::memory_order_relaxed);
+		}
+	private:
+		std::atomic<uint64_t>& m_PrimaryRays;
+		std::atomic<uint64_t>& m_TotalRays;
+		uint64_t m_FirstPrimary, m_FirstTraced;
+	};
+
+	// Opened by every thread the first time it traces a phased tile and kept for the life of the thread
+	static thread_local std::unique_ptr<PerfCounters> s_PerfCounters;
+
+	// Charges the time and counters since the last switch to the phase that ran, handed over to the renderer once per tile
+	class PhaseRecorder
+	{
+	public:
+		PhaseRecorder(std::mutex& mutex, Renderer::PhaseCounters& totals)
+			: m_Mutex(mutex), m_Totals(totals)
+		{
+			if (!s_PerfCounters)
+				s_PerfCounters = std::make_unique<PerfCounters>();
+
+			m_LastTime = std::chrono::steady_clock::now();
+			m_LastValues = s_PerfCounters->Read();
+		}
+
+		~PhaseRecorder()
+		{
+			Switch(m_Phase);
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			for (size_t i = 0; i < (size_t)Renderer::RenderPhase::Count; i++)
+			{
+				m_Totals.Seconds[i] += m_Seconds[i];
+				m_Totals.Counters[i] += m_Counters[i];
+			}
+
+			if (s_PerfCounters->IsAvailable())
+				m_Totals.HasHardwareCounters = true;
+			else if (m_Totals.CounterError.empty())
+				m_Totals.CounterError = s_PerfCounters->GetError();
+		}
+
+		void Switch(Renderer::RenderPhase phase)
+		{
+			auto time = std::chrono::steady_clock::now();
+			PerfCounters::Values values = s_PerfCounters->Read();
+
+			m_Seconds[(size_t)m_Phase] += std::chrono::duration<double>(time - m_LastTime).count();
+			m_Counters[(size_t)m_Phase] += values - m_LastValues;
+
+			m_LastTime = time;
+			m_LastValues = values;
+			m_Phase = phase;
+		}
+	private:
+		std::mutex& m_Mutex;
+		Renderer::PhaseCounters& m_Totals;
+
+		Renderer::RenderPhase m_Phase = Renderer::RenderPhase::RayGeneration;
+		std::chrono::steady_clock::time_point m_LastTime;
+		PerfCounters::Values m_LastValues;
+
+		double m_Seconds[(size_t)Renderer::RenderPhase::Count] = {};
+		PerfCounters::Values m_Counters[(size_t)Renderer::RenderPhase::Count];
+	};
+
+	static float Lerp(float a, float b, float f)
+	{
+		return a + f * (b - a);
+	}
+
+	static glm::vec3 Lerp3(const glm::vec3& a, const glm::vec3& b, float t) {
+		t = glm::clamp(t, 0.0f, 1.0f); // Ensure t is clamped between 0 and 1
+		return a + t * (b - a);
+	}
+
+	// Position of (x, y) along a Hilbert curve filling an n * n grid, n has to be a power of two
+	static uint32_t HilbertIndex(uint32_t n, uint32_t x, uint32_t y)
+	{
+		uint32_t index = 0;
+		for (uint32_t s = n / 2; s > 0; s /= 2)
+		{
+			uint32_t rx = (x & s) > 0;
+			uint32_t ry = (y & s) > 0;
+			index += s * s * ((3 * rx) ^ ry);
+
+			// Rotate the quadrant so the curve stays continuous
+			if (ry == 0)
+			{
+				if (rx == 1)
+				{
+					x = n - 1 - x;
+					y = n - 1 - y;
+				}
+				std::swap(x, y);
+			}
+		}
+		return index;
+	}
+
+	static uint32_t MortonIndex(uint32_t x, uint32_t y)
+	{
+		uint32_t index = 0;
+		for (uint32_t bit = 0; bit < 16; bit++)
+		{
+			index |= ((x >> bit) & 1u) << (2 * bit);
+			index |= ((y >> bit) & 1u) << (2 * bit + 1);
+		}
+		return index;
+	}
+
+	// Point sampleIndex of the R2 sequence, rotated by a per pixel offset so neighbouring pixels do not share a pattern.
+	// Any run of consecutive points is spread evenly over the unit square, whatever the sample count.
+	// Computed in 32 bit fixed point, wrapping around is taking the fraction, so late samples keep their full precision
+	static glm::vec2 PixelSamplePoint(uint32_t pixelIndex, uint32_t sampleIndex)
+	{
+		uint32_t rotationX = PCG_Hash(pixelIndex);
+		uint32_t rotationY = PCG_Hash(rotationX);
+
+		// 2^32 times 0.7548776662 and 0.5698402910
+		uint32_t x = rotationX + sampleIndex * 3242174889u;
+		uint32_t y = rotationY + sampleIndex * 2447445414u;
+
+		// The top 24 bits fit a float exactly, so the point stays below 1
+		return glm::vec2((float)(x >> 8), (float)(y >> 8)) * (1.0f / 16777216.0f);
+	}
+
+	static float BlackmanHarris(float t)
+	{
+		const float pi = 3.14159265f;
+		return 0.35875f - 0.48829f * cosf(2.0f * pi * t) + 0.14128f * cosf(4.0f * pi * t) - 0.01168f * cosf(6.0f * pi * t);
+	}
+
+	// Maps u in [0, 1) to an offset from the pixel center distributed like the filter, so every sample weighs the same
+	static float SampleFilter(Renderer::PixelFilter filter, float u)
+	{
+		switch (filter)
+		{
+			case Renderer::PixelFilter::Box:
+				return u - 0.5f;
+			case Renderer::PixelFilter::Tent:
+				return u < 0.5f ? sqrtf(2.0f * u) - 1.0f : 1.0f - sqrtf(2.0f - 2.0f * u);
+			case Renderer::PixelFilter::BlackmanHarris:
+			{
+				// No closed form inverse, the CDF is tabulated once and inverted by linear interpolation
+				constexpr int TableSize = 256;
+				constexpr float Radius = 1.5f;
+				static const std::vector<float> s_CDF = []()
+				{
+					std::vector<float> cdf(TableSize + 1, 0.0f);
+					for (int i = 0; i < TableSize; i++)
+						cdf[i + 1] = cdf[i] + BlackmanHarris(((float)i + 0.5f) / (float)TableSize);
+					for (float& value : cdf)
+						value /= cdf[TableSize];
+					return cdf;
+				}();
+
+				int index = (int)(std::upper_bound(s_CDF.begin(), s_CDF.end(), u) - s_CDF.begin()) - 1;
+				index = glm::clamp(index, 0, TableSize - 1);
+				float t = (u - s_CDF[index]) / glm::max(s_CDF[index + 1] - s_CDF[index], 1e-8f);
+				return (((float)index + t) / (float)TableSize * 2.0f - 1.0f) * Radius;
+			}
+		}
+		return 0.0f;
+	}
+
+	static glm::vec2 RandomPointInCircle(uint32_t seed)
+	{
+		float angle = RandomFloat(seed) * 2 * M_PI;
+		glm::vec2 pointOnCircle = glm::vec2(cos(angle), sin(angle));
+		return pointOnCircle * sqrt(RandomFloat(seed));
+	}
+}
+
+Renderer::Renderer()
+{
+}
+
+Renderer::~Renderer()
+{
+	delete[] m_ImageData;
+	delete[] m_AccumulationData;
+}
+
+int Renderer::GetFrameIndex() 
+{
+	return m_FrameIndex;
+}
+
+uint32_t Renderer::GetPixelAt(int x, int y)
+{
+	return m_ImageData[x + y * m_Width];
+}
+
+bool Renderer::DoesImageExist()
+{
+	return m_HasImageData;
+}
+
+void Renderer::OnResize(uint32_t width, uint32_t height)
+{
+	// No resize necessary
+	if (m_ImageData && m_Width == width && m_Height == height)
+		return;
+
+	ResetImage(width, height);
+}
+
+void Renderer::ResetImage(uint32_t width, uint32_t height)
+{
+	ProfileZone zone("ResetImage");
+
+	m_Width = width;
+	m_Height = height;
+
+	delete[] m_ImageData;
+	m_ImageData = new uint32_t[width * height];
+
+	delete[] m_AccumulationData;
+	m_AccumulationData = new glm::vec4[width * height];
+
+	RebuildTiles(width, height);
+
+	// Fresh buffers hold no samples yet
+	m_FrameIndex = 1;
+	m_RefinementStride = 0;
+	m_HasFullImage = false;
+	m_HasImageData = false;
+}
+
+bool Renderer::Render(const Scene& scene, const Camera& camera)
+{
+	ProfileZone zone("Render");
+
+	Tile cropRegion = GetCropRegion();
+	bool useCrop = m_HasFullImage && cropRegion.MinX < cropRegion.MaxX && cropRegion.MinY < cropRegion.MaxY;
+
+	// Pixels outside the window keep the samples of the last full frame while it is in use, whenever the window
+	// changes the accumulation starts over
+	bool cropMoved = cropRegion.MinX != m_CropRegion.MinX || cropRegion.MinY != m_CropRegion.MinY ||
+		cropRegion.MaxX != m_CropRegion.MaxX || cropRegion.MaxY != m_CropRegion.MaxY;
+	if (useCrop != m_CropActive || (useCrop && cropMoved))
+	{
+		m_FrameIndex = 1;
+		m_RefinementStride = 0;
+	}
+
+	m_CropActive = useCrop;
+	m_CropRegion = cropRegion;
+
+	if (m_CropActive)
+		return RenderCrop(scene, camera);
+
+	if (IsRefinementPending())
+		return RenderRefinementPass(scene, camera);
+
+	if (m_Settings.FrameBudget > 0.0f && m_Settings.Accumulate)
+		return RenderBudgeted(scene, camera);
+
+	if (!RenderSamples(scene, camera, 1))
+		return false;
+
+	if (!m_Settings.Accumulate)
+		m_FrameIndex = 1;
+
+	return true;
+}
+
+bool Renderer::RenderSamples(const Scene& scene, const Camera& camera, uint32_t sampleCount)
+{
+	ProfileZone zone("RenderSamples");
+
+	BeginFrame(scene, camera);
+
+	if (m_TileTimingEnabled)
+		m_TileSeconds.assign(m_Tiles.size(), 0.0f);
+
+	// Tiles are handed out in the same order every frame, so each one keeps returning to the same worker.
+	// Along a space filling curve every worker's chunk is a compact region, and chunks of neighbouring workers touch
+	m_ThreadPool->ParallelFor((uint32_t)m_Tiles.size(),
+		[this, sampleCount](uint32_t tileIndex)
+		{
+			if (!m_TileTimingEnabled)
+			{
+				RenderTile(m_Tiles[tileIndex], m_FrameIndex, sampleCount);
+				return;
+			}
+
+			auto startTime = std::chrono::steady_clock::now();
+			RenderTile(m_Tiles[tileIndex], m_FrameIndex, sampleCount);
+			m_TileSeconds[tileIndex] = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+		});
+
+	if (m_FrameGeneration.load(std::memory_order_relaxed) != m_ActiveGeneration)
+	{
+		// Part of the image already holds samples of the cancelled frame
+		m_FrameIndex = 1;
+		return false;
+	}
+
+	m_FrameIndex += sampleCount;
+	m_SampleIndex += sampleCount * GetPrimaryRaysPerSample();
+	m_HasFullImage = true;
+	return true;
+}
+
+bool Renderer::RenderCrop(const Scene& scene, const Camera& camera)
+{
+	ProfileZone zone("RenderCrop");
+
+	BeginFrame(scene, camera);
+
+	m_CropTiles.clear();
+	for (const Tile& tile : m_Tiles)
+	{
+		Tile clipped;
+		clipped.MinX = glm::max(tile.MinX, m_CropRegion.MinX);
+		clipped.MinY = glm::max(tile.MinY, m_CropRegion.MinY);
+		clipped.MaxX = glm::min(tile.MaxX, m_CropRegion.MaxX);
+		clipped.MaxY = glm::min(tile.MaxY, m_CropRegion.MaxY);
+
+		if (clipped.MinX < clipped.MaxX && clipped.MinY < clipped.MaxY)
+			m_CropTiles.push_back(clipped);
+	}
+
+	uint32_t sampleCount = (uint32_t)glm::max(m_Settings.CropSamplesPerFrame, 1);
+	m_ThreadPool->ParallelFor((uint32_t)m_CropTiles.size(),
+		[this, sampleCount](uint32_t tileIndex)
+		{
+			RenderTile(m_CropTiles[tileIndex], m_FrameIndex, sampleCount);
+		});
+
+	if (m_FrameGeneration.load(std::memory_order_relaxed) != m_ActiveGeneration)
+	{
+		m_FrameIndex = 1;
+		return false;
+	}
+
+	m_FrameIndex += sampleCount;
+	m_SampleIndex += sampleCount * GetPrimaryRaysPerSample();
+	return true;
+}
+
+Renderer::Tile Renderer::GetCropRegion() const
+{
+	if (!m_Settings.UseCropWindow)
+		return { 0, 0, 0, 0 };
+
+	glm::vec2 cropMin = glm::clamp(glm::min(m_Settings.CropMin, m_Settings.CropMax), glm::vec2(0.0f), glm::vec2(1.0f));
+	glm::vec2 cropMax = glm::clamp(glm::max(m_Settings.CropMin, m_Settings.CropMax), glm::vec2(0.0f), glm::vec2(1.0f));
+
+	Tile region;
+	region.MinX = (uint32_t)floorf(cropMin.x * (float)m_Width);
+	region.MinY = (uint32_t)floorf(cropMin.y * (float)m_Height);
+	region.MaxX = (uint32_t)ceilf(cropMax.x * (float)m_Width);
+	region.MaxY = (uint32_t)ceilf(cropMax.y * (float)m_Height);
+	return region;
+}
+
+bool Renderer::RenderBudgeted(const Scene& scene, const Camera& camera)
+{
+	ProfileZone zone("RenderBudgeted");
+
+	BeginFrame(scene, camera);
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		std::chrono::duration<float, std::milli>(m_Settings.FrameBudget));
+
+	// Ticket t stands for tile t % tileCount in pass t / tileCount. Passes follow each other without a barrier, a worker
+	// that runs out of tiles of one pass goes on with the next, so nobody waits for the slowest tile before the deadline
+	uint32_t tileCount = (uint32_t)m_Tiles.size();
+	std::atomic<uint32_t> nextTicket{ 0 };
+	std::atomic<uint32_t> passCount{ 1 };
+	// Passes over a tile run in ticket order, a slow tile may still be busy when the next pass comes around to it.
+	// On a first frame pass 0 clears the accumulation and would wipe the sample of a later pass that got ahead of it
+	std::vector<std::atomic<uint32_t>> nextPass(tileCount);
+	m_TilePasses.assign(tileCount, 0);
+
+	m_ThreadPool->ParallelFor(m_ThreadPool->GetThreadCount() + 1,
+		[&](uint32_t)
+		{
+			while (m_FrameGeneration.load(std::memory_order_relaxed) == m_ActiveGeneration)
+			{
+				// The first pass always finishes, every pixel gets at least one sample per frame
+				uint32_t ticket = nextTicket.fetch_add(1, std::memory_order_relaxed);
+				bool late = ticket >= tileCount && std::chrono::steady_clock::now() >= deadline;
+
+				// Every earlier ticket of the tile is held by a running worker, so the wait ends. A late ticket still
+				// takes its turn, later tickets of the tile may have been handed out before the deadline
+				uint32_t pass = ticket / tileCount;
+				uint32_t tileIndex = ticket % tileCount;
+				while (nextPass[tileIndex].load(std::memory_order_acquire) != pass)
+					std::this_thread::yield();
+
+				if (!late)
+				{
+					RenderTile(m_Tiles[tileIndex], m_FrameIndex + pass, 1);
+					m_TilePasses[tileIndex]++;
+				}
+				nextPass[tileIndex].store(pass + 1, std::memory_order_release);
+
+				if (late)
+					return;
+
+				uint32_t passes = passCount.load(std::memory_order_relaxed);
+				while (passes < pass + 1 && !passCount.compare_exchange_weak(passes, pass + 1, std::memory_order_relaxed))
+				{
+				}
+			}
+		});
+
+	if (m_FrameGeneration.load(std::memory_order_relaxed) != m_ActiveGeneration)
+	{
+		m_FrameIndex = 1;
+		return false;
+	}
+
+	// Every pixel counts its own samples in alpha, a pass that did not reach all tiles needs no correction.
+	// Its frame index and jitter points are used up all the same, so the next frame does not repeat them
+	uint32_t passes = passCount.load(std::memory_order_relaxed);
+	m_FrameIndex += passes;
+	m_SampleIndex += passes * GetPrimaryRaysPerSample();
+	m_HasFullImage = true;
+	return true;
+}
+
+bool Renderer::IsRefinementPending() const
+{
+	return m_Settings.ProgressiveRefinement && m_Settings.Accumulate && m_FrameIndex == 1;
+}
+
+bool Renderer::RenderRefinementPass(const Scene& scene, const Camera& camera)
+{
+	ProfileZone zone("RefinementPass");
+
+	if (m_RefinementStride == 0)
+		m_RefinementStride = RefinementStartStride;
+
+	BeginFrame(scene, camera);
+
+	uint32_t stride = m_RefinementStride;
+	m_ThreadPool->ParallelFor((uint32_t)m_Tiles.size(),
+		[this, stride](uint32_t tileIndex)
+		{
+			RenderRefinementTile(m_Tiles[tileIndex], stride);
+		});
+
+	// Coarse passes stretch every traced pixel over its block, which may reach into neighbouring tiles, so this
+	// runs once all of them are traced
+	if (stride > 1)
+	{
+		m_ThreadPool->ParallelFor((uint32_t)m_Tiles.size(),
+			[this, stride](uint32_t tileIndex)
+			{
+				FillRefinementTile(m_Tiles[tileIndex], stride);
+			});
+	}
+
+	if (m_FrameGeneration.load(std::memory_order_relaxed) != m_ActiveGeneration)
+	{
+		m_RefinementStride = 0;
+		m_FrameIndex = 1;
+		return false;
+	}
+
+	// After the last pass every pixel holds exactly one sample, as after a regular first frame
+	m_RefinementStride /= 2;
+	if (m_RefinementStride == 0)
+	{
+		m_FrameIndex = 2;
+		m_SampleIndex = GetPrimaryRaysPerSample();
+		m_HasFullImage = true;
+	}
+
+	return true;
+}
+
+void Renderer::BeginFrame(const Scene& scene, const Camera& camera)
+{
+	m_HasImageData = true;
+	m_ActiveGeneration = m_FrameGeneration.load(std::memory_order_relaxed);
+
+	m_ActiveScene = &scene;
+	m_ActiveCamera = &camera;
+
+	// Every way of restarting the accumulation only resets the frame index
+	if (m_FrameIndex == 1)
+		m_SampleIndex = 0;
+
+	UpdateThreadPool();
+
+	if (m_TileSize != m_Settings.TileSize || m_TileOrder != m_Settings.Order)
+		RebuildTiles(m_Width, m_Height);
+}
+
+void Renderer::RenderRegion(const Scene& scene, const Camera& camera, const Tile& region, uint32_t firstSample, uint32_t sampleCount, glm::vec4* sums)
+{
+	ProfileZone zone("RenderRegion");
+
+	m_ActiveScene = &scene;
+	m_ActiveCamera = &camera;
+
+	UpdateThreadPool();
+
+	uint32_t regionWidth = region.MaxX - region.MinX;
+	uint32_t primaryRays = GetPrimaryRaysPerSample();
+	m_ThreadPool->ParallelFor(region.MaxY - region.MinY,
+		[&](uint32_t row)
+		{
+			ProfileZone rowZone("RegionRow");
+			Utils::RayCountScope rayCounts(m_PrimaryRays, m_TotalRays);
+
+			uint32_t y = region.MinY + row;
+			for (uint32_t x = region.MinX; x < region.MaxX; x++)
+			{
+				glm::vec4 sum = glm::vec4(0.0f);
+				for (uint32_t sample = firstSample; sample < firstSample + sampleCount; sample++)
+					sum += SamplePixel(x, y, sample + 1, sample * primaryRays);
+
+				sums[(x - region.MinX) + row * regionWidth] = sum;
+			}
+		});
+}
+
+void Renderer::ResolveSums(const glm::vec4* sums, size_t pixelCount, uint32_t* pixels)
+{
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		glm::vec4 color = sums[i] / glm::max(sums[i].a, 1.0f);
+		color = glm::clamp(color, glm::vec4(0.0f), glm::vec4(1.0f));
+		pixels[i] = Utils::ConvertToRGBA(color);
+	}
+}
+
+Renderer::RayCounts Renderer::GetRayCounts() const
+{
+	RayCounts counts;
+	counts.PrimaryRays = m_PrimaryRays.load(std::memory_order_relaxed);
+	counts.TotalRays = m_TotalRays.load(std::memory_order_relaxed);
+	return counts;
+}
+
+void Renderer::ResetRayCounts()
+{
+	m_PrimaryRays.store(0, std::memory_order_relaxed);
+	m_TotalRays.store(0, std::memory_order_relaxed);
+}
+
+Renderer::PhaseCounters Renderer::GetPhaseCounters() const
+{
+	std::lock_guard<std::mutex> lock(m_PhaseMutex);
+	return m_PhaseCounters;
+}
+
+void Renderer::ResetPhaseCounters()
+{
+	std::lock_guard<std::mutex> lock(m_PhaseMutex);
+	m_PhaseCounters = PhaseCounters();
+}
+
+const char* Renderer::GetPhaseName(RenderPhase phase)
+{
+	switch (phase)
+	{
+	case RenderPhase::RayGeneration: return "RayGeneration";
+	case RenderPhase::Trace:         return "Trace";
+	case RenderPhase::Shade:         return "Shade";
+	case RenderPhase::Accumulate:    return "Accumulate";
+	case RenderPhase::Resolve:       return "Resolve";
+	default:                         return "Unknown";
+	}
+}
+
+const char* Renderer::GetTileOrderName(TileOrder order)
+{
+	switch (order)
+	{
+	case TileOrder::Scanline: return "Scanline";
+	case TileOrder::Morton:   return "Morton";
+	case TileOrder::Hilbert:  return "Hilbert";
+	default:                  return "Unknown";
+	}
+}
+
+void Renderer::SetThreadPool(std::shared_ptr<ThreadPool> threadPool)
+{
+	m_ThreadPool = std::move(threadPool);
+	m_HasSharedThreadPool = m_ThreadPool != nullptr;
+}
+
+void Renderer::UpdateThreadPool()
+{
+	if (m_HasSharedThreadPool)
+		return;
+
+	if (m_ThreadPool && m_ThreadCount == m_Settings.ThreadCount && m_PinThreads == m_Settings.PinThreads)
+		return;
+
+	m_ThreadCount = glm::max(m_Settings.ThreadCount, 0);
+	m_PinThreads = m_Settings.PinThreads;
+
+	m_ThreadPool.reset();
+	m_ThreadPool = std::make_unique<ThreadPool>((uint32_t)m_ThreadCount, m_PinThreads);
+}
+
+void Renderer::RebuildTiles(uint32_t width, uint32_t height)
+{
+	m_TileSize = glm::max(m_Settings.TileSize, 1);
+	m_TileOrder = m_Settings.Order;
+
+	uint32_t tilesX = (width + m_TileSize - 1) / m_TileSize;
+	uint32_t tilesY = (height + m_TileSize - 1) / m_TileSize;
+
+	uint32_t gridSize = 1;
+	while (gridSize < tilesX || gridSize < tilesY)
+		gridSize *= 2;
+
+	std::vector<std::pair<uint32_t, Tile>> orderedTiles;
+	orderedTiles.reserve(tilesX * tilesY);
+
+	for (uint32_t tileY = 0; tileY < tilesY; tileY++)
+	{
+		for (uint32_t tileX = 0; tileX < tilesX; tileX++)
+		{
+			Tile tile;
+			tile.MinX = tileX * m_TileSize;
+			tile.MinY = tileY * m_TileSize;
+			tile.MaxX = glm::min(tile.MinX + m_TileSize, width);
+			tile.MaxY = glm::min(tile.MinY + m_TileSize, height);
+
+			uint32_t key = tileX + tileY * tilesX;
+			if (m_TileOrder == TileOrder::Morton)
+				key = Utils::MortonIndex(tileX, tileY);
+			else if (m_TileOrder == TileOrder::Hilbert)
+				key = Utils::HilbertIndex(gridSize, tileX, tileY);
+
+			orderedTiles.push_back({ key, tile });
+		}
+	}
+
+	std::sort(orderedTiles.begin(), orderedTiles.end(),
+		[](const std::pair<uint32_t, Tile>& a, const std::pair<uint32_t, Tile>& b) { return a.first < b.first; });
+
+	m_Tiles.clear();
+	for (const std::pair<uint32_t, Tile>& orderedTile : orderedTiles)
+		m_Tiles.push_back(orderedTile.second);
+}
+
+void Renderer::RenderTile(const Tile& tile, uint32_t firstFrameIndex, uint32_t sampleCount)
+{
+	ProfileZone zone("Tile");
+
+	if (m_PhaseCountersEnabled && !m_Settings.SplitPrimaryPaths && !m_Settings.DisplayNormals)
+	{
+		RenderTilePhased(tile, firstFrameIndex, sampleCount);
+		return;
+	}
+
+	uint32_t lastFrameIndex = firstFrameIndex + sampleCount - 1;
+	uint32_t firstSampleIndex = GetFirstSampleIndex(firstFrameIndex);
+	uint32_t primaryRays = GetPrimaryRaysPerSample();
+	Utils::RayCountScope rayCounts(m_PrimaryRays, m_TotalRays);
+
+	// Accumulation holds sums of path colors with the amount of paths in alpha, so the rays per pixel may change
+	// between frames without restarting the accumulation
+	for (uint32_t y = tile.MinY; y < tile.MaxY; y++)
+	{
+		for (uint32_t x = tile.MinX; x < tile.MaxX; x++)
+		{
+			if (m_FrameGeneration.load(std::memory_order_relaxed) != m_ActiveGeneration)
+				return;
+
+			// Clearing here instead of up front means the worker owning the tile touches its memory first
+			if (firstFrameIndex == 1)
+				m_AccumulationData[x + y * m_Width] = glm::vec4(0.0f);
+
+			glm::vec4 color = SamplePixel(x, y, firstFrameIndex, firstSampleIndex);
+			for (uint32_t frameIndex = firstFrameIndex + 1; frameIndex <= lastFrameIndex; frameIndex++)
+				color += SamplePixel(x, y, frameIndex, firstSampleIndex + (frameIndex - firstFrameIndex) * primaryRays);
+
+			m_AccumulationData[x + y * m_Width] = m_AccumulationData[x + y * m_Width] + color;
+
+			glm::vec4 accumulatedColor = m_AccumulationData[x + y * m_Width];
+			accumulatedColor = accumulatedColor / accumulatedColor.a;
+
+			accumulatedColor = glm::clamp(accumulatedColor, glm::vec4(0.0f), glm::vec4(1.0f));
+			m_ImageData[x + y * m_Width] = Utils::ConvertToRGBA(accumulatedColor);
+		}
+	}
+}
+
+void Renderer::RenderTilePhased(const Tile& tile, uint32_t firstFrameIndex, uint32_t sampleCount)
+{
+	Utils::RayCountScope rayCounts(m_PrimaryRays, m_TotalRays);
+
+	uint32_t tileWidth = tile.MaxX - tile.MinX;
+	uint32_t pixelCount = tileWidth * (tile.MaxY - tile.MinY);
+	uint32_t width = m_ActiveCamera->GetViewportWidth();
+	int raysPerPixel = glm::max(m_Settings.RaysPerPixel, 1);
+	uint32_t firstSampleIndex = GetFirstSampleIndex(firstFrameIndex);
+
+	// One path per pixel in flight, holding what TracePath keeps on its stack. Every path sees the same seeds and
+	// operations in the same order as in SamplePixel, so the image matches the one of RenderTile bit for bit
+	struct PathStates
+	{
+		std::vector<Ray> Rays;
+		std::vector<HitInfo> Hits;
+		std::vector<uint32_t> Seeds;
+		std::vector<glm::vec3> RayColors, IncomingLight;
+		std::vector<uint8_t> Active;
+		std::vector<glm::vec4> FrameColors, Colors;
+	};
+
+	// Kept by the thread for its next tiles, allocating and first touching them would be charged to the phases
+	static thread_local PathStates s_Paths;
+	std::vector<Ray>& rays = s_Paths.Rays;
+	std::vector<HitInfo>& hits = s_Paths.Hits;
+	std::vector<uint32_t>& seeds = s_Paths.Seeds;
+	std::vector<glm::vec3>& rayColors = s_Paths.RayColors;
+	std::vector<glm::vec3>& incomingLight = s_Paths.IncomingLight;
+	std::vector<uint8_t>& active = s_Paths.Active;
+	std::vector<glm::vec4>& frameColors = s_Paths.FrameColors;
+	std::vector<glm::vec4>& colors = s_Paths.Colors;
+
+	rays.resize(pixelCount);
+	hits.resize(pixelCount);
+	seeds.resize(pixelCount);
+	rayColors.resize(pixelCount);
+	incomingLight.resize(pixelCount);
+	active.resize(pixelCount);
+	frameColors.resize(pixelCount);
+	colors.assign(pixelCount, glm::vec4(0.0f));
+
+	Utils::PhaseRecorder phases(m_PhaseMutex, m_PhaseCounters);
+
+	for (uint32_t frameIndex = firstFrameIndex; frameIndex < firstFrameIndex + sampleCount; frameIndex++)
+	{
+		std::fill(frameColors.begin(), frameColors.end(), glm::vec4(0.0f));
+
+		for (int pixelRay = 0; pixelRay < raysPerPixel; pixelRay++)
+		{
+			if (m_FrameGeneration.load(std::memory_order_relaxed) != m_ActiveGeneration)
+				return;
+
+			phases.Switch(RenderPhase::RayGeneration);
+			for (uint32_t i = 0; i < pixelCount; i++)
+			{
+				uint32_t x = tile.MinX + i % tileWidth;
+				uint32_t y = tile.MinY + i / tileWidth;
+
+				uint32_t seed = x + y * width + m_Settings.Seed * 0x9E3779B9u;
+				seed *= frameIndex * (pixelRay * pixelRay + 293123);
+				seeds[i] = seed;
+
+				rays[i].Origin = m_ActiveCamera->GetPosition();
+				rays[i].Direction = GetPrimaryRayDirection(x, y, firstSampleIndex + (frameIndex - firstFrameIndex) * raysPerPixel + pixelRay);
+				rayColors[i] = glm::vec3(1.0f);
+				incomingLight[i] = glm::vec3(0.0f);
+				active[i] = 1;
+			}
+			Utils::s_PrimaryRays += pixelCount;
+
+			for (int bounce = 0; bounce <= m_Settings.LightBounces; bounce++)
+			{
+				phases.Switch(RenderPhase::Trace);
+				for (uint32_t i = 0; i < pixelCount; i++)
+				{
+					if (active[i])
+						hits[i] = TraceRay(rays[i]);
+				}
+
+				phases.Switch(RenderPhase::Shade);
+				bool anyActive = false;
+				for (uint32_t i = 0; i < pixelCount; i++)
+				{
+					if (!active[i])
+						continue;
+
+					if (hits[i].HitDistance > 0.0f)
+						active[i] = ScatterRay(rays[i], hits[i], seeds[i], rayColors[i], incomingLight[i]);
+					else
+					{
+						incomingLight[i] += m_ActiveScene->SkyColor * rayColors[i];
+						active[i] = 0;
+					}
+					anyActive |= active[i] != 0;
+				}
+
+				if (!anyActive)
+					break;
+			}
+
+			phases.Switch(RenderPhase::Accumulate);
+			for (uint32_t i = 0; i < pixelCount; i++)
+				frameColors[i] += glm::vec4(incomingLight[i], 1.0f);
+		}
+
+		for (uint32_t i = 0; i < pixelCount; i++)
+			colors[i] += frameColors[i];
+	}
+
+	if (m_FrameGeneration.load(std::memory_order_relaxed) != m_ActiveGeneration)
+		return;
+
+	phases.Switch(RenderPhase::Accumulate);
+	for (uint32_t i = 0; i < pixelCount; i++)
+	{
+		uint32_t index = (tile.MinX + i % tileWidth) + (tile.MinY + i / tileWidth) * m_Width;
+		if (firstFrameIndex == 1)
+			m_AccumulationData[index] = glm::vec4(0.0f);
+
+		m_AccumulationData[index] = m_AccumulationData[index] + colors[i];
+	}
+
+	phases.Switch(RenderPhase::Resolve);
+	for (uint32_t i = 0; i < pixelCount; i++)
+	{
+		uint32_t index = (tile.MinX + i % tileWidth) + (tile.MinY + i / tileWidth) * m_Width;
+
+		glm::vec4 accumulatedColor = m_AccumulationData[index];
+		accumulatedColor = accumulatedColor / accumulatedColor.a;
+
+		accumulatedColor = glm::clamp(accumulatedColor, glm::vec4(0.0f), glm::vec4(1.0f));
+		m_ImageData[index] = Utils::ConvertToRGBA(accumulatedColor);
+	}
+}
+
+void Renderer::RenderRefinementTile(const Tile& tile, uint32_t stride)
+{
+	ProfileZone zone("RefinementTile");
+	Utils::RayCountScope rayCounts(m_PrimaryRays, m_TotalRays);
+
+	for (uint32_t y = tile.MinY; y < tile.MaxY; y++)
+	{
+		for (uint32_t x = tile.MinX; x < tile.MaxX; x++)
+		{
+			if (m_FrameGeneration.load(std::memory_order_relaxed) != m_ActiveGeneration)
+				return;
+
+			uint32_t index = x + y * m_Width;
+
+			// The first pass touches the whole tile first, as a regular first frame would
+			if (stride == RefinementStartStride)
+				m_AccumulationData[index] = glm::vec4(0.0f);
+
+			// Pixels on the grid of this pass that were not on the grid of the previous one
+			bool onGrid = x % stride == 0 && y % stride == 0;
+			bool onCoarserGrid = stride < RefinementStartStride && x % (stride * 2) == 0 && y % (stride * 2) == 0;
+			if (onGrid && !onCoarserGrid)
+				m_AccumulationData[index] += SamplePixel(x, y, 1, 0);
+
+			if (stride == 1)
+			{
+				glm::vec4 accumulatedColor = m_AccumulationData[index] / m_AccumulationData[index].a;
+				accumulatedColor = glm::clamp(accumulatedColor, glm::vec4(0.0f), glm::vec4(1.0f));
+				m_ImageData[index] = Utils::ConvertToRGBA(accumulatedColor);
+			}
+		}
+	}
+}
+
+void Renderer::FillRefinementTile(const Tile& tile, uint32_t stride)
+{
+	ProfileZone zone("FillTile");
+
+	for (uint32_t y = tile.MinY; y < tile.MaxY; y++)
+	{
+		for (uint32_t x = tile.MinX; x < tile.MaxX; x++)
+		{
+			if (m_FrameGeneration.load(std::memory_order_relaxed) != m_ActiveGeneration)
+				return;
+
+			// Nearest traced pixel, the top left corner of the block
+			const glm::vec4& sum = m_AccumulationData[(x - x % stride) + (y - y % stride) * m_Width];
+
+			glm::vec4 accumulatedColor = sum / sum.a;
+			accumulatedColor = glm::clamp(accumulatedColor, glm::vec4(0.0f), glm::vec4(1.0f));
+			m_ImageData[x + y * m_Width] = Utils::ConvertToRGBA(accumulatedColor);
+		}
+	}
+}
+
+uint32_t Renderer::GetPrimaryRaysPerSample() const
+{
+	return m_Settings.SplitPrimaryPaths ? 1 : (uint32_t)glm::max(m_Settings.RaysPerPixel, 1);
+}
+
+uint32_t Renderer::GetFirstSampleIndex(uint32_t frameIndex) const
+{
+	return m_SampleIndex + (frameIndex - m_FrameIndex) * GetPrimaryRaysPerSample();
+}
+
+glm::vec4 Renderer::SamplePixel(uint32_t x, uint32_t y, uint32_t frameIndex, uint32_t sampleIndex)
+{
+	uint32_t width = m_ActiveCamera->GetViewportWidth();
+	int raysPerPixel = glm::max(m_Settings.RaysPerPixel, 1);
+	uint32_t pixelSeed = x + y * width + m_Settings.Seed * 0x9E3779B9u;
+
+	if (m_Settings.SplitPrimaryPaths)
+	{
+		Utils::s_PrimaryRays++;
+
+		Ray ray;
+		ray.Origin = m_ActiveCamera->GetPosition();
+		ray.Direction = GetPrimaryRayDirection(x, y, sampleIndex);
+
+		return PerPixelSplit(ray, pixelSeed, frameIndex, raysPerPixel);
+	}
+
+	Utils::s_PrimaryRays += raysPerPixel;
+
+	glm::vec4 color = glm::vec4(0.0f);
+	for (int pixelRay = 0; pixelRay < raysPerPixel; pixelRay++)
+	{
+		uint32_t seed = pixelSeed;
+		seed *= frameIndex * (pixelRay * pixelRay + 293123);
+
+		Ray ray;
+		ray.Origin = m_ActiveCamera->GetPosition();
+		ray.Direction = GetPrimaryRayDirection(x, y, sampleIndex + pixelRay);
+
+		color += PerPixel(ray, seed, x, y);
+	}
+
+	return color;
+}
+
+glm::vec3 Renderer::GetPrimaryRayDirection(uint32_t x, uint32_t y, uint32_t sampleIndex) const
+{
+	uint32_t pixelIndex = x + y * m_ActiveCamera->GetViewportWidth() + m_Settings.Seed * 0x9E3779B9u;
+	glm::vec2 point = Utils::PixelSamplePoint(pixelIndex, sampleIndex);
+
+	glm::vec2 offset = { Utils::SampleFilter(m_Settings.Filter, point.x), Utils::SampleFilter(m_Settings.Filter, point.y) };
+	return m_ActiveCamera->GetRayDirection(glm::vec2((float)x + 0.5f, (float)y + 0.5f) + offset);
+}
+
+glm::vec4 Renderer::PerPixel(Ray ray, uint32_t seed, uint32_t x, uint32_t y)
+{
+	return glm::vec4(TracePath(ray, seed, glm::vec3(1.0f), 0), 1.0f);
+}
+
+glm::vec4 Renderer::PerPixelSplit(const Ray& primaryRay, uint32_t pixelIndex, uint32_t frameIndex, int pathCount)
+{
+	// Counted as pathCount paths either way, otherwise edge pixels would weigh the frames that hit less than those that miss
+	Renderer::HitInfo primaryHit = TraceRay(primaryRay);
+	if (primaryHit.HitDistance <= 0.0f)
+		return glm::vec4(m_ActiveScene->SkyColor, 1.0f) * (float)pathCount;
+
+	if (m_Settings.DisplayNormals)
+		return glm::vec4(primaryHit.HitNormal, 1.0f) * (float)pathCount;
+
+	// Every path starts at the shared primary hit with its own seed and contributes an equal share
+	glm::vec3 incomingLight = glm::vec3(0.0f);
+	for (int path = 0; path < pathCount; path++)
+	{
+		uint32_t seed = pixelIndex;
+		seed *= frameIndex * (path * path + 293123);
+
+		Ray ray = primaryRay;
+		glm::vec3 rayColor = glm::vec3(1.0f);
+		glm::vec3 pathLight = glm::vec3(0.0f);
+		if (ScatterRay(ray, primaryHit, seed, rayColor, pathLight))
+			pathLight += TracePath(ray, seed, rayColor, 1);
+
+		incomingLight += pathLight;
+	}
+
+	return glm::vec4(incomingLight, (float)pathCount);
+}
+
+glm::vec3 Renderer::TracePath(Ray& ray, uint32_t& seed, glm::vec3 rayColor, int firstBounce)
+{
+	glm::vec3 incomingLight = glm::vec3(0.0f);
+	
+	// PerPixel function inspired from Sebastian Lague's Raytracing implementation: https://github.com/SebLague/Ray-Tracing
+
+	for (int i = firstBounce; i <= m_Settings.LightBounces; i++)
+	{
+		Renderer::HitInfo hitInfo = TraceRay(ray);
+
+		if (hitInfo.HitDistance > 0.0f)
+		{
+			if (m_Settings.DisplayNormals)
+				return hitInfo.HitNormal;
+
+			if (!ScatterRay(ray, hitInfo, seed, rayColor, incomingLight))
+				break;
+		}
+		else 
+		{
+			incomingLight += m_ActiveScene->SkyColor * rayColor;
+			break;
+		}
+	}
+
+	return incomingLight;
+}
+
+bool Renderer::ScatterRay(Ray& ray, const HitInfo& hitInfo, uint32_t& seed, glm::vec3& rayColor, glm::vec3& incomingLight)
+{
+	const Material& material = m_ActiveScene->Materials[m_ActiveScene->SceneObjects[hitInfo.ObjectIndex]->GetMaterialIndex()];
+
+	glm::vec3 materialColor = material.Color;
+
+	ray.Origin = hitInfo.HitPosition;
+
+	glm::vec3 difuseDir = glm::normalize(hitInfo.HitNormal + Utils::InUnitSphere(seed));
+	glm::vec3 specularDir = reflect(ray.Direction, hitInfo.HitNormal);
+	
+	bool isRefractiveBounce = material.Transmission >= Utils::RandomFloat(seed);
+	bool isSpecularBounce = material.Metallness >= Utils::RandomFloat(seed);
+
+	ray.Direction = Utils::Lerp3(glm::normalize(Utils::Lerp3(difuseDir, specularDir, material.Smoothness * isSpecularBounce)),
+								glm::normalize(Utils::Lerp3(
+									Utils::Refract(ray.Direction + Utils::InUnitSphere(seed), hitInfo.HitNormal, material.IOR),
+									Utils::Refract(ray.Direction, hitInfo.HitNormal, material.IOR),
+									material.Smoothness)), isRefractiveBounce);
+	
+	glm::vec3 emittedLight = material.EmissionColor * material.EmissionPower;
+	incomingLight += emittedLight * rayColor;
+	//rayColor *= Utils::Lerp3(material.Color, material.SpecularColor, isSpecularBounce);
+	rayColor *= materialColor;
+
+	// Early exit if ray is too weak
+	float p = glm::max(rayColor.r, glm::max(rayColor.g, rayColor.b));
+	if (Utils::RandomFloat(seed) >= p) {
+		return false;
+	}
+	rayColor *= 1.0f / p;
+	return true;
+}
+
+Renderer::HitInfo Renderer::Miss(const Ray& ray)
+{
+	Renderer::HitInfo payload;
+	payload.HitDistance = -1.0f;
+	return payload;
+}
+
+Renderer::HitInfo Renderer::TraceRay(const Ray& ray)
+{
+	Utils::s_TracedRays++;
+
+	Renderer::HitInfo payload;
+
+	int closestObj = -1;
+
+	float hitDistance = std::numeric_limits<float>::max();
+	float exitDistance = std::numeric_limits<float>::max();
+	
+
+	for (size_t i = 0; i < m_ActiveScene->SceneObjects.size(); i++)
+	{
+		if (m_ActiveScene->SceneObjects[i] == nullptr) continue;
+
+		glm::vec2 data = m_ActiveScene->SceneObjects[i]->Intersection(ray);
+
+		float closestT = data.x;
+		float t0 = data.y;
+
+		if (closestT == INT16_MIN)
+			continue;
+
+		if (closestT > 0.0f && closestT < hitDistance)
+		{
+			hitDistance = closestT;
+			exitDistance = t0;
+			closestObj = (int)i;
+		}
+	}
+
+	if (closestObj < 0) return Miss(ray);
+
+	return ClosestHit(ray, hitDistance, exitDistance, closestObj);
+}
+
+Renderer::HitInfo Renderer::ClosestHit(const Ray& ray, float hitDistance, float exitDistane, int objectIndex)
+{
+	Renderer::HitInfo payload;
+	payload.HitDistance = hitDistance;
+	payload.ExitDistance = exitDistane;
+	payload.ObjectIndex = objectIndex;
+
+	RTObject* closestObj = m_ActiveScene->SceneObjects[objectIndex];
+
+	glm::vec3 origin = ray.Origin - m_ActiveScene->SceneObjects[objectIndex]->GetPosition();
+	payload.HitPosition = origin + ray.Direction * hitDistance;
+	payload.HitNormal = m_ActiveScene->SceneObjects[objectIndex]->Normal(payload.HitPosition);
+
+	payload.HitPosition += m_ActiveScene->SceneObjects[objectIndex]->GetPosition();
+
+	return payload;
+}
\ No newline at end of file
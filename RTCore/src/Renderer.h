@@ -0,0 +1,271 @@
+#ifndef RENDERER_H
+
+#define RENDERER_H
+
+#include "Camera.h"
+#include "PerfCounters.h"
+#include "Ray.h"
+#include "Scene.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <glm/glm.hpp>
+
+class Renderer
+{
+
+public:
+	// Reconstruction filter, pixel samples are distributed according to it
+	enum class PixelFilter
+	{
+		Box = 0,        // Radius 0.5
+		Tent,           // Radius 1
+		BlackmanHarris  // Radius 1.5
+	};
+
+	enum class TileOrder
+	{
+		Scanline = 0,
+		Morton,
+		Hilbert
+	};
+
+	// Pixel rectangle [MinX, MaxX) x [MinY, MaxY)
+	struct Tile
+	{
+		uint32_t MinX, MinY;
+		uint32_t MaxX, MaxY;
+	};
+
+	struct Settings 
+	{
+		bool DisplayNormals = false;
+		
+		bool Accumulate = true;
+		bool SlowRandom = false;
+
+		int LightBounces = 5;
+		int RaysPerPixel = 1;
+		PixelFilter Filter = PixelFilter::BlackmanHarris;
+		// Offsets the random sequences of every pixel, the same seed always renders the same image
+		uint32_t Seed = 0;
+
+		// Traces the primary ray once per pixel and frame and splits it into RaysPerPixel paths at the first hit
+		bool SplitPrimaryPaths = false;
+
+		// The first accumulated frame is drawn in three passes at 1/16, 1/4 and full pixel density, see Render
+		bool ProgressiveRefinement = true;
+		// Milliseconds an accumulated frame keeps adding sample passes over the tiles, 0 traces a single pass.
+		// The first pass always completes, later ones stop wherever the deadline hits
+		float FrameBudget = 0.0f;
+
+		// Only the pixels inside the crop window are traced, everything outside keeps showing the last full image.
+		// Corners are in normalized image coordinates with y up, moving them restarts accumulation
+		bool UseCropWindow = false;
+		glm::vec2 CropMin{ 0.0f };
+		glm::vec2 CropMax{ 1.0f };
+		int CropSamplesPerFrame = 8;
+
+		int TileSize = 16;
+		TileOrder Order = TileOrder::Hilbert;
+
+		// 0 picks the thread count from the hardware
+		int ThreadCount = 0;
+		bool PinThreads = false;
+	};
+public:
+	Renderer();
+	~Renderer();
+
+	void ResetImage(uint32_t width, uint32_t height);
+	void OnResize(uint32_t width, uint32_t height);
+	// Returns false if the frame was cancelled before it finished.
+	// With progressive refinement the first frame after a reset takes three calls, each one returning a complete image:
+	// every 4th pixel in both directions stretched over its block, then every 2nd, then the rest. Every pixel is traced
+	// once over the three passes, so together they cost one regular frame.
+	bool Render(const Scene& scene, const Camera& camera);
+	// True if the next Render call draws a refinement pass instead of a full frame
+	bool IsRefinementPending() const;
+	// Adds sampleCount samples per pixel to the accumulation in a single dispatch and resolves the image once at the end.
+	// Every pixel sums its samples locally, so a cancelled batch leaves no pixel with part of them.
+	bool RenderSamples(const Scene& scene, const Camera& camera, uint32_t sampleCount);
+
+	// Safe to call from any thread. Tiles of the frame in flight stop at the next pixel, its samples are dropped
+	// and accumulation starts over with the next frame.
+	void CancelFrame() { m_FrameGeneration.fetch_add(1, std::memory_order_relaxed); }
+
+	// Traces samples [firstSample, firstSample + sampleCount) for the pixels of region and writes their per pixel sums
+	// to sums, row by row, with the amount of paths traced in alpha. Sample n uses the seeds of frame n + 1 in Render, the renderer's own image is left alone.
+	void RenderRegion(const Scene& scene, const Camera& camera, const Tile& region, uint32_t firstSample, uint32_t sampleCount, glm::vec4* sums);
+	// Averages sample sums into RGBA8 pixels the way Render resolves its accumulation
+	static void ResolveSums(const glm::vec4* sums, size_t pixelCount, uint32_t* pixels);
+	int GetFrameIndex();
+
+	uint32_t GetPixelAt(int x, int y);
+	bool DoesImageExist();
+	
+	// RGBA8 result of the last rendered frame, rows bottom to top
+	const uint32_t* GetImageData() const { return m_ImageData; }
+	uint32_t GetWidth() const { return m_Width; }
+	uint32_t GetHeight() const { return m_Height; }
+
+	// The image is stale afterwards, a crop window waits for the next full frame before it takes over again
+	void ResetFrameIndex() { m_FrameIndex = 1; m_RefinementStride = 0; m_HasFullImage = false; }
+	Settings& GetSettings() { return m_Settings; }
+
+	struct RayCounts
+	{
+		uint64_t PrimaryRays = 0;
+		// Every ray cast into the scene, primary rays included
+		uint64_t TotalRays = 0;
+	};
+
+	// Rays traced since the last reset, by every way of rendering
+	RayCounts GetRayCounts() const;
+	void ResetRayCounts();
+
+	// Records how long every tile of a RenderSamples call took. The tile list is in dispatch order and the same for every
+	// frame until the size or tile settings change
+	void SetTileTimingEnabled(bool enabled) { m_TileTimingEnabled = enabled; }
+	const std::vector<Tile>& GetTiles() const { return m_Tiles; }
+	// Seconds per tile of the last RenderSamples call, in the order of GetTiles
+	const std::vector<float>& GetTileSeconds() const { return m_TileSeconds; }
+	// Sample passes every tile got in the last frame with a budget, in the order of GetTiles
+	const std::vector<uint32_t>& GetTilePasses() const { return m_TilePasses; }
+	// Per pixel sums of the accumulated samples with their count in alpha, rows bottom to top
+	const glm::vec4* GetAccumulationData() const { return m_AccumulationData; }
+
+	// Stages of tracing a tile, as told apart by the phase counters
+	enum class RenderPhase
+	{
+		RayGeneration = 0, // Seeds and jittered primary rays
+		Trace,             // Closest hits against every object
+		Shade,             // Material lookup, scattering and emission
+		Accumulate,        // Summing samples into the accumulation
+		Resolve,           // Averaging into RGBA8 pixels
+		Count
+	};
+
+	struct PhaseCounters
+	{
+		// Summed over all threads
+		double Seconds[(size_t)RenderPhase::Count] = {};
+		PerfCounters::Values Counters[(size_t)RenderPhase::Count];
+		// False if no thread could open hardware counters, the times are recorded either way
+		bool HasHardwareCounters = false;
+		std::string CounterError;
+	};
+
+	// While enabled, tiles of Render and RenderSamples are traced phase by phase instead of path by path: the primary rays
+	// of all pixels, then every bounce as one pass of closest hits and one of scattering, then accumulation and resolve.
+	// Time and hardware counters are read only when the phase changes, a few dozen times per tile. The image stays the
+	// same, the speed is not the one of the regular path. Refinement passes, split primary paths and normals are not counted
+	void SetPhaseCountersEnabled(bool enabled) { m_PhaseCountersEnabled = enabled; }
+	PhaseCounters GetPhaseCounters() const;
+	void ResetPhaseCounters();
+	static const char* GetPhaseName(RenderPhase phase);
+	static const char* GetTileOrderName(TileOrder order);
+
+	// Renders on a pool shared with other renderers, which may render at the same time. ThreadCount and PinThreads
+	// are ignored while one is set, nullptr goes back to a pool of the renderer's own
+	void SetThreadPool(std::shared_ptr<ThreadPool> threadPool);
+private:
+	struct HitInfo
+	{
+		float HitDistance;
+		float ExitDistance;
+		glm::vec3 HitPosition;
+		glm::vec3 HitNormal;
+
+		int ObjectIndex;
+	};
+
+	void BeginFrame(const Scene& scene, const Camera& camera);
+	bool RenderRefinementPass(const Scene& scene, const Camera& camera);
+	bool RenderBudgeted(const Scene& scene, const Camera& camera);
+	bool RenderCrop(const Scene& scene, const Camera& camera);
+	// Crop window in pixels, empty if there is none
+	Tile GetCropRegion() const;
+	void RenderRefinementTile(const Tile& tile, uint32_t stride);
+	void FillRefinementTile(const Tile& tile, uint32_t stride);
+
+	void UpdateThreadPool();
+	void RebuildTiles(uint32_t width, uint32_t height);
+	void RenderTile(const Tile& tile, uint32_t firstFrameIndex, uint32_t sampleCount);
+	void RenderTilePhased(const Tile& tile, uint32_t firstFrameIndex, uint32_t sampleCount);
+	// Primary rays every pixel takes per sample, one when the paths are split at the primary hit
+	uint32_t GetPrimaryRaysPerSample() const;
+	// Index in the pixel jitter sequence of the first primary ray of frameIndex, which is m_FrameIndex or one after it
+	uint32_t GetFirstSampleIndex(uint32_t frameIndex) const;
+	// The primary rays of the sample take the points [sampleIndex, sampleIndex + GetPrimaryRaysPerSample()) of the sequence
+	glm::vec4 SamplePixel(uint32_t x, uint32_t y, uint32_t frameIndex, uint32_t sampleIndex);
+	// Direction of the primary ray of the given sample of a pixel, jittered in pixel space according to the filter
+	glm::vec3 GetPrimaryRayDirection(uint32_t x, uint32_t y, uint32_t sampleIndex) const;
+
+	glm::vec4 PerPixel(Ray ray, uint32_t seed, uint32_t x, uint32_t y); // RayGen
+	glm::vec4 PerPixelSplit(const Ray& primaryRay, uint32_t pixelIndex, uint32_t frameIndex, int pathCount);
+	// Follows ray from bounce firstBounce on and returns the light it gathers
+	glm::vec3 TracePath(Ray& ray, uint32_t& seed, glm::vec3 rayColor, int firstBounce);
+	// Samples the next direction at a hit and adds its emission, returns false once russian roulette ends the path
+	bool ScatterRay(Ray& ray, const HitInfo& hitInfo, uint32_t& seed, glm::vec3& rayColor, glm::vec3& incomingLight);
+	
+	HitInfo TraceRay(const Ray& ray);
+	HitInfo Miss(const Ray& ray);
+	Renderer::HitInfo ClosestHit(const Ray& ray, float hitDistance, float exitDistance, int objectIndex);
+
+private:
+	uint32_t m_Width = 0, m_Height = 0;
+
+	Settings m_Settings;
+	
+	bool m_TileTimingEnabled = false;
+	std::vector<float> m_TileSeconds;
+	std::vector<uint32_t> m_TilePasses;
+
+	std::atomic<uint64_t> m_PrimaryRays{ 0 };
+	std::atomic<uint64_t> m_TotalRays{ 0 };
+
+	bool m_PhaseCountersEnabled = false;
+	mutable std::mutex m_PhaseMutex;
+	PhaseCounters m_PhaseCounters;
+
+	// Created on first use unless a shared one is set
+	std::shared_ptr<ThreadPool> m_ThreadPool;
+	bool m_HasSharedThreadPool = false;
+	int m_ThreadCount = 0;
+	bool m_PinThreads = false;
+	std::vector<Tile> m_Tiles;
+	int m_TileSize = 0;
+	TileOrder m_TileOrder = TileOrder::Scanline;
+
+	const Scene* m_ActiveScene = nullptr;
+	const Camera* m_ActiveCamera = nullptr;
+
+	bool m_HasImageData = false;
+
+	uint32_t* m_ImageData = nullptr;
+	glm::vec4* m_AccumulationData = nullptr;
+
+	uint32_t m_FrameIndex = 1;
+	// Primary rays every pixel took since the accumulation started, the jitter sequence goes on from here. Counted
+	// instead of derived from the frame index, the governor changes the rays per pixel between accumulated frames
+	uint32_t m_SampleIndex = 0;
+
+	static constexpr uint32_t RefinementStartStride = 4;
+	// Stride of the next refinement pass, 0 while none is in progress
+	uint32_t m_RefinementStride = 0;
+
+	// The crop window only kicks in once the image outside of it holds a full frame
+	bool m_HasFullImage = false;
+	bool m_CropActive = false;
+	Tile m_CropRegion = { 0, 0, 0, 0 };
+	std::vector<Tile> m_CropTiles;
+
+	std::atomic<uint32_t> m_FrameGeneration{ 0 };
+	uint32_t m_ActiveGeneration = 0;
+};
+
+#endif // !RENDERER_H
\ No newline at end of file
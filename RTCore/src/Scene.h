@@ -27,4 +27,23 @@ struct Scene
 	std::vector<Material> Materials = std::vector<Material>();
 	
 	glm::vec3 SkyColor = glm::vec3(0.0f);
+
+	// Copying a Scene shares its objects, a clone owns copies of them and has to free them with DeleteObjects
+	Scene Clone() const
+	{
+		Scene scene = *this;
+		for (RTObject*& object : scene.SceneObjects)
+		{
+			if (object)
+				object = object->Clone();
+		}
+		return scene;
+	}
+
+	void DeleteObjects()
+	{
+		for (RTObject* object : SceneObjects)
+			delete object;
+		SceneObjects.clear();
+	}
 };
\ No newline at end of file
@@ -0,0 +1,470 @@
+#include "SceneFile.h"
+
+#include "BinaryStream.h"
+#include "Json.h"
+#include "Object.h"
+#include "Profiler.h"
+#include "ScenePresets.h"
+#include "SceneSerializer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace Utils {
+
+	static std::string FormatError(const JsonValue& value, const std::string& message)
+	{
+		return std::to_string(value.Line) + ": " + message;
+	}
+
+	// Missing members keep the value they had, members of the wrong type are errors
+	static bool ReadFloat(const JsonValue& object, const char* key, float& value, std::string& error)
+	{
+		const JsonValue* member = object.Find(key);
+		if (!member)
+			return true;
+
+		if (member->ValueType != JsonValue::Type::Number)
+		{
+			error = FormatError(*member, std::string(key) + " must be a number");
+			return false;
+		}
+
+		value = (float)member->Number;
+		return true;
+	}
+
+	static bool ReadInt(const JsonValue& object, const char* key, int& value, std::string& error)
+	{
+		float number = (float)value;
+		if (!ReadFloat(object, key, number, error))
+			return false;
+
+		value = (int)number;
+		return true;
+	}
+
+	static bool ReadVec3(const JsonValue& object, const char* key, glm::vec3& value, std::string& error)
+	{
+		const JsonValue* member = object.Find(key);
+		if (!member)
+			return true;
+
+		if (member->ValueType != JsonValue::Type::Array || member->Elements.size() != 3)
+		{
+			error = FormatError(*member, std::string(key) + " must be an array of three numbers");
+			return false;
+		}
+
+		for (int i = 0; i < 3; i++)
+		{
+			if (member->Elements[i].ValueType != JsonValue::Type::Number)
+			{
+				error = FormatError(*member, std::string(key) + " must be an array of three numbers");
+				return false;
+			}
+
+			value[i] = (float)member->Elements[i].Number;
+		}
+
+		return true;
+	}
+
+	static const JsonValue* FindArray(const JsonValue& object, const char* key, std::string& error)
+	{
+		const JsonValue* member = object.Find(key);
+		if (member && member->ValueType != JsonValue::Type::Array)
+		{
+			error = FormatError(*member, std::string(key) + " must be an array");
+			return nullptr;
+		}
+		return member;
+	}
+
+	// Shortest representation that reads back as the same float
+	static std::string FormatFloat(float value)
+	{
+		char buffer[32];
+		for (int precision = 6; precision <= 9; precision++)
+		{
+			snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+			if (strtof(buffer, nullptr) == value)
+				break;
+		}
+		return buffer;
+	}
+
+	static std::string FormatVec3(const glm::vec3& value)
+	{
+		return "[ " + FormatFloat(value.x) + ", " + FormatFloat(value.y) + ", " + FormatFloat(value.z) + " ]";
+	}
+
+	static void ApplyCamera(Camera& camera, const glm::vec3& position, const glm::vec3& direction, float verticalFOV,
+		float nearClip, float farClip)
+	{
+		uint32_t width = camera.GetViewportWidth(), height = camera.GetViewportHeight();
+
+		// Setting the view before the size leaves a single recalculation of the ray directions
+		camera = Camera(verticalFOV, nearClip, farClip);
+		camera.SetView(position, direction);
+		camera.OnResize(width, height);
+	}
+
+	static bool GetSourceStamp(const std::string& path, uint64_t& size, int64_t& time)
+	{
+		std::error_code errorCode;
+		size = (uint64_t)std::filesystem::file_size(path, errorCode);
+		if (errorCode)
+			return false;
+
+		time = (int64_t)std::filesystem::last_write_time(path, errorCode).time_since_epoch().count();
+		return !errorCode;
+	}
+}
+
+namespace SceneFile {
+
+	static constexpr uint32_t CacheMagic = 0x43535452; // "RTSC"
+	static constexpr uint32_t CacheVersion = 2;
+
+	// Followed by camera and scene in the binary form of SceneSerializer, the one render workers receive
+	struct CacheHeader
+	{
+		uint32_t Magic = CacheMagic;
+		uint32_t Version = CacheVersion;
+		// Catches layout changes of Material that nobody bumped the version for
+		uint32_t MaterialSize = sizeof(Material);
+		uint32_t Reserved = 0;
+
+		uint64_t SourceSize = 0;
+		int64_t SourceTime = 0;
+	};
+
+	static bool WriteCache(const std::string& cachePath, uint64_t sourceSize, int64_t sourceTime, const Scene& scene, const Camera& camera)
+	{
+		CacheHeader header;
+		header.SourceSize = sourceSize;
+		header.SourceTime = sourceTime;
+
+		BinaryWriter writer;
+		writer.Write(header);
+		SceneSerializer::WriteCamera(writer, camera);
+		SceneSerializer::WriteScene(writer, scene);
+
+		std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+		if (!file)
+			return false;
+
+		file.write((const char*)writer.GetBuffer().data(), (std::streamsize)writer.GetBuffer().size());
+		return (bool)file;
+	}
+
+	bool IsSceneFile(const std::string& path)
+	{
+		return std::filesystem::path(path).extension() == ".rtscene";
+	}
+
+	std::string GetCachePath(const std::string& path)
+	{
+		return path + ".cache";
+	}
+
+	bool Load(const std::string& path, Scene& scene, Camera& camera, std::string& error)
+	{
+		ProfileZone zone("LoadScene");
+
+		std::string cachePath = GetCachePath(path);
+		if (LoadCache(cachePath, path, scene, camera))
+			return true;
+
+		// Stamped before parsing, an edit made meanwhile leaves a stale stamp and the next load parses again
+		uint64_t sourceSize = 0;
+		int64_t sourceTime = 0;
+		bool hasStamp = Utils::GetSourceStamp(path, sourceSize, sourceTime);
+
+		if (!LoadText(path, scene, camera, error))
+			return false;
+
+		// A cache that can't be written, e.g. next to a read-only scene, only costs the next load its speed
+		if (hasStamp)
+			WriteCache(cachePath, sourceSize, sourceTime, scene, camera);
+
+		return true;
+	}
+
+	bool LoadFileOrPreset(const std::string& name, Scene& scene, Camera& camera, std::string& error)
+	{
+		if (IsSceneFile(name))
+			return Load(name, scene, camera, error);
+
+		if (!ScenePresets::Load(name, scene))
+		{
+			error = "unknown scene '" + name + "'";
+			return false;
+		}
+
+		return true;
+	}
+
+	bool LoadText(const std::string& path, Scene& scene, Camera& camera, std::string& error)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			error = "could not open " + path;
+			return false;
+		}
+
+		std::stringstream stream;
+		stream << file.rdbuf();
+		std::string text = stream.str();
+
+		JsonValue root;
+		JsonParser parser(text);
+		if (!parser.Parse(root))
+		{
+			error = path + ":" + std::to_string(parser.GetLine()) + ": " + parser.GetError();
+			return false;
+		}
+
+		if (root.ValueType != JsonValue::Type::Object)
+		{
+			error = path + ": the scene must be a JSON object";
+			return false;
+		}
+
+		// Filled on the side so a broken file leaves the current scene and camera alone
+		Scene loaded;
+		auto fail = [&](const std::string& message)
+		{
+			loaded.DeleteObjects();
+			error = path + ":" + message;
+			return false;
+		};
+
+		std::string message;
+		if (!Utils::ReadVec3(root, "SkyColor", loaded.SkyColor, message))
+			return fail(message);
+
+		Camera defaults(45.0f, 0.1f, 100.0f);
+		glm::vec3 cameraPosition = defaults.GetPosition(), cameraDirection = defaults.GetDirection();
+		float verticalFOV = defaults.GetVerticalFOV(), nearClip = defaults.GetNearClip(), farClip = defaults.GetFarClip();
+		if (const JsonValue* cameraObject = root.Find("Camera"))
+		{
+			if (!Utils::ReadVec3(*cameraObject, "Position", cameraPosition, message) ||
+				!Utils::ReadVec3(*cameraObject, "Direction", cameraDirection, message) ||
+				!Utils::ReadFloat(*cameraObject, "VerticalFOV", verticalFOV, message) ||
+				!Utils::ReadFloat(*cameraObject, "NearClip", nearClip, message) ||
+				!Utils::ReadFloat(*cameraObject, "FarClip", farClip, message))
+				return fail(message);
+
+			if (glm::dot(cameraDirection, cameraDirection) == 0.0f)
+				return fail(Utils::FormatError(*cameraObject, "the camera direction must not be zero"));
+		}
+
+		const JsonValue* materials = Utils::FindArray(root, "Materials", message);
+		if (!message.empty())
+			return fail(message);
+
+		if (materials)
+		{
+			for (const JsonValue& materialObject : materials->Elements)
+			{
+				if (materialObject.ValueType != JsonValue::Type::Object)
+					return fail(Utils::FormatError(materialObject, "materials must be objects"));
+
+				Material& material = loaded.Materials.emplace_back();
+				if (!Utils::ReadVec3(materialObject, "Color", material.Color, message) ||
+					!Utils::ReadVec3(materialObject, "SpecularColor", material.SpecularColor, message) ||
+					!Utils::ReadFloat(materialObject, "Smoothness", material.Smoothness, message) ||
+					!Utils::ReadFloat(materialObject, "Metallness", material.Metallness, message) ||
+					!Utils::ReadVec3(materialObject, "EmissionColor", material.EmissionColor, message) ||
+					!Utils::ReadFloat(materialObject, "EmissionPower", material.EmissionPower, message) ||
+					!Utils::ReadFloat(materialObject, "Transmission", material.Transmission, message) ||
+					!Utils::ReadFloat(materialObject, "IOR", material.IOR, message))
+					return fail(message);
+			}
+		}
+
+		const JsonValue* objects = Utils::FindArray(root, "Objects", message);
+		if (!message.empty())
+			return fail(message);
+
+		if (objects)
+		{
+			for (const JsonValue& objectValue : objects->Elements)
+			{
+				const JsonValue* type = objectValue.Find("Type");
+				if (!type || type->ValueType != JsonValue::Type::String)
+					return fail(Utils::FormatError(objectValue, "objects need a Type"));
+
+				int materialIndex = 0;
+				if (!Utils::ReadInt(objectValue, "Material", materialIndex, message))
+					return fail(message);
+
+				if (materialIndex < 0 || materialIndex >= (int)loaded.Materials.size())
+					return fail(Utils::FormatError(objectValue, "material " + std::to_string(materialIndex) + " does not exist"));
+
+				if (type->String == "Sphere")
+				{
+					Sphere* sphere = new Sphere();
+					loaded.SceneObjects.push_back(sphere);
+					sphere->MaterialIndex = materialIndex;
+
+					if (!Utils::ReadVec3(objectValue, "Position", sphere->Position, message) ||
+						!Utils::ReadFloat(objectValue, "Radius", sphere->Radius, message))
+						return fail(message);
+				}
+				else if (type->String == "Cube")
+				{
+					Cube* cube = new Cube();
+					loaded.SceneObjects.push_back(cube);
+					cube->MaterialIndex = materialIndex;
+
+					if (!Utils::ReadVec3(objectValue, "Position", cube->Position, message) ||
+						!Utils::ReadVec3(objectValue, "Dimensions", cube->Dimensions, message))
+						return fail(message);
+				}
+				else
+				{
+					return fail(Utils::FormatError(*type, "unknown object type '" + type->String + "'"));
+				}
+			}
+		}
+
+		scene.DeleteObjects();
+		scene = loaded;
+		Utils::ApplyCamera(camera, cameraPosition, cameraDirection, verticalFOV, nearClip, farClip);
+		return true;
+	}
+
+	bool SaveText(const std::string& path, const Scene& scene, const Camera& camera, std::string& error)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			error = "could not write " + path;
+			return false;
+		}
+
+		file << "{\n";
+		file << "\t\"SkyColor\": " << Utils::FormatVec3(scene.SkyColor) << ",\n";
+		file << "\t\"Camera\": {\n";
+		file << "\t\t\"Position\": " << Utils::FormatVec3(camera.GetPosition()) << ",\n";
+		file << "\t\t\"Direction\": " << Utils::FormatVec3(camera.GetDirection()) << ",\n";
+		file << "\t\t\"VerticalFOV\": " << Utils::FormatFloat(camera.GetVerticalFOV()) << ",\n";
+		file << "\t\t\"NearClip\": " << Utils::FormatFloat(camera.GetNearClip()) << ",\n";
+		file << "\t\t\"FarClip\": " << Utils::FormatFloat(camera.GetFarClip()) << "\n";
+		file << "\t},\n";
+
+		file << "\t\"Materials\": [";
+		for (size_t i = 0; i < scene.Materials.size(); i++)
+		{
+			const Material& material = scene.Materials[i];
+			file << (i == 0 ? "\n" : ",\n") << "\t\t{\n";
+			file << "\t\t\t\"Color\": " << Utils::FormatVec3(material.Color) << ",\n";
+			file << "\t\t\t\"SpecularColor\": " << Utils::FormatVec3(material.SpecularColor) << ",\n";
+			file << "\t\t\t\"Smoothness\": " << Utils::FormatFloat(material.Smoothness) << ",\n";
+			file << "\t\t\t\"Metallness\": " << Utils::FormatFloat(material.Metallness) << ",\n";
+			file << "\t\t\t\"EmissionColor\": " << Utils::FormatVec3(material.EmissionColor) << ",\n";
+			file << "\t\t\t\"EmissionPower\": " << Utils::FormatFloat(material.EmissionPower) << ",\n";
+			file << "\t\t\t\"Transmission\": " << Utils::FormatFloat(material.Transmission) << ",\n";
+			file << "\t\t\t\"IOR\": " << Utils::FormatFloat(material.IOR) << "\n";
+			file << "\t\t}";
+		}
+		file << (scene.Materials.empty() ? "],\n" : "\n\t],\n");
+
+		file << "\t\"Objects\": [";
+		bool first = true;
+		for (RTObject* object : scene.SceneObjects)
+		{
+			if (Sphere* sphere = dynamic_cast<Sphere*>(object))
+			{
+				file << (first ? "\n" : ",\n") << "\t\t{ \"Type\": \"Sphere\", \"Position\": " << Utils::FormatVec3(sphere->Position)
+					<< ", \"Material\": " << sphere->MaterialIndex << ", \"Radius\": " << Utils::FormatFloat(sphere->Radius) << " }";
+			}
+			else if (Cube* cube = dynamic_cast<Cube*>(object))
+			{
+				file << (first ? "\n" : ",\n") << "\t\t{ \"Type\": \"Cube\", \"Position\": " << Utils::FormatVec3(cube->Position)
+					<< ", \"Material\": " << cube->MaterialIndex << ", \"Dimensions\": " << Utils::FormatVec3(cube->Dimensions) << " }";
+			}
+			else
+			{
+				continue;
+			}
+
+			first = false;
+		}
+		file << (first ? "]\n" : "\n\t]\n");
+		file << "}\n";
+
+		if (!file)
+		{
+			error = "could not write " + path;
+			return false;
+		}
+
+		return true;
+	}
+
+	bool LoadCache(const std::string& cachePath, const std::string& sourcePath, Scene& scene, Camera& camera)
+	{
+		uint64_t sourceSize = 0;
+		int64_t sourceTime = 0;
+		if (!Utils::GetSourceStamp(sourcePath, sourceSize, sourceTime))
+			return false;
+
+		std::ifstream file(cachePath, std::ios::binary | std::ios::ate);
+		if (!file)
+			return false;
+
+		std::streamoff fileSize = file.tellg();
+		if (fileSize < (std::streamoff)sizeof(CacheHeader))
+			return false;
+
+		std::vector<uint8_t> buffer((size_t)fileSize);
+		file.seekg(0);
+		if (!file.read((char*)buffer.data(), fileSize))
+			return false;
+
+		BinaryReader reader(buffer.data(), buffer.size());
+		CacheHeader header;
+		reader.Read(header);
+
+		if (header.Magic != CacheMagic || header.Version != CacheVersion || header.MaterialSize != sizeof(Material) ||
+			header.SourceSize != sourceSize || header.SourceTime != sourceTime)
+			return false;
+
+		// Checked as strictly as anything coming from the network, a corrupt cache is rebuilt from the text
+		Scene loaded;
+		Camera loadedCamera(45.0f, 0.1f, 100.0f);
+		if (!SceneSerializer::ReadCamera(reader, loadedCamera) || !SceneSerializer::ReadScene(reader, loaded) || reader.GetRemaining() != 0)
+		{
+			loaded.DeleteObjects();
+			return false;
+		}
+
+		scene.DeleteObjects();
+		scene = loaded;
+		Utils::ApplyCamera(camera, loadedCamera.GetPosition(), loadedCamera.GetDirection(), loadedCamera.GetVerticalFOV(),
+			loadedCamera.GetNearClip(), loadedCamera.GetFarClip());
+		return true;
+	}
+
+	bool SaveCache(const std::string& cachePath, const std::string& sourcePath, const Scene& scene, const Camera& camera)
+	{
+		uint64_t sourceSize = 0;
+		int64_t sourceTime = 0;
+		if (!Utils::GetSourceStamp(sourcePath, sourceSize, sourceTime))
+			return false;
+
+		return WriteCache(cachePath, sourceSize, sourceTime, scene, camera);
+	}
+
+}
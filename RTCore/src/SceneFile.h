@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Camera.h"
+#include "Scene.h"
+
+#include <string>
+
+// Scene description files: JSON text (.rtscene) with sky, camera, materials and objects, see scenes/ for examples.
+// Next to every loaded file a binary cache is kept that holds the same scene in the form SceneSerializer sends to render
+// workers. It is read in one go and used as long as size and modification time of the text file match the ones it was built from.
+namespace SceneFile {
+
+	bool IsSceneFile(const std::string& path);
+	std::string GetCachePath(const std::string& path);
+
+	// Uses the cache if it is up to date, otherwise parses the text and rewrites the cache.
+	// The camera keeps its viewport size, errors name the file and line
+	bool Load(const std::string& path, Scene& scene, Camera& camera, std::string& error);
+	// Scene files by path, anything else by preset name. Presets leave the camera alone
+	bool LoadFileOrPreset(const std::string& name, Scene& scene, Camera& camera, std::string& error);
+
+	bool LoadText(const std::string& path, Scene& scene, Camera& camera, std::string& error);
+	bool SaveText(const std::string& path, const Scene& scene, const Camera& camera, std::string& error);
+
+	bool LoadCache(const std::string& cachePath, const std::string& sourcePath, Scene& scene, Camera& camera);
+	bool SaveCache(const std::string& cachePath, const std::string& sourcePath, const Scene& scene, const Camera& camera);
+
+}
@@ -0,0 +1,226 @@
+#include "ScenePresets.h"
+
+namespace ScenePresets {
+
+	void Empty(Scene& scene)
+	{
+		scene.DeleteObjects();
+		scene = Scene();
+
+		Material& defaultMaterial = scene.Materials.emplace_back();
+		defaultMaterial.Color = { 0.5f, 0.5f, 0.5f };
+		defaultMaterial.Smoothness = 0.05f;
+	}
+
+	void TwoSpheres(Scene& scene)
+	{
+		Empty(scene);
+
+		Material& defaultMaterial2 = scene.Materials.emplace_back();
+		defaultMaterial2.Color = { 0.7f, 0.7f, 0.7f };
+		defaultMaterial2.Smoothness = 0.95f;
+
+		Material& defaultMaterial3 = scene.Materials.emplace_back();
+		defaultMaterial3.Color = { 0.7f, 0.7f, 0.7f };
+		defaultMaterial3.Smoothness = 0.0f;
+		defaultMaterial3.EmissionColor = glm::vec3(1.0f);
+		defaultMaterial3.EmissionPower = 2.0f;
+
+		Sphere* sphere = new Sphere();
+		sphere->Position = { -1.5f, 0.0f, 0.0f };
+		sphere->Radius = 1.0f;
+		sphere->MaterialIndex = 1;
+		scene.SceneObjects.push_back(sphere);
+
+		Sphere* sphere2 = new Sphere();
+		sphere2->Position = { 1.5f, 0.0f, 0.0f };
+		sphere2->Radius = 1.0f;
+		sphere2->MaterialIndex = 2;
+		scene.SceneObjects.push_back(sphere2);
+
+		Cube* floor = new Cube();
+		floor->Position = { 0.0f, -1.0f, 0.0f };
+		floor->Dimensions = glm::vec3(1000.0f, 0.01f, 1000.0f);
+		floor->MaterialIndex = 0;
+		scene.SceneObjects.push_back(floor);
+
+		scene.SkyColor = glm::vec3(0.75f, 0.75f, 0.75f);
+	}
+
+	void RefractionTest(Scene& scene)
+	{
+		Empty(scene);
+
+		Material& glassSphere1 = scene.Materials.emplace_back();
+		glassSphere1.Color = { 0.8f, 0.2f, 0.3f };
+		glassSphere1.Smoothness = 0.985f;
+		glassSphere1.Transmission = 0.95f;
+		glassSphere1.IOR = 1.5f;
+
+		Material& glassSphere2 = scene.Materials.emplace_back();
+		glassSphere2.Color = { 0.3f, 0.8f, 0.2f };
+		glassSphere2.Smoothness = 0.985f;
+		glassSphere2.Transmission = 0.95f;
+		glassSphere2.IOR = 1.5f;
+
+		Material& glassSphere3 = scene.Materials.emplace_back();
+		glassSphere3.Color = { 0.2f, 0.3f, 0.8f };
+		glassSphere3.Smoothness = 0.985f;
+		glassSphere3.Transmission = 0.95f;
+		glassSphere3.IOR = 1.5f;
+
+		Material& emissiveSphere = scene.Materials.emplace_back();
+		emissiveSphere.EmissionColor = { 0.8f, 0.7f, 0.9f };
+		emissiveSphere.EmissionPower = 25.0f;
+
+		Sphere* sphere = new Sphere();
+		sphere->Position = { 0.0f, -102.0f, 0.0f };
+		sphere->Radius = 100.0f;
+		sphere->MaterialIndex = 0;
+		scene.SceneObjects.push_back(sphere);
+
+		Sphere* sphere2 = new Sphere();
+		sphere2->Position = { 0.0f, 2.5f, -10.0f };
+		sphere2->Radius = 2.5f;
+		sphere2->MaterialIndex = 4;
+		scene.SceneObjects.push_back(sphere2);
+
+		Sphere* sphere3 = new Sphere();
+		sphere3->Position = { 2.5f, -1.0f, 0.0f };
+		sphere3->Radius = 1.0f;
+		sphere3->MaterialIndex = 1;
+		scene.SceneObjects.push_back(sphere3);
+
+		Sphere* sphere4 = new Sphere();
+		sphere4->Position = { 0.0f, -1.0f, 0.0f };
+		sphere4->Radius = 1.0f;
+		sphere4->MaterialIndex = 2;
+		scene.SceneObjects.push_back(sphere4);
+
+		Sphere* sphere5 = new Sphere();
+		sphere5->Position = { -2.5f, -1.0f, 0.0f };
+		sphere5->Radius = 1.0f;
+		sphere5->MaterialIndex = 3;
+		scene.SceneObjects.push_back(sphere5);
+
+		scene.SkyColor = glm::vec3(0.05f, 0.05f, 0.05f);
+	}
+
+	void ColorRoom(Scene& scene)
+	{
+		Empty(scene);
+
+		Material& defaultMaterial2 = scene.Materials.emplace_back();
+		defaultMaterial2.Color = { 0.9f, 0.9f, 0.9f };
+		defaultMaterial2.Smoothness = 0.125f;
+
+		Material& defaultMaterial3 = scene.Materials.emplace_back();
+		defaultMaterial3.Color = { 0.8f, 0.8f, 0.8f };
+		defaultMaterial3.Smoothness = 0.0f;
+		defaultMaterial3.EmissionColor = glm::vec3(1.0f);
+		defaultMaterial3.EmissionPower = 5.0f;
+
+		Material& redMaterial = scene.Materials.emplace_back();
+		redMaterial.Color = { 0.8f, 0.1f, 0.1f };
+		redMaterial.Smoothness = 0.0f;
+
+		Material& greenMaterial = scene.Materials.emplace_back();
+		greenMaterial.Color = { 0.1f, 0.8f, 0.1f };
+		greenMaterial.Smoothness = 0.0f;
+
+		Material& reflectiveMaterial = scene.Materials.emplace_back();
+		reflectiveMaterial.Color = { 0.85f, 0.85f, 0.85f };
+		reflectiveMaterial.Smoothness = 0.975f;
+		reflectiveMaterial.Metallness = 0.95f;
+
+		Material& transmissiveMaterial = scene.Materials.emplace_back();
+		transmissiveMaterial.Color = { 0.85f, 0.85f, 0.85f };
+		transmissiveMaterial.Smoothness = 0.875f;
+		transmissiveMaterial.Metallness = 0.95f;
+		transmissiveMaterial.Transmission = 0.85f;
+		transmissiveMaterial.IOR = 1.45f;
+
+		Material& colorMaterial = scene.Materials.emplace_back();
+		colorMaterial.Color = { 0.1f, 0.225f, 0.65f };
+		colorMaterial.Smoothness = 0.225f;
+
+		Sphere* glassSphere = new Sphere();
+		glassSphere->Position = { -1.25f, -1.5f, -0.25f };
+		glassSphere->Radius = 1.0f;
+		glassSphere->MaterialIndex = 6;
+		scene.SceneObjects.push_back(glassSphere);
+
+		Sphere* reflectiveSphere = new Sphere();
+		reflectiveSphere->Position = { 1.25f, -1.5f, 0.25f };
+		reflectiveSphere->Radius = 1.0f;
+		reflectiveSphere->MaterialIndex = 5;
+		scene.SceneObjects.push_back(reflectiveSphere);
+
+		Sphere* colorSphere = new Sphere();
+		colorSphere->Position = { -0.25f, -2.0f, 0.45f };
+		colorSphere->Radius = 0.5f;
+		colorSphere->MaterialIndex = 7;
+		scene.SceneObjects.push_back(colorSphere);
+
+		Cube* floor = new Cube();
+		floor->Position = { 0.0f, -2.5f, 5.0f };
+		floor->Dimensions = glm::vec3(2.5f, 0.001f, 10.0f);
+		floor->MaterialIndex = 1;
+		scene.SceneObjects.push_back(floor);
+
+		Cube* ceiling = new Cube();
+		ceiling->Position = { 0.0f, 2.5f, 5.0f };
+		ceiling->Dimensions = glm::vec3(2.5f, 0.001f, 10.0f);
+		ceiling->MaterialIndex = 1;
+		scene.SceneObjects.push_back(ceiling);
+
+		Cube* wallLeft = new Cube();
+		wallLeft->Position = { -2.5f, 0.0f, 5.0f };
+		wallLeft->Dimensions = glm::vec3(0.001f, 2.5f, 10.0f);
+		wallLeft->MaterialIndex = 3;
+		scene.SceneObjects.push_back(wallLeft);
+
+		Cube* wallRight = new Cube();
+		wallRight->Position = { 2.5f, 0.0f, 5.0f };
+		wallRight->Dimensions = glm::vec3(0.001f, 2.5f, 10.0f);
+		wallRight->MaterialIndex = 4;
+		scene.SceneObjects.push_back(wallRight);
+
+		Cube* wallBack = new Cube();
+		wallBack->Position = { 0.0f, 0.0f, -2.5f };
+		wallBack->Dimensions = glm::vec3(2.5f, 2.5f, 0.001f);
+		wallBack->MaterialIndex = 1;
+		scene.SceneObjects.push_back(wallBack);
+
+		Cube* wallFront = new Cube();
+		wallFront->Position = { 0.0f, 0.0f, 10.0f };
+		wallFront->Dimensions = glm::vec3(2.5f, 2.5f, 0.001f);
+		wallFront->MaterialIndex = 1;
+		scene.SceneObjects.push_back(wallFront);
+
+		Cube* ceilingLight = new Cube();
+		ceilingLight->Position = { 0.0f, 2.4f, 0.0f };
+		ceilingLight->Dimensions = glm::vec3(1.0f, 0.05f, 1.0f);
+		ceilingLight->MaterialIndex = 2;
+		scene.SceneObjects.push_back(ceilingLight);
+
+		scene.SkyColor = glm::vec3(0.0f, 0.0f, 0.0f);
+	}
+
+	bool Load(const std::string& name, Scene& scene)
+	{
+		if (name == "Empty")
+			Empty(scene);
+		else if (name == "TwoSpheres")
+			TwoSpheres(scene);
+		else if (name == "RefractionTest")
+			RefractionTest(scene);
+		else if (name == "ColorRoom")
+			ColorRoom(scene);
+		else
+			return false;
+
+		return true;
+	}
+
+}
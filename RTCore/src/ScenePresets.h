@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Scene.h"
+
+#include <string>
+
+// Built-in scenes shared by the viewport, the command line tools and the benchmarks.
+// Every preset frees the objects of the scene it replaces.
+namespace ScenePresets {
+
+	void Empty(Scene& scene);
+	void TwoSpheres(Scene& scene);
+	void RefractionTest(Scene& scene);
+	void ColorRoom(Scene& scene);
+
+	// Loads a preset by its function name, returns false for unknown names
+	bool Load(const std::string& name, Scene& scene);
+
+}
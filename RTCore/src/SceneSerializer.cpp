@@ -0,0 +1,147 @@
+#include "SceneSerializer.h"
+
+#include "Object.h"
+
+#include <cmath>
+
+namespace SceneSerializer {
+
+	enum class ObjectType : uint32_t
+	{
+		Sphere = 0,
+		Cube = 1
+	};
+
+	// The renderer indexes the materials with it unchecked
+	static bool IsMaterialIndexValid(const Scene& scene, int materialIndex)
+	{
+		return materialIndex >= 0 && materialIndex < (int)scene.Materials.size();
+	}
+
+	void WriteScene(BinaryWriter& writer, const Scene& scene)
+	{
+		writer.Write(scene.SkyColor);
+
+		writer.Write((uint32_t)scene.Materials.size());
+		for (const Material& material : scene.Materials)
+			writer.Write(material);
+
+		uint32_t objectCount = 0;
+		for (RTObject* object : scene.SceneObjects)
+			objectCount += object != nullptr;
+
+		writer.Write(objectCount);
+		for (RTObject* object : scene.SceneObjects)
+		{
+			if (Sphere* sphere = dynamic_cast<Sphere*>(object))
+			{
+				writer.Write(ObjectType::Sphere);
+				writer.Write(sphere->Position);
+				writer.Write(sphere->MaterialIndex);
+				writer.Write(sphere->Radius);
+			}
+			else if (Cube* cube = dynamic_cast<Cube*>(object))
+			{
+				writer.Write(ObjectType::Cube);
+				writer.Write(cube->Position);
+				writer.Write(cube->MaterialIndex);
+				writer.Write(cube->Dimensions);
+			}
+		}
+	}
+
+	bool ReadScene(BinaryReader& reader, Scene& scene)
+	{
+		scene.DeleteObjects();
+		scene = Scene();
+
+		uint32_t materialCount = 0;
+		if (!reader.Read(scene.SkyColor) || !reader.Read(materialCount))
+			return false;
+
+		// Guards the resize against corrupt counts
+		if (materialCount > reader.GetRemaining() / sizeof(Material))
+			return false;
+
+		scene.Materials.resize(materialCount);
+		for (Material& material : scene.Materials)
+		{
+			if (!reader.Read(material))
+				return false;
+		}
+
+		uint32_t objectCount = 0;
+		if (!reader.Read(objectCount))
+			return false;
+
+		for (uint32_t i = 0; i < objectCount; i++)
+		{
+			ObjectType type;
+			if (!reader.Read(type))
+				return false;
+
+			if (type == ObjectType::Sphere)
+			{
+				Sphere* sphere = new Sphere();
+				scene.SceneObjects.push_back(sphere);
+
+				if (!reader.Read(sphere->Position) || !reader.Read(sphere->MaterialIndex) || !reader.Read(sphere->Radius)
+					|| !IsMaterialIndexValid(scene, sphere->MaterialIndex))
+					return false;
+			}
+			else if (type == ObjectType::Cube)
+			{
+				Cube* cube = new Cube();
+				scene.SceneObjects.push_back(cube);
+
+				if (!reader.Read(cube->Position) || !reader.Read(cube->MaterialIndex) || !reader.Read(cube->Dimensions)
+					|| !IsMaterialIndexValid(scene, cube->MaterialIndex))
+					return false;
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void WriteCamera(BinaryWriter& writer, const Camera& camera)
+	{
+		writer.Write(camera.GetPosition());
+		writer.Write(camera.GetDirection());
+		writer.Write(camera.GetVerticalFOV());
+		writer.Write(camera.GetNearClip());
+		writer.Write(camera.GetFarClip());
+	}
+
+	bool ReadCamera(BinaryReader& reader, Camera& camera)
+	{
+		glm::vec3 position, direction;
+		float verticalFOV, nearClip, farClip;
+		if (!reader.Read(position) || !reader.Read(direction) || !reader.Read(verticalFOV) || !reader.Read(nearClip) || !reader.Read(farClip))
+			return false;
+
+		// Normalized into NaN, every ray of the image would be
+		float directionLength = glm::length(direction);
+		if (!(directionLength > 0.0f) || !std::isfinite(directionLength))
+			return false;
+
+		camera = Camera(verticalFOV, nearClip, farClip);
+		camera.SetPosition(position);
+		camera.SetDirection(direction);
+		return true;
+	}
+
+	void WriteSettings(BinaryWriter& writer, const Renderer::Settings& settings)
+	{
+		writer.Write(settings);
+	}
+
+	bool ReadSettings(BinaryReader& reader, Renderer::Settings& settings)
+	{
+		return reader.Read(settings);
+	}
+
+}
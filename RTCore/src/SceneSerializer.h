@@ -0,0 +1,23 @@
+#pragma once
+
+#include "BinaryStream.h"
+#include "Camera.h"
+#include "Renderer.h"
+#include "Scene.h"
+
+// Binary form of scenes, cameras and render settings as sent to render workers.
+// Objects are written with a type tag, reading fails on unknown tags, material indices out of range, a camera without
+// direction or truncated data.
+namespace SceneSerializer {
+
+	void WriteScene(BinaryWriter& writer, const Scene& scene);
+	bool ReadScene(BinaryReader& reader, Scene& scene);
+
+	// Stores position, direction and projection parameters, the viewport size is up to the reader
+	void WriteCamera(BinaryWriter& writer, const Camera& camera);
+	bool ReadCamera(BinaryReader& reader, Camera& camera);
+
+	void WriteSettings(BinaryWriter& writer, const Renderer::Settings& settings);
+	bool ReadSettings(BinaryReader& reader, Renderer::Settings& settings);
+
+}
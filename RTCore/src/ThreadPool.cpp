@@ -0,0 +1,274 @@
+#include "ThreadPool.h"
+
+#include "Profiler.h"
+
+#if defined(_WIN32)
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <Windows.h>
+#elif defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+static thread_local const ThreadPool* s_CurrentPool = nullptr;
+static thread_local int s_WorkerIndex = -1;
+
+namespace Utils {
+	// Logical CPUs this process is allowed to run on, in ascending order
+	static std::vector<uint32_t> GetAvailableCPUs()
+	{
+		std::vector<uint32_t> cpus;
+
+#if defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		if (sched_getaffinity(0, sizeof(set), &set) == 0)
+		{
+			for (uint32_t cpu = 0; cpu < CPU_SETSIZE; cpu++)
+			{
+				if (CPU_ISSET(cpu, &set))
+					cpus.push_back(cpu);
+			}
+		}
+#elif defined(_WIN32)
+		WORD groupCount = GetActiveProcessorGroupCount();
+		for (WORD group = 0; group < groupCount; group++)
+		{
+			DWORD groupSize = GetActiveProcessorCount(group);
+			for (DWORD i = 0; i < groupSize; i++)
+				cpus.push_back(group * 64 + i);
+		}
+#endif
+
+		if (cpus.empty())
+		{
+			for (uint32_t cpu = 0; cpu < std::thread::hardware_concurrency(); cpu++)
+				cpus.push_back(cpu);
+		}
+
+		return cpus;
+	}
+}
+
+ThreadPool::ThreadPool(uint32_t threadCount, bool pinThreads)
+	: m_PinThreads(pinThreads)
+{
+	if (threadCount == 0)
+	{
+		// The thread calling ParallelFor works as well, leave a core for it
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+	else if (threadCount == CallerOnly)
+	{
+		threadCount = 0;
+	}
+
+	for (uint32_t i = 0; i < threadCount; i++)
+		m_Queues.push_back(std::make_unique<WorkerQueue>());
+
+	for (uint32_t i = 0; i <= threadCount; i++)
+		m_Counters.push_back(std::make_unique<WorkerCounters>());
+
+	if (m_PinThreads)
+		m_CPUs = Utils::GetAvailableCPUs();
+
+	for (uint32_t i = 0; i < threadCount; i++)
+		m_Workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+		m_Stop = true;
+	}
+	m_WakeCondition.notify_all();
+
+	for (std::thread& worker : m_Workers)
+		worker.join();
+}
+
+int ThreadPool::GetWorkerIndex()
+{
+	return s_WorkerIndex;
+}
+
+std::vector<ThreadPool::WorkerStats> ThreadPool::GetWorkerStats() const
+{
+	std::vector<WorkerStats> stats(m_Counters.size());
+	for (size_t i = 0; i < m_Counters.size(); i++)
+	{
+		stats[i].BusySeconds = m_Counters[i]->BusyNanoseconds.load(std::memory_order_relaxed) * 1e-9;
+		stats[i].TasksExecuted = m_Counters[i]->TasksExecuted.load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+
+void ThreadPool::ResetWorkerStats()
+{
+	for (const std::unique_ptr<WorkerCounters>& counters : m_Counters)
+	{
+		counters->BusyNanoseconds.store(0, std::memory_order_relaxed);
+		counters->TasksExecuted.store(0, std::memory_order_relaxed);
+	}
+}
+
+void ThreadPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& function)
+{
+	if (count == 0)
+		return;
+
+	ProfileZone zone("ParallelFor");
+
+	Job job;
+	job.Function = &function;
+	job.Remaining.store(count, std::memory_order_relaxed);
+
+	uint32_t workerCount = GetThreadCount();
+	if (workerCount == 0)
+	{
+		for (uint32_t i = 0; i < count; i++)
+			Execute({ &job, i }, -1);
+		return;
+	}
+
+	// Contiguous chunks keep neighbouring work items on the same worker
+	for (uint32_t worker = 0; worker < workerCount; worker++)
+	{
+		uint32_t begin = (uint32_t)((uint64_t)count * worker / workerCount);
+		uint32_t end = (uint32_t)((uint64_t)count * (worker + 1) / workerCount);
+		if (begin == end)
+			continue;
+
+		WorkerQueue& queue = *m_Queues[worker];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		for (uint32_t i = begin; i < end; i++)
+			queue.Tasks.push_back({ &job, i });
+	}
+
+	m_PendingTasks.fetch_add(count, std::memory_order_release);
+	{
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+	}
+	m_WakeCondition.notify_all();
+
+	int callerIndex = s_CurrentPool == this ? s_WorkerIndex : -1;
+	while (job.Remaining.load(std::memory_order_acquire) > 0)
+	{
+		Task task;
+		if (TryPop(callerIndex, task))
+			Execute(task, callerIndex);
+		else
+			std::this_thread::yield();
+	}
+}
+
+void ThreadPool::WorkerLoop(uint32_t workerIndex)
+{
+	s_CurrentPool = this;
+	s_WorkerIndex = (int)workerIndex;
+	Profiler::SetThreadName("Worker " + std::to_string(workerIndex));
+
+	if (m_PinThreads)
+		PinCurrentThread(workerIndex);
+
+	while (true)
+	{
+		Task task;
+		if (TryPop((int)workerIndex, task))
+		{
+			Execute(task, (int)workerIndex);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_WakeMutex);
+		m_WakeCondition.wait(lock, [this]() { return m_Stop || m_PendingTasks.load(std::memory_order_acquire) > 0; });
+
+		if (m_Stop && m_PendingTasks.load(std::memory_order_acquire) == 0)
+			return;
+	}
+}
+
+void ThreadPool::PinCurrentThread(uint32_t workerIndex)
+{
+	if (m_CPUs.empty())
+		return;
+
+	// More workers than CPUs wrap around
+	uint32_t cpu = m_CPUs[workerIndex % m_CPUs.size()];
+
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#elif defined(_WIN32)
+	GROUP_AFFINITY affinity = {};
+	affinity.Group = (WORD)(cpu / 64);
+	affinity.Mask = (KAFFINITY)1 << (cpu % 64);
+	SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr);
+#endif
+}
+
+bool ThreadPool::TryPop(int workerIndex, Task& task)
+{
+	if (workerIndex >= 0)
+	{
+		WorkerQueue& queue = *m_Queues[workerIndex];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		if (!queue.Tasks.empty())
+		{
+			task = queue.Tasks.front();
+			queue.Tasks.pop_front();
+			m_PendingTasks.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return TrySteal(workerIndex, task);
+}
+
+bool ThreadPool::TrySteal(int thiefIndex, Task& task)
+{
+	int workerCount = (int)GetThreadCount();
+
+	// Victims ordered by distance to the thief: i - 1, i + 1, i - 2, i + 2, ...
+	for (int distance = 1; distance <= workerCount; distance++)
+	{
+		for (int direction = -1; direction <= 1; direction += 2)
+		{
+			int victim = ((thiefIndex + direction * distance) % workerCount + workerCount) % workerCount;
+			if (victim == thiefIndex)
+				continue;
+
+			WorkerQueue& queue = *m_Queues[victim];
+			std::lock_guard<std::mutex> lock(queue.Mutex);
+			if (!queue.Tasks.empty())
+			{
+				task = queue.Tasks.back();
+				queue.Tasks.pop_back();
+				m_PendingTasks.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void ThreadPool::Execute(const Task& task, int workerIndex)
+{
+	auto start = std::chrono::steady_clock::now();
+	(*task.Owner->Function)(task.Index);
+	auto busyTime = std::chrono::steady_clock::now() - start;
+
+	// Counted before the job is released, so stats read after ParallelFor returns include all of its tasks
+	WorkerCounters& counters = *m_Counters[workerIndex >= 0 ? workerIndex : m_Counters.size() - 1];
+	counters.BusyNanoseconds.fetch_add((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(busyTime).count(), std::memory_order_relaxed);
+	counters.TasksExecuted.fetch_add(1, std::memory_order_relaxed);
+
+	task.Owner->Remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
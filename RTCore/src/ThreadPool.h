@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent pool of worker threads with one deque per worker.
+// Workers pop their own work from the front and steal from the back of other workers once they run dry,
+// trying the workers next to them first since their chunks of a ParallelFor lie next to their own.
+class ThreadPool
+{
+public:
+	static constexpr uint32_t CallerOnly = 0xffffffffu;
+
+	// A thread count of 0 leaves one hardware thread for the caller, CallerOnly starts no workers and ParallelFor runs
+	// everything on the calling thread. Pinned workers stay on one CPU each, taken in order from the CPUs the process may
+	// run on, so memory they touch first stays on their NUMA node.
+	explicit ThreadPool(uint32_t threadCount = 0, bool pinThreads = false);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Runs function(index) for every index in [0, count) and returns once all of them finished.
+	// Indices are handed out to the workers in contiguous chunks, the calling thread helps out while waiting.
+	void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& function);
+
+	uint32_t GetThreadCount() const { return (uint32_t)m_Queues.size(); }
+	bool AreThreadsPinned() const { return m_PinThreads; }
+
+	// Index of the pool worker executing the current thread, -1 for threads not owned by a pool
+	static int GetWorkerIndex();
+
+	struct WorkerStats
+	{
+		double BusySeconds = 0.0;
+		uint64_t TasksExecuted = 0;
+	};
+
+	// Time spent running tasks since the last reset, one entry per worker followed by one for all calling threads
+	std::vector<WorkerStats> GetWorkerStats() const;
+	void ResetWorkerStats();
+private:
+	struct Job
+	{
+		const std::function<void(uint32_t)>* Function = nullptr;
+		std::atomic<uint32_t> Remaining{ 0 };
+	};
+
+	struct Task
+	{
+		Job* Owner = nullptr;
+		uint32_t Index = 0;
+	};
+
+	struct WorkerQueue
+	{
+		std::mutex Mutex;
+		std::deque<Task> Tasks;
+	};
+
+	struct WorkerCounters
+	{
+		std::atomic<uint64_t> BusyNanoseconds{ 0 };
+		std::atomic<uint64_t> TasksExecuted{ 0 };
+	};
+
+	void WorkerLoop(uint32_t workerIndex);
+	void PinCurrentThread(uint32_t workerIndex);
+
+	bool TryPop(int workerIndex, Task& task);
+	bool TrySteal(int thiefIndex, Task& task);
+	void Execute(const Task& task, int workerIndex);
+private:
+	// Queues are created before the first worker starts, their count is the thread count
+	std::vector<std::unique_ptr<WorkerQueue>> m_Queues;
+	// One more than queues, the last one is shared by threads calling ParallelFor from outside the pool
+	std::vector<std::unique_ptr<WorkerCounters>> m_Counters;
+	std::vector<std::thread> m_Workers;
+	std::vector<uint32_t> m_CPUs;
+	bool m_PinThreads = false;
+
+	std::mutex m_WakeMutex;
+	std::condition_variable m_WakeCondition;
+
+	std::atomic<uint32_t> m_PendingTasks{ 0 };
+	bool m_Stop = false;
+};
@@ -9,6 +9,8 @@ project "RTRayTracer"
 
    includedirs
    {
+      "../RTCore/src",
+
       "../Walnut/vendor/imgui",
       "../Walnut/vendor/glfw/include",
       "../Walnut/vendor/glm",
@@ -20,6 +22,7 @@ project "RTRayTracer"
 
    links
    {
+       "RTCore",
        "Walnut"
    }
 
@@ -0,0 +1,81 @@
+#include "CameraController.h"
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include "Walnut/Input/Input.h"
+
+using namespace Walnut;
+
+bool CameraController::OnUpdate(Camera& camera, float ts)
+{
+	glm::vec2 mousePos = Input::GetMousePosition();
+	glm::vec2 delta = (mousePos - m_LastMousePosition) * 0.002f;
+	m_LastMousePosition = mousePos;
+
+	if (!Input::IsMouseButtonDown(MouseButton::Right))
+	{
+		Input::SetCursorMode(CursorMode::Normal);
+		return false;
+	}
+
+	Input::SetCursorMode(CursorMode::Locked);
+
+	bool moved = false;
+
+	glm::vec3 position = camera.GetPosition();
+	glm::vec3 forwardDirection = camera.GetDirection();
+
+	const glm::vec3 upDirection(0.0f, 1.0f, 0.0f);
+	glm::vec3 rightDirection = glm::cross(forwardDirection, upDirection);
+
+	// Movement
+	if (Input::IsKeyDown(KeyCode::W))
+	{
+		position += forwardDirection * m_MoveSpeed * ts;
+		moved = true;
+	}
+	else if (Input::IsKeyDown(KeyCode::S))
+	{
+		position -= forwardDirection * m_MoveSpeed * ts;
+		moved = true;
+	}
+	if (Input::IsKeyDown(KeyCode::A))
+	{
+		position -= rightDirection * m_MoveSpeed * ts;
+		moved = true;
+	}
+	else if (Input::IsKeyDown(KeyCode::D))
+	{
+		position += rightDirection * m_MoveSpeed * ts;
+		moved = true;
+	}
+	if (Input::IsKeyDown(KeyCode::Q))
+	{
+		position -= upDirection * m_MoveSpeed * ts;
+		moved = true;
+	}
+	else if (Input::IsKeyDown(KeyCode::E))
+	{
+		position += upDirection * m_MoveSpeed * ts;
+		moved = true;
+	}
+
+	// Rotation
+	if (delta.x != 0.0f || delta.y != 0.0f)
+	{
+		float pitchDelta = delta.y * m_RotationSpeed;
+		float yawDelta = delta.x * m_RotationSpeed;
+
+		glm::quat q = glm::normalize(glm::cross(glm::angleAxis(-pitchDelta, rightDirection),
+			glm::angleAxis(-yawDelta, upDirection)));
+		forwardDirection = glm::rotate(q, forwardDirection);
+
+		moved = true;
+	}
+
+	if (moved)
+		camera.SetView(position, forwardDirection);
+
+	return moved;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Camera.h"
+
+#include <glm/glm.hpp>
+
+// Fly navigation for the viewport: hold the right mouse button to look around, WASD to move and Q/E to go down and up
+class CameraController
+{
+public:
+	// Returns true if the camera moved this frame
+	bool OnUpdate(Camera& camera, float ts);
+
+	float GetMoveSpeed() const { return m_MoveSpeed; }
+	void SetMoveSpeed(float speed) { m_MoveSpeed = speed; }
+	float GetRotationSpeed() const { return m_RotationSpeed; }
+	void SetRotationSpeed(float speed) { m_RotationSpeed = speed; }
+private:
+	glm::vec2 m_LastMousePosition{ 0.0f, 0.0f };
+
+	float m_MoveSpeed = 5.0f;
+	float m_RotationSpeed = 0.3f;
+};
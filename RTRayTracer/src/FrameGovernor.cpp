@@ -0,0 +1,65 @@
+#include "FrameGovernor.h"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+
+namespace Utils {
+	// Resolution scales are kept to multiples of this, so small corrections do not resize the image every frame
+	static constexpr float ResolutionStep = 1.0f / 16.0f;
+	// Relative error of the frame time at which the resolution follows
+	static constexpr float ResolutionTolerance = 0.2f;
+	// Frames a new resolution gets to settle before the next change
+	static constexpr uint32_t ResolutionSettleFrames = 4;
+}
+
+void FrameGovernor::Update(const Settings& settings, float frameTime)
+{
+	float minScale = glm::clamp(settings.MinResolutionScale, Utils::ResolutionStep, 1.0f);
+	float maxScale = glm::clamp(settings.MaxResolutionScale, minScale, 1.0f);
+	int minRays = glm::max(settings.MinRaysPerPixel, 1);
+	int maxRays = glm::max(settings.MaxRaysPerPixel, minRays);
+
+	m_ResolutionScale = glm::clamp(m_ResolutionScale, minScale, maxScale);
+	m_RaysPerPixel = glm::clamp(m_RaysPerPixel, minRays, maxRays);
+
+	if (frameTime <= 0.0f || settings.TargetFrameTime <= 0.0f)
+		return;
+
+	m_AverageFrameTime = m_AverageFrameTime == 0.0f ? frameTime : glm::mix(m_AverageFrameTime, frameTime, 0.3f);
+
+	// The first frame after a resize includes reallocating the buffers and says little about the cost of the next ones
+	m_FramesSinceResize++;
+	if (m_FramesSinceResize == 1 && m_AverageCost > 0.0f)
+		return;
+
+	// Cost of one unit of work, the frame just measured was rendered with the current scale and rays per pixel
+	float cost = frameTime / (m_ResolutionScale * m_ResolutionScale * (float)m_RaysPerPixel);
+	m_AverageCost = m_AverageCost == 0.0f ? cost : glm::mix(m_AverageCost, cost, 0.3f);
+
+	float work = settings.TargetFrameTime / m_AverageCost;
+
+	// Largest resolution that fits with the fewest rays, rays per pixel get what is left
+	float scale = glm::clamp(sqrtf(work / (float)minRays), minScale, maxScale);
+	scale = glm::clamp(floorf(scale / Utils::ResolutionStep) * Utils::ResolutionStep, minScale, maxScale);
+
+	float currentFrameTime = m_AverageCost * m_ResolutionScale * m_ResolutionScale * (float)minRays;
+	bool outsideTolerance = fabsf(currentFrameTime / settings.TargetFrameTime - 1.0f) > Utils::ResolutionTolerance;
+	if (scale != m_ResolutionScale && outsideTolerance && m_FramesSinceResize >= Utils::ResolutionSettleFrames)
+	{
+		m_ResolutionScale = scale;
+		m_FramesSinceResize = 0;
+	}
+
+	int rays = (int)floorf(work / (m_ResolutionScale * m_ResolutionScale));
+	m_RaysPerPixel = glm::clamp(rays, minRays, maxRays);
+}
+
+void FrameGovernor::Reset()
+{
+	m_ResolutionScale = 1.0f;
+	m_RaysPerPixel = 1;
+	m_AverageFrameTime = 0.0f;
+	m_AverageCost = 0.0f;
+	m_FramesSinceResize = 0;
+}
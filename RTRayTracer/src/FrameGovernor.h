@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// Picks resolution scale and rays per pixel for realtime rendering so frames take about the target time.
+// Frame cost is modelled as scale^2 * rays per pixel times a measured cost per unit. Resolution is raised first since it is
+// what the viewer notices most, rays per pixel soak up the remaining budget. Changing the resolution restarts
+// accumulation, so it moves in coarse steps and only once it is off by more than a tolerance, rays per pixel follow
+// every frame.
+class FrameGovernor
+{
+public:
+	struct Settings
+	{
+		bool Enabled = false;
+		float TargetFrameTime = 16.6f; // ms
+
+		float MinResolutionScale = 0.25f;
+		float MaxResolutionScale = 1.0f;
+		int MinRaysPerPixel = 1;
+		int MaxRaysPerPixel = 8;
+	};
+public:
+	// Feeds the time the last finished frame took
+	void Update(const Settings& settings, float frameTime);
+	void Reset();
+
+	float GetResolutionScale() const { return m_ResolutionScale; }
+	int GetRaysPerPixel() const { return m_RaysPerPixel; }
+	float GetAverageFrameTime() const { return m_AverageFrameTime; }
+private:
+	float m_ResolutionScale = 1.0f;
+	int m_RaysPerPixel = 1;
+
+	float m_AverageFrameTime = 0.0f;
+	// Milliseconds per unit of work, a frame at full resolution with one ray per pixel
+	float m_AverageCost = 0.0f;
+	uint32_t m_FramesSinceResize = 0;
+};
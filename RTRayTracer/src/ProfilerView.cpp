@@ -0,0 +1,131 @@
+#include "ProfilerView.h"
+
+#include "imgui.h"
+
+#include <algorithm>
+
+namespace Utils {
+	// The same name always gets the same color
+	static ImU32 GetZoneColor(const char* name)
+	{
+		uint32_t hash = 2166136261u;
+		for (const char* c = name; *c; c++)
+		{
+			hash ^= (uint8_t)*c;
+			hash *= 16777619u;
+		}
+		return ImColor::HSV((float)(hash % 360) / 360.0f, 0.45f, 0.85f);
+	}
+}
+
+void ProfilerView::Draw()
+{
+	ProfileZone zone("ProfilerView");
+
+	ImGui::Begin("Profiler");
+	{
+		bool recording = Profiler::IsEnabled();
+		if (ImGui::Checkbox("Record", &recording))
+			Profiler::SetEnabled(recording);
+
+		ImGui::SameLine();
+		ImGui::Checkbox("Pause View", &m_Paused);
+		ImGui::SliderInt("Frames", &m_FrameCount, 1, 16);
+
+		ImGui::InputText("Trace File", m_TracePath, IM_ARRAYSIZE(m_TracePath));
+		if (ImGui::Button("Export Trace"))
+		{
+			std::string error;
+			if (Profiler::WriteChromeTrace(m_TracePath, error))
+				m_Status = "Wrote " + std::string(m_TracePath) + ", open it in ui.perfetto.dev or chrome://tracing";
+			else
+				m_Status = error;
+		}
+		if (!m_Status.empty())
+			ImGui::TextWrapped("%s", m_Status.c_str());
+
+		ImGui::Separator();
+
+		// Ends at the start of the current UI frame, zones of the frame in progress are still open
+		std::vector<uint64_t> frameMarks = Profiler::GetFrameMarks();
+		if (recording && !m_Paused && frameMarks.size() > (size_t)m_FrameCount)
+		{
+			m_FrameMarks.assign(frameMarks.end() - m_FrameCount - 1, frameMarks.end());
+			m_WindowStart = m_FrameMarks.front();
+			m_WindowEnd = m_FrameMarks.back();
+			m_Threads = Profiler::Capture(m_WindowStart);
+		}
+
+		if (m_WindowEnd > m_WindowStart)
+		{
+			ImGui::Text("%d frames, %.2f ms", (int)m_FrameMarks.size() - 1, (m_WindowEnd - m_WindowStart) / 1.0e6);
+
+			ImGui::BeginChild("Lanes");
+			for (const Profiler::ThreadZones& thread : m_Threads)
+				DrawThread(thread);
+			ImGui::EndChild();
+		}
+		else
+		{
+			ImGui::TextWrapped("Record to see the zones of the last frames");
+		}
+	}
+	ImGui::End();
+}
+
+void ProfilerView::DrawThread(const Profiler::ThreadZones& thread)
+{
+	// Threads that were idle the whole time get no lane
+	uint32_t maxDepth = 0;
+	bool visible = false;
+	for (const Profiler::Zone& zone : thread.Zones)
+	{
+		if (zone.Start > m_WindowEnd || zone.End < m_WindowStart)
+			continue;
+
+		maxDepth = std::max(maxDepth, zone.Depth);
+		visible = true;
+	}
+
+	if (!visible)
+		return;
+
+	ImGui::TextDisabled("%s", thread.ThreadName.c_str());
+
+	const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+	ImVec2 origin = ImGui::GetCursorScreenPos();
+	float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+	float height = rowHeight * (float)(maxDepth + 1);
+	double pixelsPerNanosecond = width / (double)(m_WindowEnd - m_WindowStart);
+
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	for (const Profiler::Zone& zone : thread.Zones)
+	{
+		if (zone.Start > m_WindowEnd || zone.End < m_WindowStart)
+			continue;
+
+		// Outermost zones on top, every zone at least a pixel wide
+		float minX = origin.x + (float)((std::max(zone.Start, m_WindowStart) - m_WindowStart) * pixelsPerNanosecond);
+		float maxX = origin.x + (float)((std::min(zone.End, m_WindowEnd) - m_WindowStart) * pixelsPerNanosecond);
+		maxX = std::max(maxX, minX + 1.0f);
+		float minY = origin.y + (float)zone.Depth * rowHeight;
+
+		ImVec2 zoneMin(minX, minY);
+		ImVec2 zoneMax(maxX, minY + rowHeight - 1.0f);
+		drawList->AddRectFilled(zoneMin, zoneMax, Utils::GetZoneColor(zone.Name));
+
+		if (ImGui::CalcTextSize(zone.Name).x + 4.0f < maxX - minX)
+			drawList->AddText(ImVec2(minX + 2.0f, minY + 2.0f), IM_COL32(0, 0, 0, 255), zone.Name);
+
+		if (ImGui::IsMouseHoveringRect(zoneMin, zoneMax))
+			ImGui::SetTooltip("%s\n%.3f ms", zone.Name, (zone.End - zone.Start) / 1.0e6);
+	}
+
+	for (uint64_t mark : m_FrameMarks)
+	{
+		float x = origin.x + (float)((mark - m_WindowStart) * pixelsPerNanosecond);
+		drawList->AddLine(ImVec2(x, origin.y), ImVec2(x, origin.y + height), IM_COL32(255, 255, 255, 96));
+	}
+
+	ImGui::Dummy(ImVec2(width, height));
+}
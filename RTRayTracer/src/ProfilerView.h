@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Profiler.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Profiler window: switches recording on and off, draws the zones of the last few UI frames as a flame graph with one
+// lane per thread and exports everything still buffered as a Chrome trace
+class ProfilerView
+{
+public:
+	void Draw();
+private:
+	void DrawThread(const Profiler::ThreadZones& thread);
+private:
+	int m_FrameCount = 3;
+	bool m_Paused = false;
+
+	// Snapshot shown, kept while paused
+	std::vector<Profiler::ThreadZones> m_Threads;
+	std::vector<uint64_t> m_FrameMarks;
+	uint64_t m_WindowStart = 0, m_WindowEnd = 0;
+
+	char m_TracePath[256] = "trace.json";
+	std::string m_Status;
+};
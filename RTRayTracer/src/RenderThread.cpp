@@ -0,0 +1,314 @@
+#include "RenderThread.h"
+
+#include "Profiler.h"
+#include "Walnut/Timer.h"
+
+#include <algorithm>
+
+RenderThread::RenderThread()
+	: m_PendingCamera(45.0f, 0.1f, 100.0f), m_Camera(45.0f, 0.1f, 100.0f)
+{
+	m_Thread = std::thread(&RenderThread::ThreadLoop, this);
+}
+
+RenderThread::~RenderThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+		m_CancelRequested = true;
+		m_Renderer.CancelFrame();
+	}
+	m_Condition.notify_all();
+	m_Thread.join();
+
+	m_PendingScene.DeleteObjects();
+	m_Scene.DeleteObjects();
+}
+
+void RenderThread::SetScene(const Scene& scene)
+{
+	ProfileZone zone("CloneScene");
+
+	Scene snapshot = scene.Clone();
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_PendingScene.DeleteObjects();
+	m_PendingScene = snapshot;
+	m_HasPendingScene = true;
+}
+
+void RenderThread::SetCamera(const Camera& camera)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_PendingCamera = camera;
+	m_HasPendingCamera = true;
+
+	// The frame in flight shows a view that is already stale
+	if (!m_OfflineRendering)
+		m_Renderer.CancelFrame();
+}
+
+void RenderThread::SetSettings(const Renderer::Settings& settings)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_PendingSettings = settings;
+}
+
+void RenderThread::SetViewportSize(uint32_t width, uint32_t height)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_ViewportWidth == width && m_ViewportHeight == height)
+			return;
+
+		m_ViewportWidth = width;
+		m_ViewportHeight = height;
+	}
+	m_Condition.notify_all();
+}
+
+void RenderThread::SetRealTime(bool realTime)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_RealTime == realTime)
+			return;
+
+		m_RealTime = realTime;
+	}
+	m_Condition.notify_all();
+}
+
+void RenderThread::SetGovernor(const FrameGovernor::Settings& settings)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_GovernorSettings = settings;
+}
+
+void RenderThread::ResetFrameIndex()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_ResetFrameRequested = true;
+
+	if (!m_OfflineRendering)
+		m_Renderer.CancelFrame();
+}
+
+void RenderThread::ResetImage()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_ResetImageRequested = true;
+}
+
+void RenderThread::StartOfflineRender(int samples, int previewInterval)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_OfflineRendering || samples <= 0)
+			return;
+
+		m_OfflineSamples = samples;
+		m_OfflinePreviewInterval = previewInterval;
+		m_OfflineSamplesDone = 0;
+		m_OfflineStartRequested = true;
+		m_OfflineRendering = true;
+		m_CancelRequested = false;
+	}
+	m_Condition.notify_all();
+}
+
+void RenderThread::CancelOfflineRender()
+{
+	m_CancelRequested = true;
+	m_Renderer.CancelFrame();
+}
+
+bool RenderThread::IsOfflineRendering() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_OfflineRendering;
+}
+
+float RenderThread::GetOfflineProgress() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_OfflineSamples <= 0)
+		return 0.0f;
+
+	return (float)m_OfflineSamplesDone / (float)m_OfflineSamples;
+}
+
+bool RenderThread::AcquireFrame(std::vector<uint32_t>& pixels, uint32_t& width, uint32_t& height)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (!m_HasNewFrame)
+		return false;
+
+	pixels.swap(m_FrontBuffer);
+	width = m_FrontWidth;
+	height = m_FrontHeight;
+	m_HasNewFrame = false;
+	return true;
+}
+
+void RenderThread::ThreadLoop()
+{
+	Profiler::SetThreadName("Render");
+	Walnut::Timer offlineTimer;
+
+	while (true)
+	{
+		bool offline = false;
+		uint32_t batchSize = 1;
+		uint32_t width = 0, height = 0;
+		FrameGovernor::Settings governorSettings;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this]()
+			{
+				return m_Stop || m_OfflineRendering || (m_RealTime && m_ViewportWidth > 0 && m_ViewportHeight > 0);
+			});
+
+			if (m_Stop)
+				return;
+
+			// A running offline job keeps rendering the snapshot it started with
+			if (m_OfflineStartRequested)
+			{
+				ApplyPendingChanges();
+				m_Renderer.ResetFrameIndex();
+
+				m_OfflineStartRequested = false;
+				offlineTimer.Reset();
+			}
+			else if (!m_OfflineRendering)
+			{
+				ApplyPendingChanges();
+			}
+
+			offline = m_OfflineRendering;
+			if (offline)
+			{
+				int remaining = m_OfflineSamples - m_OfflineSamplesDone;
+				batchSize = (uint32_t)(m_OfflinePreviewInterval > 0 ? std::min(m_OfflinePreviewInterval, remaining) : remaining);
+			}
+
+			width = m_ViewportWidth;
+			height = m_ViewportHeight;
+			governorSettings = m_GovernorSettings;
+		}
+
+		if (offline && (m_CancelRequested || width == 0 || height == 0))
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_OfflineRendering = false;
+			continue;
+		}
+
+		// Offline jobs keep the settings and size they were started with. Budgeted frames always take the budget,
+		// their time says nothing about the resolution the governor should pick. A crop window restarts whenever the
+		// resolution changes, so it keeps the full viewport size
+		const Renderer::Settings& rendererSettings = m_Renderer.GetSettings();
+		bool governed = !offline && governorSettings.Enabled && rendererSettings.FrameBudget <= 0.0f && !rendererSettings.UseCropWindow;
+		if (governed)
+		{
+			width = std::max((uint32_t)(width * m_Governor.GetResolutionScale()), 1u);
+			height = std::max((uint32_t)(height * m_Governor.GetResolutionScale()), 1u);
+			m_Renderer.GetSettings().RaysPerPixel = m_Governor.GetRaysPerPixel();
+		}
+		else if (!offline)
+		{
+			m_Governor.Reset();
+		}
+
+		ProfileZone frameZone("Frame");
+		Walnut::Timer frameTimer;
+
+		m_Renderer.OnResize(width, height);
+		m_Camera.OnResize(width, height);
+		bool refinementPass = !offline && m_Renderer.IsRefinementPending();
+		// Offline batches run in a single dispatch and are resolved once, instead of paying for a dispatch, resolve and
+		// upload per sample
+		if (offline)
+		{
+			if (!m_Renderer.RenderSamples(m_Scene, m_Camera, batchSize))
+				continue;
+
+			m_OfflineSamplesDone += batchSize;
+		}
+		// Cancelled frames go straight on to the next one with the latest snapshot. In realtime mode the tiles that did
+		// finish are still shown, so the viewport keeps updating while the camera moves faster than a full frame takes
+		else if (!m_Renderer.Render(m_Scene, m_Camera))
+		{
+			PublishFrame();
+			continue;
+		}
+
+		m_LastRenderTime = offline ? offlineTimer.ElapsedMillis() : frameTimer.ElapsedMillis();
+
+		// Only finished full frames are measured, cancelled ones stop at an arbitrary point and refinement passes only
+		// trace part of the pixels
+		if (governed && !refinementPass)
+		{
+			m_Governor.Update(governorSettings, m_LastRenderTime);
+			m_GovernorResolutionScale = m_Governor.GetResolutionScale();
+			m_GovernorRaysPerPixel = m_Governor.GetRaysPerPixel();
+		}
+
+		PublishFrame();
+
+		if (offline && m_OfflineSamplesDone >= m_OfflineSamples)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_OfflineRendering = false;
+		}
+	}
+}
+
+void RenderThread::ApplyPendingChanges()
+{
+	ProfileZone zone("ApplyChanges");
+
+	if (m_HasPendingScene)
+	{
+		m_Scene.DeleteObjects();
+		m_Scene = m_PendingScene;
+		m_PendingScene = Scene();
+		m_HasPendingScene = false;
+	}
+
+	// The UI camera is never resized, so the copy recalculates its ray directions on the render thread
+	if (m_HasPendingCamera)
+	{
+		m_Camera = m_PendingCamera;
+		m_HasPendingCamera = false;
+	}
+
+	m_Renderer.GetSettings() = m_PendingSettings;
+
+	if (m_ResetImageRequested && m_ViewportWidth > 0 && m_ViewportHeight > 0)
+		m_Renderer.ResetImage(m_ViewportWidth, m_ViewportHeight);
+	if (m_ResetFrameRequested)
+		m_Renderer.ResetFrameIndex();
+
+	m_ResetImageRequested = false;
+	m_ResetFrameRequested = false;
+}
+
+void RenderThread::PublishFrame()
+{
+	ProfileZone zone("PublishFrame");
+
+	const uint32_t* imageData = m_Renderer.GetImageData();
+	uint32_t pixelCount = m_Renderer.GetWidth() * m_Renderer.GetHeight();
+	m_BackBuffer.assign(imageData, imageData + pixelCount);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_FrontBuffer.swap(m_BackBuffer);
+	m_FrontWidth = m_Renderer.GetWidth();
+	m_FrontHeight = m_Renderer.GetHeight();
+	m_HasNewFrame = true;
+
+	m_FrameIndex = m_Renderer.GetFrameIndex();
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Renderer.h"
+#include "Camera.h"
+#include "FrameGovernor.h"
+#include "Scene.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs the Renderer on its own thread so a slow frame never blocks the UI.
+// The UI hands over snapshots of scene, camera and settings, the render thread picks them up at the start of its next frame
+// and publishes every finished frame to a front buffer that the UI swaps out whenever it is ready.
+class RenderThread
+{
+public:
+	RenderThread();
+	~RenderThread();
+
+	// The scene is deep copied, the UI may keep editing its own objects
+	void SetScene(const Scene& scene);
+	void SetCamera(const Camera& camera);
+	void SetSettings(const Renderer::Settings& settings);
+	void SetViewportSize(uint32_t width, uint32_t height);
+	void SetRealTime(bool realTime);
+	// While enabled, realtime frames render at a fraction of the viewport size with the rays per pixel the governor picks
+	void SetGovernor(const FrameGovernor::Settings& settings);
+
+	void ResetFrameIndex();
+	void ResetImage();
+
+	// Renders the given amount of samples from the current snapshot, later snapshots are held back until the job ends.
+	// Samples are traced in batches of previewInterval, only the image of a finished batch is published (0 = one batch).
+	void StartOfflineRender(int samples, int previewInterval = 0);
+	void CancelOfflineRender();
+	bool IsOfflineRendering() const;
+	float GetOfflineProgress() const;
+
+	// Swaps the newest finished frame into pixels, returns false if no frame finished since the last call
+	bool AcquireFrame(std::vector<uint32_t>& pixels, uint32_t& width, uint32_t& height);
+
+	float GetLastRenderTime() const { return m_LastRenderTime; }
+	int GetFrameIndex() const { return m_FrameIndex; }
+	float GetGovernorResolutionScale() const { return m_GovernorResolutionScale; }
+	int GetGovernorRaysPerPixel() const { return m_GovernorRaysPerPixel; }
+private:
+	void ThreadLoop();
+	void ApplyPendingChanges();
+	void PublishFrame();
+private:
+	std::thread m_Thread;
+
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	bool m_Stop = false;
+
+	// Written by the UI, applied by the render thread (guarded by m_Mutex)
+	Scene m_PendingScene;
+	bool m_HasPendingScene = false;
+	Camera m_PendingCamera;
+	bool m_HasPendingCamera = false;
+	Renderer::Settings m_PendingSettings;
+	uint32_t m_ViewportWidth = 0, m_ViewportHeight = 0;
+	bool m_RealTime = true;
+	FrameGovernor::Settings m_GovernorSettings;
+	bool m_ResetFrameRequested = false;
+	bool m_ResetImageRequested = false;
+
+	int m_OfflineSamples = 0;
+	int m_OfflinePreviewInterval = 0;
+	bool m_OfflineStartRequested = false;
+	bool m_OfflineRendering = false;
+
+	// Only touched by the render thread
+	Renderer m_Renderer;
+	Scene m_Scene;
+	Camera m_Camera;
+	FrameGovernor m_Governor;
+	std::vector<uint32_t> m_BackBuffer;
+
+	// Last finished frame (guarded by m_Mutex)
+	std::vector<uint32_t> m_FrontBuffer;
+	uint32_t m_FrontWidth = 0, m_FrontHeight = 0;
+	bool m_HasNewFrame = false;
+
+	std::atomic<int> m_OfflineSamplesDone{ 0 };
+	std::atomic<bool> m_CancelRequested{ false };
+
+	std::atomic<float> m_LastRenderTime{ 0.0f };
+	std::atomic<int> m_FrameIndex{ 1 };
+	std::atomic<float> m_GovernorResolutionScale{ 1.0f };
+	std::atomic<int> m_GovernorRaysPerPixel{ 1 };
+};
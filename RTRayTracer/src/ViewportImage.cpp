@@ -0,0 +1,21 @@
+#include "ViewportImage.h"
+
+#include "imgui.h"
+
+void ViewportImage::SetData(const uint32_t* pixels, uint32_t width, uint32_t height)
+{
+	if (!m_Image)
+		m_Image = std::make_shared<Walnut::Image>(width, height, Walnut::ImageFormat::RGBA);
+	else if (m_Image->GetWidth() != width || m_Image->GetHeight() != height)
+		m_Image->Resize(width, height);
+
+	m_Image->SetData(pixels);
+}
+
+void ViewportImage::Draw(float width, float height) const
+{
+	if (!m_Image)
+		return;
+
+	ImGui::Image(m_Image->GetDescriptorSet(), { width, height }, ImVec2(0, 1), ImVec2(1, 0));
+}
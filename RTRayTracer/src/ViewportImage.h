@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Walnut/Image.h"
+
+#include <cstdint>
+#include <memory>
+
+// Shows the CPU pixels of the Renderer in the viewport through a Walnut image that follows their size
+class ViewportImage
+{
+public:
+	// Packed RGBA8 pixels, rows bottom to top as the Renderer writes them
+	void SetData(const uint32_t* pixels, uint32_t width, uint32_t height);
+
+	// Stretches the image over the given size, flipped so the bottom row ends up at the bottom
+	void Draw(float width, float height) const;
+
+	bool HasImage() const { return m_Image != nullptr; }
+private:
+	std::shared_ptr<Walnut::Image> m_Image;
+};
@@ -1,17 +1,23 @@
 #include "Walnut/Application.h"
 #include "Walnut/EntryPoint.h"
 
-#include "Walnut/Image.h"
 #include "Walnut/Random.h"
 #include "Walnut/Timer.h"
 #include "Walnut/Input/Input.h"
 
 #include "Renderer.h"
+#include "RenderThread.h"
 #include "Camera.h"
+#include "CameraController.h"
+#include "Profiler.h"
+#include "ProfilerView.h"
+#include "ViewportImage.h"
+#include "SceneFile.h"
+#include "ScenePresets.h"
 
 #include <glm/gtc/type_ptr.hpp>
 
-#include "lodepng.h"
+#include "ImageIO.h"
 
 #include <vector>
 #include <iostream>
@@ -22,10 +28,6 @@
 
 using namespace Walnut;
 
-struct Color {
-	uint8_t r, g, b, a;
-};
-
 class ExampleLayer : public Walnut::Layer
 {
 public:
@@ -65,268 +67,81 @@ public:
 			m_Scene.SceneObjects.push_back(floor);
 
 			m_Scene.SkyColor = glm::vec3(0.55f, 0.55f, 0.55f);
+
+			m_RenderThread.SetCamera(m_Camera);
+
+			Profiler::SetThreadName("UI");
 	}
 
 	virtual void OnUpdate(float ts) override
 	{
-		if (m_Camera.OnUpdate(ts))
+		Profiler::MarkFrame();
+		ProfileZone zone("Update");
+
+		if (m_CameraController.OnUpdate(m_Camera, ts))
 		{
-			m_Renderer.ResetFrameIndex();
+			m_RenderThread.SetCamera(m_Camera);
+			m_RenderThread.ResetFrameIndex();
 		}
 	}
 
-	Color ConvertFromRGBA(uint32_t colorData)
-	{
-		Color color;
-
-		color.r = colorData & 0xFF;           // Extract red component
-		color.g = (colorData >> 8) & 0xFF;   // Extract green component
-		color.b = (colorData >> 16) & 0xFF;  // Extract blue component
-		color.a = (colorData >> 24) & 0xFF;  // Extract alpha component
-
-		return color;
-	}
-
 	void SaveImageFile() {
-		int imageSize = m_Renderer.GetFinalImage()->GetWidth() * m_Renderer.GetFinalImage()->GetHeight() * 4;
-
-		std::vector<std::uint8_t> PngBuffer(imageSize);
-
-		for (std::int32_t I = 0; I < m_Renderer.GetFinalImage()->GetHeight(); ++I) {
-			for (std::int32_t J = 0; J < m_Renderer.GetFinalImage()->GetWidth(); ++J) {
-				std::size_t NewPos = (I * m_Renderer.GetFinalImage()->GetWidth() + J) * 4;
-				Color pixelColor = ConvertFromRGBA(m_Renderer.GetPixelAt(J, I));			
-				PngBuffer[NewPos + 0] = pixelColor.r; // B is offset 0
-				PngBuffer[NewPos + 1] = pixelColor.g; // G is offset 1
-				PngBuffer[NewPos + 2] = pixelColor.b; // R is offset 2
-				PngBuffer[NewPos + 3] = pixelColor.a; // A is offset 3sas
-			}
-		}
+		ProfileZone zone("SaveImageFile");
 
-		std::vector<uint8_t> FlippedBuffer(PngBuffer.size());
-		int width = m_Renderer.GetFinalImage()->GetWidth();
-		int height = m_Renderer.GetFinalImage()->GetHeight();
+		std::string fileName = std::string(m_ImageFileName) + ".png";
+		ImageIO::SavePNG(fileName, m_ImageData.data(), m_ImageWidth, m_ImageHeight);
+	}
 
-		for (int y = 0; y < height; ++y) {
-			int flippedY = height - y - 1; // Calculate the flipped row position
-			std::memcpy(&FlippedBuffer[flippedY * width * 4], &PngBuffer[y * width * 4], width * 4);
-		}
+	void LoadSceneFile()
+	{
+		if (!SceneFile::Load(m_SceneFileName, m_Scene, m_Camera, m_SceneFileStatus))
+			return;
 
-		std::vector<std::uint8_t> ImageBuffer;
-		lodepng::encode(ImageBuffer, FlippedBuffer, m_Renderer.GetFinalImage()->GetWidth(), m_Renderer.GetFinalImage()->GetHeight());
+		m_SceneFileStatus = "Loaded " + std::string(m_SceneFileName);
+		m_RenderThread.SetCamera(m_Camera);
+		OnSceneReplaced();
+	}
 
-		std::string fileName = std::string(m_ImageFileName) + ".png";
-		lodepng::save_file(ImageBuffer, fileName);
+	void SaveSceneFile()
+	{
+		if (SceneFile::SaveText(m_SceneFileName, m_Scene, m_Camera, m_SceneFileStatus))
+			m_SceneFileStatus = "Saved " + std::string(m_SceneFileName);
 	}
 
 	void ResetScene()
 	{
-		m_Scene = Scene();
-
-		m_Renderer.ResetFrameIndex();
-
-		Material& defaultMaterial = m_Scene.Materials.emplace_back();
-		defaultMaterial.Color = { 0.5f, 0.5f, 0.5f };
-		defaultMaterial.Smoothness = 0.05f;
+		ScenePresets::Empty(m_Scene);
+		OnSceneReplaced();
 	}
 
 	void TwoSpheres()
 	{
-		ResetScene();
-
-		Material& defaultMaterial2 = m_Scene.Materials.emplace_back();
-		defaultMaterial2.Color = { 0.7f, 0.7f, 0.7f };
-		defaultMaterial2.Smoothness = 0.95f;
-
-		Material& defaultMaterial3 = m_Scene.Materials.emplace_back();
-		defaultMaterial3.Color = { 0.7f, 0.7f, 0.7f };
-		defaultMaterial3.Smoothness = 0.0f;
-		defaultMaterial3.EmissionColor = glm::vec3(1.0f);
-		defaultMaterial3.EmissionPower = 2.0f;
-
-		Sphere* sphere = new Sphere();
-		sphere->Position = { -1.5f, 0.0f, 0.0f };
-		sphere->Radius = 1.0f;
-		sphere->MaterialIndex = 1;
-		m_Scene.SceneObjects.push_back(sphere);
-
-		Sphere* sphere2 = new Sphere();
-		sphere2->Position = { 1.5f, 0.0f, 0.0f };
-		sphere2->Radius = 1.0f;
-		sphere2->MaterialIndex = 2;
-		m_Scene.SceneObjects.push_back(sphere2);
-
-		Cube* floor = new Cube();
-		floor->Position = { 0.0f, -1.0f, 0.0f };
-		floor->Dimensions = glm::vec3(1000.0f, 0.01f, 1000.0f);
-		floor->MaterialIndex = 0;
-		m_Scene.SceneObjects.push_back(floor);
-
-		m_Scene.SkyColor = glm::vec3(0.75f, 0.75f, 0.75f);
+		ScenePresets::TwoSpheres(m_Scene);
+		OnSceneReplaced();
 	}
 
 	void RefractionTest()
 	{
-		ResetScene();
-
-		Material& glassSphere1 = m_Scene.Materials.emplace_back();
-		glassSphere1.Color = { 0.8f, 0.2f, 0.3f };
-		glassSphere1.Smoothness = 0.985f;
-		glassSphere1.Transmission = 0.95f;
-		glassSphere1.IOR = 1.5f;
-
-		Material& glassSphere2 = m_Scene.Materials.emplace_back();
-		glassSphere2.Color = { 0.3f, 0.8f, 0.2f };
-		glassSphere2.Smoothness = 0.985f;
-		glassSphere2.Transmission = 0.95f;
-		glassSphere2.IOR = 1.5f;
-
-		Material& glassSphere3 = m_Scene.Materials.emplace_back();
-		glassSphere3.Color = { 0.2f, 0.3f, 0.8f };
-		glassSphere3.Smoothness = 0.985f;
-		glassSphere3.Transmission = 0.95f;
-		glassSphere3.IOR = 1.5f;
-
-		Material& emissiveSphere = m_Scene.Materials.emplace_back();
-		emissiveSphere.EmissionColor = { 0.8f, 0.7f, 0.9f };
-		emissiveSphere.EmissionPower = 25.0f;
-
-		Sphere* sphere = new Sphere();
-		sphere->Position = { 0.0f, -102.0f, 0.0f };
-		sphere->Radius = 100.0f;
-		sphere->MaterialIndex = 0;
-		m_Scene.SceneObjects.push_back(sphere);
-
-		Sphere* sphere2 = new Sphere();
-		sphere2->Position = { 0.0f, 2.5f, -10.0f };
-		sphere2->Radius = 2.5f;
-		sphere2->MaterialIndex = 4;
-		m_Scene.SceneObjects.push_back(sphere2);
-
-		Sphere* sphere3 = new Sphere();
-		sphere3->Position = { 2.5f, -1.0f, 0.0f };
-		sphere3->Radius = 1.0f;
-		sphere3->MaterialIndex = 1;
-		m_Scene.SceneObjects.push_back(sphere3);
-
-		Sphere* sphere4 = new Sphere();
-		sphere4->Position = { 0.0f, -1.0f, 0.0f };
-		sphere4->Radius = 1.0f;
-		sphere4->MaterialIndex = 2;
-		m_Scene.SceneObjects.push_back(sphere4);
-
-		Sphere* sphere5 = new Sphere();
-		sphere5->Position = { -2.5f, -1.0f, 0.0f };
-		sphere5->Radius = 1.0f;
-		sphere5->MaterialIndex = 3;
-		m_Scene.SceneObjects.push_back(sphere5);
-
-		m_Scene.SkyColor = glm::vec3(0.05f, 0.05f, 0.05f);
+		ScenePresets::RefractionTest(m_Scene);
+		OnSceneReplaced();
 	}
 
 	void ColorRoom()
 	{
-		ResetScene();
-
-		Material& defaultMaterial2 = m_Scene.Materials.emplace_back();
-		defaultMaterial2.Color = { 0.9f, 0.9f, 0.9f };
-		defaultMaterial2.Smoothness = 0.125f;
-
-		Material& defaultMaterial3 = m_Scene.Materials.emplace_back();
-		defaultMaterial3.Color = { 0.8f, 0.8f, 0.8f };
-		defaultMaterial3.Smoothness = 0.0f;
-		defaultMaterial3.EmissionColor = glm::vec3(1.0f);
-		defaultMaterial3.EmissionPower = 5.0f;
-
-		Material& redMaterial = m_Scene.Materials.emplace_back();
-		redMaterial.Color = { 0.8f, 0.1f, 0.1f };
-		redMaterial.Smoothness = 0.0f;
-
-		Material& greenMaterial = m_Scene.Materials.emplace_back();
-		greenMaterial.Color = { 0.1f, 0.8f, 0.1f };
-		greenMaterial.Smoothness = 0.0f;
-
-		Material& reflectiveMaterial = m_Scene.Materials.emplace_back();
-		reflectiveMaterial.Color = { 0.85f, 0.85f, 0.85f };
-		reflectiveMaterial.Smoothness = 0.975f;
-		reflectiveMaterial.Metallness = 0.95f;
-
-		Material& transmissiveMaterial = m_Scene.Materials.emplace_back();
-		transmissiveMaterial.Color = { 0.85f, 0.85f, 0.85f };
-		transmissiveMaterial.Smoothness = 0.875f;
-		transmissiveMaterial.Metallness = 0.95f;
-		transmissiveMaterial.Transmission = 0.85f;
-		transmissiveMaterial.IOR = 1.45f;
-
-		Material& colorMaterial = m_Scene.Materials.emplace_back();
-		colorMaterial.Color = { 0.1f, 0.225f, 0.65f };
-		colorMaterial.Smoothness = 0.225f;
-
-		Sphere* glassSphere = new Sphere();
-		glassSphere->Position = { -1.25f, -1.5f, -0.25f };
-		glassSphere->Radius = 1.0f;
-		glassSphere->MaterialIndex = 6;
-		m_Scene.SceneObjects.push_back(glassSphere);
-
-		Sphere* reflectiveSphere = new Sphere();
-		reflectiveSphere->Position = { 1.25f, -1.5f, 0.25f };
-		reflectiveSphere->Radius = 1.0f;
-		reflectiveSphere->MaterialIndex = 5;
-		m_Scene.SceneObjects.push_back(reflectiveSphere);
-
-		Sphere* colorSphere = new Sphere();
-		colorSphere->Position = { -0.25f, -2.0f, 0.45f };
-		colorSphere->Radius = 0.5f;
-		colorSphere->MaterialIndex = 7;
-		m_Scene.SceneObjects.push_back(colorSphere);
-
-		Cube* floor = new Cube();
-		floor->Position = { 0.0f, -2.5f, 5.0f };
-		floor->Dimensions = glm::vec3(2.5f, 0.001f, 10.0f);
-		floor->MaterialIndex = 1;
-		m_Scene.SceneObjects.push_back(floor);
-
-		Cube* ceiling = new Cube();
-		ceiling->Position = { 0.0f, 2.5f, 5.0f };
-		ceiling->Dimensions = glm::vec3(2.5f, 0.001f, 10.0f);
-		ceiling->MaterialIndex = 1;
-		m_Scene.SceneObjects.push_back(ceiling);
-
-		Cube* wallLeft = new Cube();
-		wallLeft->Position = { -2.5f, 0.0f, 5.0f };
-		wallLeft->Dimensions = glm::vec3(0.001f, 2.5f, 10.0f);
-		wallLeft->MaterialIndex = 3;
-		m_Scene.SceneObjects.push_back(wallLeft);
-
-		Cube* wallRight = new Cube();
-		wallRight->Position = { 2.5f, 0.0f, 5.0f };
-		wallRight->Dimensions = glm::vec3(0.001f, 2.5f, 10.0f);
-		wallRight->MaterialIndex = 4;
-		m_Scene.SceneObjects.push_back(wallRight);
-
-		Cube* wallBack = new Cube();
-		wallBack->Position = { 0.0f, 0.0f, -2.5f };
-		wallBack->Dimensions = glm::vec3(2.5f, 2.5f, 0.001f);
-		wallBack->MaterialIndex = 1;
-		m_Scene.SceneObjects.push_back(wallBack);
-
-		Cube* wallFront = new Cube();
-		wallFront->Position = { 0.0f, 0.0f, 10.0f };
-		wallFront->Dimensions = glm::vec3(2.5f, 2.5f, 0.001f);
-		wallFront->MaterialIndex = 1;
-		m_Scene.SceneObjects.push_back(wallFront);
-
-		Cube* ceilingLight = new Cube();
-		ceilingLight->Position = { 0.0f, 2.4f, 0.0f };
-		ceilingLight->Dimensions = glm::vec3(1.0f, 0.05f, 1.0f);
-		ceilingLight->MaterialIndex = 2;
-		m_Scene.SceneObjects.push_back(ceilingLight);
-
-		m_Scene.SkyColor = glm::vec3(0.0f, 0.0f, 0.0f);
+		ScenePresets::ColorRoom(m_Scene);
+		OnSceneReplaced();
+	}
+
+	void OnSceneReplaced()
+	{
+		m_SceneChanged = true;
+		m_RenderThread.ResetFrameIndex();
 	}
 
 	virtual void OnUIRender() override
 	{
+		ProfileZone zone("UI");
+
 		ImGui::Begin("File");
 		{
 			ImGui::Text("Export Render: ");
@@ -334,7 +149,7 @@ public:
 
 			ImGui::InputText("Image File Name", m_ImageFileName, IM_ARRAYSIZE(m_ImageFileName));
 
-			if (m_Renderer.DoesImageExist()) {
+			if (!m_ImageData.empty()) {
 				if (ImGui::Button("Save Render"))
 				{
 					SaveImageFile();
@@ -343,6 +158,17 @@ public:
 
 			ImGui::Spacing();
 
+			ImGui::InputText("Scene File", m_SceneFileName, IM_ARRAYSIZE(m_SceneFileName));
+			if (ImGui::Button("Load Scene"))
+				LoadSceneFile();
+			ImGui::SameLine();
+			if (ImGui::Button("Save Scene"))
+				SaveSceneFile();
+			if (!m_SceneFileStatus.empty())
+				ImGui::TextWrapped("%s", m_SceneFileStatus.c_str());
+
+			ImGui::Spacing();
+
 			if (ImGui::Button("Two Spheres"))
 			{
 				TwoSpheres();
@@ -367,7 +193,7 @@ public:
 
 		ImGui::Begin("Settings");
 		{
-			ImGui::Text("Rendertime: %.3fms Samples Rendered: %d", m_LastRenderTime, m_Renderer.GetFrameIndex()-1);
+			ImGui::Text("Rendertime: %.3fms Samples Rendered: %d", m_RenderThread.GetLastRenderTime(), m_RenderThread.GetFrameIndex()-1);
 
 			ImGui::Separator();
 
@@ -376,49 +202,90 @@ public:
 			ImGui::Spacing();
 
 			ImGui::Checkbox("Realtime", &m_IsRealTime);
-			ImGui::Checkbox("Accumulate", &m_Renderer.GetSettings().Accumulate);
-			ImGui::Checkbox("Slow Random", &m_Renderer.GetSettings().SlowRandom);
+			ImGui::Checkbox("Accumulate", &m_RenderSettings.Accumulate);
+			ImGui::Checkbox("Progressive Refinement", &m_RenderSettings.ProgressiveRefinement);
+			ImGui::DragFloat("Frame Budget (ms, 0 = One Pass)", &m_RenderSettings.FrameBudget, 0.5f, 0.0f, 1000.0f);
+			ImGui::Checkbox("Slow Random", &m_RenderSettings.SlowRandom);
 
 			ImGui::Spacing();
 			ImGui::Separator();
 			ImGui::Spacing();
 
 			ImGui::SliderFloat("Resolution Scale", &m_ResolutionScale, 0.25f, 2.0f);
-			ImGui::SliderInt("Light Bounces", &m_Renderer.GetSettings().LightBounces, 0, 250);
-			ImGui::SliderInt("Rays Per Pixel", &m_Renderer.GetSettings().RaysPerPixel, 0, 25);
-			ImGui::DragFloat("Anti Alias Radius", &m_Renderer.GetSettings().AntiAliasingAmount, 0.01f, 0, 50);
+			ImGui::SliderInt("Light Bounces", &m_RenderSettings.LightBounces, 0, 250);
+			ImGui::SliderInt("Rays Per Pixel", &m_RenderSettings.RaysPerPixel, 0, 25);
+
+			// The governor scales down from the resolution scale and overrides the rays per pixel, a frame budget turns it off
+			ImGui::Checkbox("Frame Governor", &m_GovernorSettings.Enabled);
+			if (m_GovernorSettings.Enabled)
+			{
+				ImGui::DragFloat("Target Frame Time (ms)", &m_GovernorSettings.TargetFrameTime, 0.1f, 1.0f, 1000.0f);
+				ImGui::SliderFloat("Min Resolution Scale", &m_GovernorSettings.MinResolutionScale, 0.0625f, 1.0f);
+				ImGui::SliderInt("Max Rays Per Pixel", &m_GovernorSettings.MaxRaysPerPixel, 1, 64);
+				ImGui::Text("Governor: %.0f%% resolution, %d rays per pixel", m_RenderThread.GetGovernorResolutionScale() * 100.0f,
+					m_RenderThread.GetGovernorRaysPerPixel());
+			}
+
+			ImGui::Checkbox("Split Paths At First Hit", &m_RenderSettings.SplitPrimaryPaths);
 
-			if(!m_IsRealTime)
+			// Shift + left drag in the viewport places the crop window
+			ImGui::Checkbox("Crop Window", &m_RenderSettings.UseCropWindow);
+			if (m_RenderSettings.UseCropWindow)
+			{
+				ImGui::SliderInt("Crop Samples Per Frame", &m_RenderSettings.CropSamplesPerFrame, 1, 64);
+				if (ImGui::Button("Clear Crop"))
+				{
+					m_RenderSettings.UseCropWindow = false;
+					m_RenderSettings.CropMin = glm::vec2(0.0f);
+					m_RenderSettings.CropMax = glm::vec2(1.0f);
+				}
+			}
+
+			const char* pixelFilters[] = { "Box", "Tent", "Blackman-Harris" };
+			int pixelFilter = (int)m_RenderSettings.Filter;
+			if (ImGui::Combo("Pixel Filter", &pixelFilter, pixelFilters, IM_ARRAYSIZE(pixelFilters)))
+				m_RenderSettings.Filter = (Renderer::PixelFilter)pixelFilter;
+
+			ImGui::SliderInt("Tile Size", &m_RenderSettings.TileSize, 4, 64);
+
+			const char* tileOrders[] = { "Scanline", "Morton", "Hilbert" };
+			int tileOrder = (int)m_RenderSettings.Order;
+			if (ImGui::Combo("Tile Order", &tileOrder, tileOrders, IM_ARRAYSIZE(tileOrders)))
+				m_RenderSettings.Order = (Renderer::TileOrder)tileOrder;
+
+			ImGui::SliderInt("Render Threads (0 = Auto)", &m_RenderSettings.ThreadCount, 0, 256);
+			ImGui::Checkbox("Pin Render Threads", &m_RenderSettings.PinThreads);
+
+			if (!m_IsRealTime)
+			{
 				ImGui::DragInt("Samples", &m_Samples);
+				ImGui::DragInt("Preview Every (0 = At End)", &m_PreviewInterval, 1.0f, 0, 4096);
+			}
 
 			ImGui::Spacing();
 			ImGui::Separator();
 			ImGui::Spacing();
 
 			ImGui::Text("Debug Settings");
-			ImGui::Checkbox("Display Surface Normals", &m_Renderer.GetSettings().DisplayNormals);
+			ImGui::Checkbox("Display Surface Normals", &m_RenderSettings.DisplayNormals);
 
 			ImGui::Spacing();
 			ImGui::Separator();
 			ImGui::Spacing();
 
-			if (!m_IsRealTime) {
-				if (ImGui::Button("Render")) {
-					Timer time;
-
-					m_Renderer.ResetFrameIndex();
-					for (int samples = 0; samples < m_Samples; samples++) 
-					{
-						Render();
-					}
-
-					m_LastRenderTime = time.ElapsedMillis();
-				}
+			if (m_RenderThread.IsOfflineRendering()) {
+				ImGui::ProgressBar(m_RenderThread.GetOfflineProgress());
+				if (ImGui::Button("Cancel"))
+					m_RenderThread.CancelOfflineRender();
+			}
+			else if (!m_IsRealTime) {
+				if (ImGui::Button("Render"))
+					m_RenderThread.StartOfflineRender(m_Samples, m_PreviewInterval);
 			}
 
 			if (ImGui::Button("Reset")) {
-				m_Renderer.ResetFrameIndex();
-				m_Renderer.ResetImage(m_ViewportWidth, m_ViewportHeight);
+				m_RenderThread.ResetFrameIndex();
+				m_RenderThread.ResetImage();
 			}
 		}
 		ImGui::End();
@@ -426,11 +293,11 @@ public:
 		ImGui::Begin("Materials");
 		{
 			ImGui::Text("Scene Settings");
-			ImGui::ColorEdit3("Sky Color", glm::value_ptr(m_Scene.SkyColor));
+			m_SceneChanged |= ImGui::ColorEdit3("Sky Color", glm::value_ptr(m_Scene.SkyColor));
 			
-			//ImGui::SliderFloat("Defocus Strength", &m_Renderer.GetSettings().DefocusStrength, 0.0f, 500.0f);
-			//ImGui::SliderFloat("Defocus Distance", &m_Renderer.GetSettings().DefocusDist, 0.0f, 150.0f);
-			//ImGui::SliderFloat3("Defocus Distance", glm::value_ptr(m_Renderer.GetSettings().DefocusDist), 0.0f, 150.0f);
+			//ImGui::SliderFloat("Defocus Strength", &m_RenderSettings.DefocusStrength, 0.0f, 500.0f);
+			//ImGui::SliderFloat("Defocus Distance", &m_RenderSettings.DefocusDist, 0.0f, 150.0f);
+			//ImGui::SliderFloat3("Defocus Distance", glm::value_ptr(m_RenderSettings.DefocusDist), 0.0f, 150.0f);
 
 			ImGui::Separator();
 
@@ -446,19 +313,19 @@ public:
 				if (ImGui::CollapsingHeader(headerNameChar))
 				{
 					Material& material = m_Scene.Materials[i];
-					ImGui::ColorEdit3("Color", glm::value_ptr(material.Color));
-					ImGui::SliderFloat("Smoothness", &material.Smoothness, 0.0f, 1.0f);
-					ImGui::SliderFloat("Metallic", &material.Metallness, 0.05f, 1.0f);
+					m_SceneChanged |= ImGui::ColorEdit3("Color", glm::value_ptr(material.Color));
+					m_SceneChanged |= ImGui::SliderFloat("Smoothness", &material.Smoothness, 0.0f, 1.0f);
+					m_SceneChanged |= ImGui::SliderFloat("Metallic", &material.Metallness, 0.05f, 1.0f);
 
 					ImGui::Separator();
 
-					ImGui::ColorEdit3("Emission Color", glm::value_ptr(material.EmissionColor));
-					ImGui::DragFloat("Emission Power", &material.EmissionPower, 0.01f, 0.0f, FLT_MAX);
+					m_SceneChanged |= ImGui::ColorEdit3("Emission Color", glm::value_ptr(material.EmissionColor));
+					m_SceneChanged |= ImGui::DragFloat("Emission Power", &material.EmissionPower, 0.01f, 0.0f, FLT_MAX);
 					
 					ImGui::Separator();
 
-					ImGui::SliderFloat("Transmission Amount", &material.Transmission, 0.0f, 1.0f);
-					ImGui::SliderFloat("Index Of Refraction", &material.IOR, 0.0f, 10.0f);
+					m_SceneChanged |= ImGui::SliderFloat("Transmission Amount", &material.Transmission, 0.0f, 1.0f);
+					m_SceneChanged |= ImGui::SliderFloat("Index Of Refraction", &material.IOR, 0.0f, 10.0f);
 
 					ImGui::Separator();
 
@@ -468,6 +335,7 @@ public:
 					{
 						Material& defaultMaterial = material;
 						m_Scene.Materials.emplace_back(defaultMaterial);
+						m_SceneChanged = true;
 					}
 				}
 
@@ -481,6 +349,7 @@ public:
 				Material& newMaterial = m_Scene.Materials.emplace_back();
 				newMaterial.Color = { 1.0f, 1.0f, 1.0f };
 				newMaterial.Smoothness = 1.0f;
+				m_SceneChanged = true;
 			}
 		}
 		ImGui::End();
@@ -498,24 +367,32 @@ public:
 				if (Cube* cube = dynamic_cast<Cube*>(rtobject))
 				{
 					ImGui::Text("[Cube %d] General Settings: ", i);
-					ImGui::DragFloat3("Position", glm::value_ptr(cube->Position), 0.01f);
-					ImGui::DragInt("Material Index", &cube->MaterialIndex, 1.0f, 0.0, (int)m_Scene.Materials.size() - 1);
+					m_SceneChanged |= ImGui::DragFloat3("Position", glm::value_ptr(cube->Position), 0.01f);
+					m_SceneChanged |= ImGui::DragInt("Material Index", &cube->MaterialIndex, 1.0f, 0.0, (int)m_Scene.Materials.size() - 1);
 
 					ImGui::Text("[Cube %d] Object specific Settings: ", i);
-					ImGui::DragFloat3("Dimensions", glm::value_ptr(cube->Dimensions), 0.01f);
+					m_SceneChanged |= ImGui::DragFloat3("Dimensions", glm::value_ptr(cube->Dimensions), 0.01f);
 
-					if (ImGui::Button("X")) m_Scene.SceneObjects.erase(m_Scene.SceneObjects.begin() + i);
+					if (ImGui::Button("X"))
+					{
+						m_Scene.SceneObjects.erase(m_Scene.SceneObjects.begin() + i);
+						m_SceneChanged = true;
+					}
 				}
 				else if (Sphere* sphere = dynamic_cast<Sphere*>(rtobject))
 				{
 					ImGui::Text("[Sphere %d] General Settings: ", i);
-					ImGui::DragFloat3("Position", glm::value_ptr(sphere->Position), 0.01f);
-					ImGui::DragInt("Material Index", &sphere->MaterialIndex, 1.0f, 0.0, (int)m_Scene.Materials.size() - 1);
+					m_SceneChanged |= ImGui::DragFloat3("Position", glm::value_ptr(sphere->Position), 0.01f);
+					m_SceneChanged |= ImGui::DragInt("Material Index", &sphere->MaterialIndex, 1.0f, 0.0, (int)m_Scene.Materials.size() - 1);
 
 					ImGui::Text("[Sphere %d] Object specific Settings: ", i);
-					ImGui::DragFloat("Radius", &sphere->Radius, 0.01f);
+					m_SceneChanged |= ImGui::DragFloat("Radius", &sphere->Radius, 0.01f);
 
-					if (ImGui::Button("X")) m_Scene.SceneObjects.erase(m_Scene.SceneObjects.begin() + i);
+					if (ImGui::Button("X"))
+					{
+						m_Scene.SceneObjects.erase(m_Scene.SceneObjects.begin() + i);
+						m_SceneChanged = true;
+					}
 				}
 
 				ImGui::Separator();
@@ -532,6 +409,7 @@ public:
 				sphere->Radius = 1.0f;
 				sphere->MaterialIndex = 0;
 				m_Scene.SceneObjects.push_back(sphere);
+				m_SceneChanged = true;
 			}
 
 			if (ImGui::Button("Add new Cube"))
@@ -541,6 +419,7 @@ public:
 				cube->Dimensions = glm::vec3(1.0f);
 				cube->MaterialIndex = 0;
 				m_Scene.SceneObjects.push_back(cube);
+				m_SceneChanged = true;
 			}
 		}
 		ImGui::End();
@@ -552,53 +431,128 @@ public:
 			m_ViewportWidth = ImGui::GetContentRegionAvail().x;
 			m_ViewportHeight = ImGui::GetContentRegionAvail().y;
 
-			auto image = m_Renderer.GetFinalImage();
-			if (image)
-				ImGui::Image(image->GetDescriptorSet(), { (float)image->GetWidth(), (float)image->GetHeight() },
-					ImVec2(0, 1), ImVec2(1, 0));
+			UpdateFinalImage();
+
+			// Frames rendered below the viewport resolution are stretched over the whole viewport
+			if (m_ViewportImage.HasImage())
+			{
+				m_ViewportImage.Draw((float)m_ViewportWidth, (float)m_ViewportHeight);
+				UpdateCropWindow();
+			}
 		
 		}
 		ImGui::End();
 		ImGui::PopStyleVar();
 
+		m_ProfilerView.Draw();
+
 		/*if (m_IsRealTime)
 		{
 			if (ImGui::IsAnyMouseDown())
-				m_Renderer.ResetFrameIndex();
+				m_RenderThread.ResetFrameIndex();
 		}*/
 
 		if (Input::IsKeyDown(KeyCode::LeftControl) && m_IsRealTime)
-			m_Renderer.ResetFrameIndex();
+			m_RenderThread.ResetFrameIndex();
+
+		SubmitToRenderThread();
+	}
 
-		if (m_IsRealTime) {
-			Render(); // UNCOMMENT FOR RT-RAYTRACING
+	void SubmitToRenderThread()
+	{
+		if (m_SceneChanged)
+		{
+			m_RenderThread.SetScene(m_Scene);
+			m_SceneChanged = false;
 		}
+
+		m_RenderThread.SetSettings(m_RenderSettings);
+		m_RenderThread.SetViewportSize(m_ViewportWidth * m_ResolutionScale, m_ViewportHeight * m_ResolutionScale);
+		m_RenderThread.SetRealTime(m_IsRealTime);
+		m_RenderThread.SetGovernor(m_GovernorSettings);
 	}
 
-	void Render() 
+	// Handles dragging the crop window over the viewport image and draws its outline
+	void UpdateCropWindow()
 	{
-		Timer time;
+		ImVec2 imageMin = ImGui::GetItemRectMin();
+		ImVec2 imageSize = ImGui::GetItemRectSize();
+		if (imageSize.x <= 0.0f || imageSize.y <= 0.0f)
+			return;
 
-		m_Renderer.OnResize(m_ViewportWidth * m_ResolutionScale, m_ViewportHeight * m_ResolutionScale);
-		m_Camera.OnResize(m_ViewportWidth * m_ResolutionScale, m_ViewportHeight * m_ResolutionScale);
-		m_Renderer.Render(m_Scene, m_Camera);
+		// The image is drawn upside down, the renderer counts rows from the bottom
+		ImVec2 mouse = ImGui::GetMousePos();
+		glm::vec2 position = glm::clamp(glm::vec2((mouse.x - imageMin.x) / imageSize.x, 1.0f - (mouse.y - imageMin.y) / imageSize.y),
+			glm::vec2(0.0f), glm::vec2(1.0f));
 
-		if(m_IsRealTime)
-			m_LastRenderTime = time.ElapsedMillis();
+		if (ImGui::IsItemHovered() && ImGui::GetIO().KeyShift && ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+		{
+			m_IsDraggingCrop = true;
+			m_CropDragStart = position;
+		}
+
+		glm::vec2 cropMin = m_RenderSettings.CropMin;
+		glm::vec2 cropMax = m_RenderSettings.CropMax;
+		if (m_IsDraggingCrop)
+		{
+			cropMin = glm::min(m_CropDragStart, position);
+			cropMax = glm::max(m_CropDragStart, position);
+
+			// The window only moves once the drag ends, every change restarts its accumulation
+			if (!ImGui::IsMouseDown(ImGuiMouseButton_Left))
+			{
+				m_IsDraggingCrop = false;
+				m_RenderSettings.UseCropWindow = true;
+				m_RenderSettings.CropMin = cropMin;
+				m_RenderSettings.CropMax = cropMax;
+			}
+		}
+
+		if (!m_RenderSettings.UseCropWindow && !m_IsDraggingCrop)
+			return;
+
+		ImVec2 outlineMin(imageMin.x + cropMin.x * imageSize.x, imageMin.y + (1.0f - cropMax.y) * imageSize.y);
+		ImVec2 outlineMax(imageMin.x + cropMax.x * imageSize.x, imageMin.y + (1.0f - cropMin.y) * imageSize.y);
+		ImGui::GetWindowDrawList()->AddRect(outlineMin, outlineMax, IM_COL32(255, 200, 0, 255));
+	}
+
+	// Uploads the newest frame finished by the render thread, if there is one
+	void UpdateFinalImage()
+	{
+		ProfileZone zone("UploadFrame");
+
+		if (!m_RenderThread.AcquireFrame(m_ImageData, m_ImageWidth, m_ImageHeight))
+			return;
+
+		m_ViewportImage.SetData(m_ImageData.data(), m_ImageWidth, m_ImageHeight);
 	}
 
 public:
-	Renderer m_Renderer;
+	RenderThread m_RenderThread;
+	Renderer::Settings m_RenderSettings;
+	FrameGovernor::Settings m_GovernorSettings;
 	Camera m_Camera;
+	CameraController m_CameraController;
 	Scene m_Scene;
+	bool m_SceneChanged = true;
 	uint32_t m_ViewportWidth = 0, m_ViewportHeight = 0;
 
+	ViewportImage m_ViewportImage;
+	ProfilerView m_ProfilerView;
+	std::vector<uint32_t> m_ImageData;
+	uint32_t m_ImageWidth = 0, m_ImageHeight = 0;
+
 	char m_ImageFileName[256] = "Render";
+	char m_SceneFileName[256] = "../scenes/TwoSpheres.rtscene";
+	std::string m_SceneFileStatus;
 
 	float m_ResolutionScale = 1.0f;
 
-	float m_LastRenderTime = 0.0f;
+	bool m_IsDraggingCrop = false;
+	glm::vec2 m_CropDragStart{ 0.0f };
+
 	int m_Samples = 10;
+	int m_PreviewInterval = 8;
 	bool m_IsRealTime = true;
 };
 
@@ -622,32 +576,3 @@ Walnut::Application* Walnut::CreateApplication(int argc, char** argv)
 	});
 	return app;
 }
-
-
-namespace glm
-{
-
-	template<class Archive> void serialize(Archive& archive, glm::vec2& v) { archive(v.x, v.y); }
-	template<class Archive> void serialize(Archive& archive, glm::vec3& v) { archive(v.x, v.y, v.z); }
-	template<class Archive> void serialize(Archive& archive, glm::vec4& v) { archive(v.x, v.y, v.z, v.w); }
-	template<class Archive> void serialize(Archive& archive, glm::ivec2& v) { archive(v.x, v.y); }
-	template<class Archive> void serialize(Archive& archive, glm::ivec3& v) { archive(v.x, v.y, v.z); }
-	template<class Archive> void serialize(Archive& archive, glm::ivec4& v) { archive(v.x, v.y, v.z, v.w); }
-	template<class Archive> void serialize(Archive& archive, glm::uvec2& v) { archive(v.x, v.y); }
-	template<class Archive> void serialize(Archive& archive, glm::uvec3& v) { archive(v.x, v.y, v.z); }
-	template<class Archive> void serialize(Archive& archive, glm::uvec4& v) { archive(v.x, v.y, v.z, v.w); }
-	template<class Archive> void serialize(Archive& archive, glm::dvec2& v) { archive(v.x, v.y); }
-	template<class Archive> void serialize(Archive& archive, glm::dvec3& v) { archive(v.x, v.y, v.z); }
-	template<class Archive> void serialize(Archive& archive, glm::dvec4& v) { archive(v.x, v.y, v.z, v.w); }
-
-	// glm matrices serialization
-	template<class Archive> void serialize(Archive& archive, glm::mat2& m) { archive(m[0], m[1]); }
-	template<class Archive> void serialize(Archive& archive, glm::dmat2& m) { archive(m[0], m[1]); }
-	template<class Archive> void serialize(Archive& archive, glm::mat3& m) { archive(m[0], m[1], m[2]); }
-	template<class Archive> void serialize(Archive& archive, glm::mat4& m) { archive(m[0], m[1], m[2], m[3]); }
-	template<class Archive> void serialize(Archive& archive, glm::dmat4& m) { archive(m[0], m[1], m[2], m[3]); }
-
-	template<class Archive> void serialize(Archive& archive, glm::quat& q) { archive(q.x, q.y, q.z, q.w); }
-	template<class Archive> void serialize(Archive& archive, glm::dquat& q) { archive(q.x, q.y, q.z, q.w); }
-
-}
\ No newline at end of file
@@ -1,10 +1,28 @@
 -- premake5.lua
+newoption
+{
+   trigger = "headless",
+   description = "Only generate the renderer core, the command line tools and the benchmarks, without Walnut and the viewport"
+}
+
+newoption
+{
+   trigger = "perf-counters",
+   description = "Read Linux perf_event hardware counters per render phase, see RTBenchmark --counters"
+}
+
 workspace "RTRayTracer"
    architecture "x64"
    configurations { "Debug", "Release", "Dist" }
-   startproject "RTRayTracer"
+   startproject (_OPTIONS["headless"] and "RTCli" or "RTRayTracer")
 
 outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
-include "Walnut/WalnutExternal.lua"
 
-include "RTRayTracer"
\ No newline at end of file
+include "RTCore"
+include "RTCli"
+include "RTBenchmark"
+
+if not _OPTIONS["headless"] then
+   include "Walnut/WalnutExternal.lua"
+   include "RTRayTracer"
+end